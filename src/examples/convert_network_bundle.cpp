@@ -0,0 +1,54 @@
+#include "Snap.h"
+
+#include "io.h"
+#include "dta.h"
+#include "multiclass.h"
+
+#include <chrono>
+
+/**************************************************************************
+  Writes MNM_network_bundle.bin from the MNM_input_* files of a folder,
+  build_from_files uses it from then on
+  usage: convert_network_bundle [input folder] [multiclass]
+**************************************************************************/
+int main(int argc, char *argv[])
+{
+  std::string m_file_folder = "../../data/input_files_PGH";
+  if (argc > 1) m_file_folder = argv[1];
+  bool _multiclass = (argc > 2) && (std::string(argv[2]) == "multiclass");
+
+  MNM_ConfReader *m_config = new MNM_ConfReader(m_file_folder + "/config.conf", "DTA");
+  auto _t = std::chrono::steady_clock::now();
+  MNM_IO::save_network_bundle(m_file_folder, m_config);
+  printf("Wrote the bundle in %.2f s\n", std::chrono::duration<double>(std::chrono::steady_clock::now() - _t).count());
+  delete m_config;
+
+  // the network of the bundle, without the routing
+  _t = std::chrono::steady_clock::now();
+  MNM_Dta *_dta = _multiclass ? new MNM_Dta_Multiclass(m_file_folder) : new MNM_Dta(m_file_folder);
+  MNM_Network_Bundle *_bundle = MNM_IO::load_network_bundle(m_file_folder, _dta -> m_config);
+  if (_bundle == NULL){
+    printf("The bundle can not be loaded\n");
+    exit(-1);
+  }
+  if (_multiclass){
+    MNM_IO_Multiclass::build_node_factory_multiclass(_bundle, _dta -> m_config, _dta -> m_node_factory);
+    MNM_IO_Multiclass::build_link_factory_multiclass(_bundle, _dta -> m_config, _dta -> m_link_factory);
+    MNM_IO::build_od_factory(_bundle, _dta -> m_config, _dta -> m_od_factory, _dta -> m_node_factory);
+    _dta -> m_graph = MNM_IO::build_graph(_bundle);
+    MNM_IO_Multiclass::build_demand_multiclass(_bundle, _dta -> m_config, _dta -> m_od_factory);
+  }
+  else{
+    MNM_IO::build_node_factory(_bundle, _dta -> m_config, _dta -> m_node_factory);
+    MNM_IO::build_link_factory(_bundle, _dta -> m_config, _dta -> m_link_factory);
+    MNM_IO::build_od_factory(_bundle, _dta -> m_config, _dta -> m_od_factory, _dta -> m_node_factory);
+    _dta -> m_graph = MNM_IO::build_graph(_bundle);
+    MNM_IO::build_demand(_bundle, _dta -> m_config, _dta -> m_od_factory);
+  }
+  printf("Built %d nodes, %d links and %d OD pairs in %.2f s\n", int(_dta -> m_node_factory -> m_node_map.size()), 
+         int(_dta -> m_link_factory -> m_link_map.size()), _bundle -> m_header -> m_num_OD, 
+         std::chrono::duration<double>(std::chrono::steady_clock::now() - _t).count());
+  delete _bundle;
+  delete _dta;
+  return 0;
+}
@@ -0,0 +1,36 @@
+#include "Snap.h"
+
+#include "io.h"
+#include "ults.h"
+
+#include <ctime>
+
+/**************************************************************************
+  Writes the binary path table next to the text path table of the FIXED
+  section, MNM_IO::load_path_table uses it from then on
+  usage: convert_path_table [input folder] [float32]
+**************************************************************************/
+int main(int argc, char *argv[])
+{
+  std::string m_file_folder = "../../data/input_files_PGH";
+  if (argc > 1) m_file_folder = argv[1];
+  bool _single_precision = (argc > 2) && (std::string(argv[2]) == "float32");
+
+  MNM_ConfReader *m_config = new MNM_ConfReader(m_file_folder + "/config.conf", "DTA");
+  MNM_ConfReader *_tmp_conf = new MNM_ConfReader(m_file_folder + "/config.conf", "FIXED");
+  PNEGraph m_graph = MNM_IO::build_graph(m_file_folder, m_config);
+  std::string _file_name = m_file_folder + "/" + _tmp_conf -> get_string("path_file_name");
+  bool _w_buffer = _tmp_conf -> get_string("choice_portion") == "Buffer";
+
+  clock_t _t = clock();
+  MNM_IO::convert_path_table(_file_name, m_graph, _tmp_conf -> get_int("num_path"), _w_buffer, _single_precision);
+  printf("Wrote %s.bin in %.2f s\n", _file_name.c_str(), double(clock() - _t) / CLOCKS_PER_SEC);
+
+  _t = clock();
+  Path_Table *_path_table = MNM_IO::load_path_table(_file_name, m_graph, _tmp_conf -> get_int("num_path"), _w_buffer);
+  printf("Loaded %d paths in %.2f s\n", _path_table -> m_num_path, double(clock() - _t) / CLOCKS_PER_SEC);
+
+  delete _tmp_conf;
+  delete m_config;
+  return 0;
+}
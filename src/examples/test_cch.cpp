@@ -0,0 +1,131 @@
+#include "Snap.h"
+
+#include "io.h"
+#include "shortest_path.h"
+#include "contraction_hierarchy.h"
+#include "ults.h"
+
+#include <ctime>
+
+/**************************************************************************
+  Customizable contraction hierarchy on the free flow cost, OD distance table
+  and shortest paths of all OD pairs against one tree per destination
+  usage: test_cch [input folder]
+**************************************************************************/
+int main(int argc, char *argv[])
+{
+  printf("Start!\n");
+  std::string m_file_folder = "../../data/input_files_PGH";
+  if (argc > 1) m_file_folder = argv[1];
+  MNM_ConfReader *m_config;
+  MNM_Node_Factory *m_node_factory;
+  MNM_Link_Factory *m_link_factory;
+  MNM_OD_Factory *m_od_factory;
+  PNEGraph m_graph;
+
+  m_node_factory = new MNM_Node_Factory();
+  m_link_factory = new MNM_Link_Factory();
+  m_od_factory = new MNM_OD_Factory();
+  m_config = new MNM_ConfReader(m_file_folder + "/config.conf", "DTA");
+  MNM_IO::build_node_factory(m_file_folder, m_config, m_node_factory);
+  MNM_IO::build_link_factory(m_file_folder, m_config, m_link_factory);
+  MNM_IO::build_od_factory(m_file_folder, m_config, m_od_factory, m_node_factory);
+  m_graph = MNM_IO::build_graph(m_file_folder, m_config);
+
+  std::unordered_map<TInt, TFlt> cost_map = std::unordered_map<TInt, TFlt>();
+  for (auto _it = m_link_factory -> m_link_map.begin(); _it != m_link_factory -> m_link_map.end(); ++_it){
+    cost_map.insert(std::pair<TInt, TFlt>(_it -> first, _it -> second -> get_link_tt()));
+  }
+
+  MNM_Graph_CSR *_csr = new MNM_Graph_CSR(m_graph);
+  std::vector<double> _cost = std::vector<double>(_csr -> m_num_link);
+  std::vector<double> _dist = std::vector<double>(_csr -> m_num_node);
+  std::vector<int> _pred = std::vector<int>(_csr -> m_num_node);
+  _csr -> build_cost_array(cost_map, _cost.data());
+
+  std::vector<int> _origin_index_vec = std::vector<int>();
+  std::vector<int> _dest_index_vec = std::vector<int>();
+  for (auto _it = m_od_factory -> m_origin_map.begin(); _it != m_od_factory -> m_origin_map.end(); _it++){
+    _origin_index_vec.push_back(_csr -> get_node_index(_it -> second -> m_origin_node -> m_node_ID));
+  }
+  for (auto _it = m_od_factory -> m_destination_map.begin(); _it != m_od_factory -> m_destination_map.end(); _it++){
+    _dest_index_vec.push_back(_csr -> get_node_index(_it -> second -> m_dest_node -> m_node_ID));
+  }
+  int _num_origin = int(_origin_index_vec.size());
+  int _num_dest = int(_dest_index_vec.size());
+  printf("%d nodes, %d links, %d origins, %d destinations\n", _csr -> m_num_node, _csr -> m_num_link, _num_origin, _num_dest);
+
+  clock_t startTime, endTime;
+  std::vector<double> _tree_dist = std::vector<double>(_num_origin * _num_dest);
+  startTime = clock();
+  for (int d = 0; d < _num_dest; ++d){
+    MNM_Shortest_Path::all_to_one_Dijkstra(_dest_index_vec[d], _csr, _cost.data(), _dist.data(), _pred.data());
+    for (int o = 0; o < _num_origin; ++o){
+      _tree_dist[o * _num_dest + d] = _dist[_origin_index_vec[o]];
+    }
+  }
+  endTime = clock();
+  printf("All to one Dijkstra: %f seconds\n", (endTime - startTime) / (double) CLOCKS_PER_SEC);
+
+  startTime = clock();
+  MNM_CCH *_cch = new MNM_CCH(_csr);
+  endTime = clock();
+  printf("Contraction order: %f seconds, %d arcs\n", (endTime - startTime) / (double) CLOCKS_PER_SEC, (int)_cch -> m_up_head.size());
+  startTime = clock();
+  _cch -> customize(_cost.data());
+  endTime = clock();
+  printf("Customization: %f seconds\n", (endTime - startTime) / (double) CLOCKS_PER_SEC);
+
+  std::vector<double> _cch_dist = std::vector<double>(_num_origin * _num_dest);
+  startTime = clock();
+  _cch -> many_to_many(_origin_index_vec, _dest_index_vec, _cch_dist.data());
+  endTime = clock();
+  int _num_wrong = 0;
+  for (int i = 0; i < _num_origin * _num_dest; ++i){
+    if (fabs(_cch_dist[i] - _tree_dist[i]) > 1e-6) _num_wrong++;
+  }
+  printf("Many to many: %f seconds, %d wrong\n", (endTime - startTime) / (double) CLOCKS_PER_SEC, _num_wrong);
+
+  std::vector<std::vector<int>> _path_link = std::vector<std::vector<int>>();
+  std::vector<double> _row = std::vector<double>(_num_dest);
+  _num_wrong = 0;
+  startTime = clock();
+  _cch -> set_targets(_dest_index_vec);
+  for (int o = 0; o < _num_origin; ++o){
+    _cch -> get_paths_from(_origin_index_vec[o], _row.data(), _path_link);
+    for (int d = 0; d < _num_dest; ++d){
+      if (_row[d] == DBL_MAX){
+        if (_tree_dist[o * _num_dest + d] < DBL_MAX) _num_wrong++;
+        continue;
+      }
+      double _path_cost = 0.;
+      int _node = _origin_index_vec[o];
+      for (int _link : _path_link[d]){
+        if (_csr -> m_link_from[_link] != _node) _num_wrong++;
+        _node = _csr -> m_link_to[_link];
+        _path_cost += _cost[_link];
+      }
+      if (_node != _dest_index_vec[d] || fabs(_path_cost - _tree_dist[o * _num_dest + d]) > 1e-6) _num_wrong++;
+    }
+  }
+  endTime = clock();
+  printf("Paths of all OD pairs: %f seconds, %d wrong\n", (endTime - startTime) / (double) CLOCKS_PER_SEC, _num_wrong);
+
+  std::vector<int> _one_path = std::vector<int>();
+  _num_wrong = 0;
+  startTime = clock();
+  for (int d = 0; d < _num_dest; ++d){
+    int o = d % _num_origin;
+    if (_cch -> one_to_one(_origin_index_vec[o], _dest_index_vec[d], _one_path) < 0){
+      if (_tree_dist[o * _num_dest + d] < DBL_MAX) _num_wrong++;
+    }
+    if (fabs(_cch -> distance(_origin_index_vec[o], _dest_index_vec[d]) - _tree_dist[o * _num_dest + d]) > 1e-6) _num_wrong++;
+  }
+  endTime = clock();
+  printf("One to one: %f seconds, %d wrong\n", (endTime - startTime) / (double) CLOCKS_PER_SEC, _num_wrong);
+
+  delete _cch;
+  delete _csr;
+  printf("Finished\n");
+  return 0;
+}
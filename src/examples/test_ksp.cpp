@@ -1,7 +1,169 @@
+#include "Snap.h"
+
+#include "io.h"
+#include "path.h"
 #include "k_shortest_path.h"
+#include "ults.h"
+
+#include <chrono>
+#include <algorithm>
+#include <unordered_set>
+
+/**************************************************************************
+  Path set generation, penalty heuristic vs k shortest paths
+  usage: test_ksp [input folder] [k]
+  on networks of at most MAX_CHECK_NODE nodes the k shortest paths are also
+  checked against all simple paths of every OD pair
+**************************************************************************/
+#define MAX_CHECK_NODE 30
+
+int count_path(Path_Table *path_table)
+{
+  int _num = 0;
+  for (auto _it : *path_table){
+    for (auto _it_it : *(_it.second)){
+      _num += int(_it_it.second -> m_path_vec.size());
+    }
+  }
+  return _num;
+}
+
+// the costs of all simple paths from node_ID to dest_node_ID
+int enumerate_path(PNEGraph &graph, std::unordered_map<TInt, TFlt> &cost_map, TInt node_ID, TInt dest_node_ID,
+                   double cost, std::unordered_set<int> &visited, std::vector<double> &cost_vec)
+{
+  if (node_ID == dest_node_ID){
+    cost_vec.push_back(cost);
+    return 0;
+  }
+  visited.insert(node_ID);
+  TNEGraph::TNodeI _node_it = graph -> GetNI(node_ID);
+  for (int e = 0; e < _node_it.GetOutDeg(); ++e){
+    TInt _link_ID = _node_it.GetOutEId(e);
+    TInt _next_ID = graph -> GetEI(_link_ID).GetDstNId();
+    if (visited.find(_next_ID) != visited.end()) continue;
+    enumerate_path(graph, cost_map, _next_ID, dest_node_ID, cost + cost_map[_link_ID](), visited, cost_vec);
+  }
+  visited.erase(node_ID);
+  return 0;
+}
+
+// the cost of path, -1 if it is not a simple path from origin_node_ID to dest_node_ID
+double check_path(PNEGraph &graph, std::unordered_map<TInt, TFlt> &cost_map, MNM_Path *path, 
+                  TInt origin_node_ID, TInt dest_node_ID)
+{
+  if (path -> m_node_vec.size() != path -> m_link_vec.size() + 1) return -1;
+  if (path -> m_node_vec.front() != origin_node_ID || path -> m_node_vec.back() != dest_node_ID) return -1;
+  std::unordered_set<int> _visited;
+  double _cost = 0;
+  for (size_t i = 0; i < path -> m_link_vec.size(); ++i){
+    TNEGraph::TEdgeI _link_it = graph -> GetEI(path -> m_link_vec[i]);
+    if (_link_it.GetSrcNId() != path -> m_node_vec[i] || _link_it.GetDstNId() != path -> m_node_vec[i + 1]) return -1;
+    if (!_visited.insert(path -> m_node_vec[i]).second) return -1;
+    _cost += cost_map[path -> m_link_vec[i]]();
+  }
+  return _cost;
+}
 
-int main()
+// every path set holds min(k, number of simple paths) simple paths, shortest first, with the
+// costs of the shortest simple paths, and no path is returned from a node to itself
+int check_ksp(PNEGraph &graph, MNM_Link_Factory *link_factory, Path_Table *path_table, TInt num_path)
 {
-  // MNM_KSP_Tree a = MNM_KSP_Tree(0, NULL);
+  std::unordered_map<TInt, TFlt> _cost_map = std::unordered_map<TInt, TFlt>();
+  for (auto _link_it : link_factory -> m_link_map){
+    _cost_map[_link_it.first] = _link_it.second -> get_link_tt();
+  }
+  int _num_error = 0;
+  for (auto _it : *path_table){
+    for (auto _it_it : *(_it.second)){
+      TInt _origin_node_ID = _it.first, _dest_node_ID = _it_it.first;
+      std::vector<MNM_Path*> &_path_vec = _it_it.second -> m_path_vec;
+      std::vector<double> _all_cost;
+      std::unordered_set<int> _visited;
+      if (_origin_node_ID != _dest_node_ID){
+        enumerate_path(graph, _cost_map, _origin_node_ID, _dest_node_ID, 0., _visited, _all_cost);
+      }
+      std::sort(_all_cost.begin(), _all_cost.end());
+      size_t _num_expect = std::min(size_t(num_path()), _all_cost.size());
+      if (_path_vec.size() != _num_expect){
+        printf("OD %d -> %d: %d paths, %d expected\n", (int)_origin_node_ID, (int)_dest_node_ID,
+               (int)_path_vec.size(), (int)_num_expect);
+        _num_error++;
+        continue;
+      }
+      double _last_cost = 0;
+      for (size_t i = 0; i < _path_vec.size(); ++i){
+        double _cost = check_path(graph, _cost_map, _path_vec[i], _origin_node_ID, _dest_node_ID);
+        if (_cost < 0 || _cost < _last_cost - 1e-9 || std::abs(_cost - _all_cost[i]) > 1e-9 * std::max(1., _all_cost[i])){
+          printf("OD %d -> %d: path %d costs %f, %f expected\n", (int)_origin_node_ID, (int)_dest_node_ID,
+                 (int)i, _cost, _all_cost[i]);
+          _num_error++;
+        }
+        _last_cost = _cost;
+      }
+    }
+  }
+
+  MNM_Graph_CSR *_csr = new MNM_Graph_CSR(graph);
+  std::vector<double> _cost = std::vector<double>(_csr -> m_num_link);
+  _csr -> build_cost_array(_cost_map, _cost.data());
+  for (auto _it : *path_table){
+    MNM_KSP_Tree *_ksp_tree = new MNM_KSP_Tree(_it.first, _csr);
+    MNM_Pathset *_path_set = new MNM_Pathset();
+    _ksp_tree -> initialize();
+    _ksp_tree -> update_tree(_cost.data());
+    if (_ksp_tree -> get_ksp(_it.first, num_path, _path_set) != 0 || !_path_set -> m_path_vec.empty()){
+      printf("OD %d -> %d: a path from a node to itself\n", (int)_it.first, (int)_it.first);
+      _num_error++;
+    }
+    delete _path_set;
+    delete _ksp_tree;
+  }
+  delete _csr;
+  return _num_error;
+}
+
+int main(int argc, char *argv[])
+{
+  printf("Start!\n");
+  std::string m_file_folder = "../../data/input_files_PGH";
+  if (argc > 1) m_file_folder = argv[1];
+  TInt _num_path = 5;
+  if (argc > 2) _num_path = atoi(argv[2]);
+  MNM_ConfReader *m_config;
+  MNM_Node_Factory *m_node_factory;
+  MNM_Link_Factory *m_link_factory;
+  MNM_OD_Factory *m_od_factory;
+  PNEGraph m_graph;
+
+  m_node_factory = new MNM_Node_Factory();
+  m_link_factory = new MNM_Link_Factory();
+  m_od_factory = new MNM_OD_Factory();
+  m_config = new MNM_ConfReader(m_file_folder + "/config.conf", "DTA");
+  MNM_IO::build_node_factory(m_file_folder, m_config, m_node_factory);
+  MNM_IO::build_link_factory(m_file_folder, m_config, m_link_factory);
+  MNM_IO::build_od_factory(m_file_folder, m_config, m_od_factory, m_node_factory);
+  m_graph = MNM_IO::build_graph(m_file_folder, m_config);
+
+  std::chrono::time_point<std::chrono::system_clock> _start, _end;
+  _start = std::chrono::system_clock::now();
+  Path_Table *_path_table = MNM::build_pathset(m_graph, m_od_factory, m_link_factory);
+  _end = std::chrono::system_clock::now();
+  printf("Penalty heuristic: %d paths in %f seconds\n", count_path(_path_table),
+         std::chrono::duration<double>(_end - _start).count());
+
+  _start = std::chrono::system_clock::now();
+  Path_Table *_ksp_table = MNM::build_pathset_ksp(m_graph, m_od_factory, m_link_factory, _num_path);
+  _end = std::chrono::system_clock::now();
+  printf("%d shortest paths: %d paths in %f seconds\n", (int)_num_path, count_path(_ksp_table),
+         std::chrono::duration<double>(_end - _start).count());
+
+  if (m_graph -> GetNodes() <= MAX_CHECK_NODE){
+    int _num_error = check_ksp(m_graph, m_link_factory, _ksp_table, _num_path);
+    printf("Check against all simple paths: %d errors\n", _num_error);
+    if (_num_error > 0) return -1;
+  }
+
+  printf("Finished\n");
   return 0;
-}
\ No newline at end of file
+}
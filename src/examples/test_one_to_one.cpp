@@ -0,0 +1,138 @@
+#include "Snap.h"
+
+#include "io.h"
+#include "shortest_path.h"
+#include "ults.h"
+
+#include <ctime>
+
+/**************************************************************************
+  One to one queries on the CSR snapshot, all to one tree vs bidirectional
+  Dijkstra vs ALT, the three costs must agree and the landmark bounds must not
+  exceed the tree costs. Without an input folder PGH and SR41 (not strongly
+  connected) are checked
+  usage: one_to_one [input folder] [number of queries]
+**************************************************************************/
+double path_cost(std::vector<int> &path_link, std::vector<double> &cost)
+{
+  double _cost = 0.;
+  for (int _link : path_link) _cost += cost[_link];
+  return _cost;
+}
+
+// the number of wrong answers and bounds
+int check_one_to_one(std::string m_file_folder, int _num_query)
+{
+  MNM_ConfReader *m_config;
+  MNM_Node_Factory *m_node_factory;
+  MNM_Link_Factory *m_link_factory;
+  MNM_OD_Factory *m_od_factory;
+  PNEGraph m_graph;
+
+  m_node_factory = new MNM_Node_Factory();
+  m_link_factory = new MNM_Link_Factory();
+  m_od_factory = new MNM_OD_Factory();
+  m_config = new MNM_ConfReader(m_file_folder + "/config.conf", "DTA");
+  MNM_IO::build_node_factory(m_file_folder, m_config, m_node_factory);
+  MNM_IO::build_link_factory(m_file_folder, m_config, m_link_factory);
+  MNM_IO::build_od_factory(m_file_folder, m_config, m_od_factory, m_node_factory);
+  m_graph = MNM_IO::build_graph(m_file_folder, m_config);
+
+  std::unordered_map<TInt, TFlt> cost_map = std::unordered_map<TInt, TFlt>();
+  for (auto _it = m_link_factory -> m_link_map.begin(); _it != m_link_factory -> m_link_map.end(); ++_it){
+    cost_map.insert(std::pair<TInt, TFlt>(_it -> first, _it -> second -> get_link_tt()));
+  }
+
+  MNM_Graph_CSR *_csr = new MNM_Graph_CSR(m_graph);
+  std::vector<double> _cost = std::vector<double>(_csr -> m_num_link);
+  std::vector<double> _dist = std::vector<double>(_csr -> m_num_node);
+  std::vector<int> _pred = std::vector<int>(_csr -> m_num_node);
+  _csr -> build_cost_array(cost_map, _cost.data());
+
+  std::vector<int> _origin_index_vec = std::vector<int>();
+  std::vector<int> _dest_index_vec = std::vector<int>();
+  for (auto _it = m_od_factory -> m_origin_map.begin(); _it != m_od_factory -> m_origin_map.end(); _it++){
+    _origin_index_vec.push_back(_csr -> get_node_index(_it -> second -> m_origin_node -> m_node_ID));
+  }
+  for (auto _it = m_od_factory -> m_destination_map.begin(); _it != m_od_factory -> m_destination_map.end(); _it++){
+    _dest_index_vec.push_back(_csr -> get_node_index(_it -> second -> m_dest_node -> m_node_ID));
+  }
+  std::vector<std::pair<int, int>> _query = std::vector<std::pair<int, int>>();
+  srand(0);
+  for (int i = 0; i < _num_query; ++i){
+    _query.push_back(std::make_pair(_origin_index_vec[rand() % _origin_index_vec.size()], 
+                                    _dest_index_vec[rand() % _dest_index_vec.size()]));
+  }
+  printf("%s: %d nodes, %d links, %d queries\n", m_file_folder.c_str(), _csr -> m_num_node, _csr -> m_num_link, _num_query);
+
+  clock_t startTime, endTime;
+  std::vector<double> _tree_cost = std::vector<double>(_num_query);
+  startTime = clock();
+  for (int i = 0; i < _num_query; ++i){
+    MNM_Shortest_Path::all_to_one_Dijkstra(_query[i].second, _csr, _cost.data(), _dist.data(), _pred.data());
+    _tree_cost[i] = _dist[_query[i].first];
+  }
+  endTime = clock();
+  printf("All to one Dijkstra: %f seconds\n", (endTime - startTime) / (double) CLOCKS_PER_SEC);
+
+  std::vector<int> _path_link = std::vector<int>();
+  int _num_wrong = 0, _tot_wrong = 0;
+  startTime = clock();
+  for (int i = 0; i < _num_query; ++i){
+    if (MNM_Shortest_Path::one_to_one_Dijkstra(_query[i].first, _query[i].second, _csr, _cost.data(), _path_link) < 0){
+      if (_tree_cost[i] < DBL_MAX) _num_wrong++;
+    }
+    else if (fabs(path_cost(_path_link, _cost) - _tree_cost[i]) > 1e-6) _num_wrong++;
+  }
+  endTime = clock();
+  printf("Bidirectional Dijkstra: %f seconds, %d wrong\n", (endTime - startTime) / (double) CLOCKS_PER_SEC, _num_wrong);
+  _tot_wrong += _num_wrong;
+
+  startTime = clock();
+  MNM_SP_Landmark *_landmark = new MNM_SP_Landmark(_csr);
+  _landmark -> update(_cost.data());
+  endTime = clock();
+  printf("Landmarks: %d in %f seconds\n", _landmark -> m_num_landmark, (endTime - startTime) / (double) CLOCKS_PER_SEC);
+  _num_wrong = 0;
+  for (int i = 0; i < _num_query; ++i){
+    if (_tree_cost[i] < DBL_MAX && _landmark -> lower_bound(_query[i].first, _query[i].second) > _tree_cost[i] + 1e-6){
+      _num_wrong++;
+    }
+  }
+  printf("Landmark bounds: %d above the tree cost\n", _num_wrong);
+  _tot_wrong += _num_wrong;
+  _num_wrong = 0;
+  startTime = clock();
+  for (int i = 0; i < _num_query; ++i){
+    if (MNM_Shortest_Path::one_to_one_ALT(_query[i].first, _query[i].second, _csr, _cost.data(), _landmark, _path_link) < 0){
+      if (_tree_cost[i] < DBL_MAX) _num_wrong++;
+    }
+    else if (fabs(path_cost(_path_link, _cost) - _tree_cost[i]) > 1e-6) _num_wrong++;
+  }
+  endTime = clock();
+  printf("ALT: %f seconds, %d wrong\n", (endTime - startTime) / (double) CLOCKS_PER_SEC, _num_wrong);
+  _tot_wrong += _num_wrong;
+
+  delete _landmark;
+  delete _csr;
+  delete m_config;
+  delete m_od_factory;
+  delete m_link_factory;
+  delete m_node_factory;
+  return _tot_wrong;
+}
+
+int main(int argc, char *argv[])
+{
+  printf("Start!\n");
+  std::vector<std::string> _folder_vec = {"../../data/input_files_PGH", "../../data/input_files_SR41"};
+  if (argc > 1) _folder_vec = {argv[1]};
+  int _num_query = 1000;
+  if (argc > 2) _num_query = atoi(argv[2]);
+  int _num_wrong = 0;
+  for (std::string &_folder : _folder_vec){
+    _num_wrong += check_one_to_one(_folder, _num_query);
+  }
+  printf("Finished, %d wrong\n", _num_wrong);
+  return _num_wrong > 0 ? -1 : 0;
+}
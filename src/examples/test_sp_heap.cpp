@@ -0,0 +1,86 @@
+#include "Snap.h"
+
+#include "io.h"
+#include "shortest_path.h"
+#include "ults.h"
+
+#include <ctime>
+
+/**************************************************************************
+  Benchmark of the Dijkstra heaps on the CSR snapshot, one tree per destination
+  usage: sp_heap [input folder]
+**************************************************************************/
+int main(int argc, char *argv[])
+{
+  printf("Start!\n");
+  std::string m_file_folder = "../../data/input_files_PGH";
+  if (argc > 1) m_file_folder = argv[1];
+  MNM_ConfReader *m_config;
+  MNM_Node_Factory *m_node_factory;
+  MNM_Link_Factory *m_link_factory;
+  MNM_OD_Factory *m_od_factory;
+  PNEGraph m_graph;
+
+  m_node_factory = new MNM_Node_Factory();
+  m_link_factory = new MNM_Link_Factory();
+  m_od_factory = new MNM_OD_Factory();
+  m_config = new MNM_ConfReader(m_file_folder + "/config.conf", "DTA");
+  MNM_IO::build_node_factory(m_file_folder, m_config, m_node_factory);
+  MNM_IO::build_link_factory(m_file_folder, m_config, m_link_factory);
+  MNM_IO::build_od_factory(m_file_folder, m_config, m_od_factory, m_node_factory);
+  m_graph = MNM_IO::build_graph(m_file_folder, m_config);
+
+  std::unordered_map<TInt, TFlt> cost_map = std::unordered_map<TInt, TFlt>();
+  for (auto _it = m_link_factory -> m_link_map.begin(); _it != m_link_factory -> m_link_map.end(); ++_it){
+    cost_map.insert(std::pair<TInt, TFlt>(_it -> first, _it -> second -> get_link_tt()));
+  }
+
+  MNM_Graph_CSR *_csr = new MNM_Graph_CSR(m_graph);
+  std::vector<double> _cost = std::vector<double>(_csr -> m_num_link);
+  std::vector<double> _dist = std::vector<double>(_csr -> m_num_node);
+  std::vector<int> _pred = std::vector<int>(_csr -> m_num_node);
+  _csr -> build_cost_array(cost_map, _cost.data());
+  std::vector<int> _dest_index_vec = std::vector<int>();
+  for (auto _it = m_od_factory -> m_destination_map.begin(); _it != m_od_factory -> m_destination_map.end(); _it++){
+    _dest_index_vec.push_back(_csr -> get_node_index(_it -> second -> m_dest_node -> m_node_ID));
+  }
+  printf("%d nodes, %d links, %d destinations\n", _csr -> m_num_node, _csr -> m_num_link, (int)_dest_index_vec.size());
+
+  clock_t startTime, endTime;
+  std::unordered_map<TInt, TInt> output_map = std::unordered_map<TInt, TInt>();
+  startTime = clock();
+  for (auto _it = m_od_factory -> m_destination_map.begin(); _it != m_od_factory -> m_destination_map.end(); _it++){
+    output_map.clear();
+    MNM_Shortest_Path::all_to_one_Dijkstra(_it -> second -> m_dest_node -> m_node_ID, m_graph, cost_map, output_map);
+  }
+  endTime = clock();
+  printf("The time using for the map based Dijkstra (snapshot rebuilt per tree) is %f seconds.\n", (endTime - startTime) / (double) CLOCKS_PER_SEC);
+
+  std::string _name_list[3] = {"binary", "radix", "4-ary"};
+  SP_heap_type _heap_list[3] = {MNM_TYPE_HEAP_BINARY, MNM_TYPE_HEAP_RADIX, MNM_TYPE_HEAP_DARY};
+  MNM_SP_Workspace *_workspace = MNM_SP_Workspace::get_thread_workspace();
+  for (int h = 0; h < 3; ++h){
+    startTime = clock();
+    for (int _dest_index : _dest_index_vec){
+      MNM_Shortest_Path::all_to_one_Dijkstra(_dest_index, _csr, _cost.data(), _dist.data(), _pred.data(),
+                                             _workspace, _heap_list[h]);
+    }
+    endTime = clock();
+    printf("The time using for the %s heap Dijkstra is %f seconds.\n", _name_list[h].c_str(),
+           (endTime - startTime) / (double) CLOCKS_PER_SEC);
+  }
+
+  startTime = clock();
+  for (int _dest_index : _dest_index_vec){
+    MNM_Shortest_Path::all_to_one_FIFO(_dest_index, _csr, _cost.data(), _dist.data(), _pred.data());
+  }
+  endTime = clock();
+  printf("The time using for FIFO is %f seconds.\n", (endTime - startTime) / (double) CLOCKS_PER_SEC);
+
+  MNM_Shortest_Path::tune_Dijkstra(_csr, _cost.data());
+  printf("Picked heap: %s\n", _name_list[_csr -> m_sp_heap].c_str());
+
+  delete _csr;
+  printf("Finished\n");
+  return 0;
+}
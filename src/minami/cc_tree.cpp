@@ -48,4 +48,86 @@ int MNM_Tree_Cumulative_Curve::print_out()
     }
   }
   return 0;
-}
\ No newline at end of file
+}
+
+/**************************************************************************
+                          Online DAR bins
+**************************************************************************/
+MNM_Dar_Observation::MNM_Dar_Observation(std::vector<std::pair<TInt, TInt>> &windows, std::vector<MNM_Path*> &path_vec)
+{
+  m_windows = windows;
+  m_path_vec = path_vec;
+  m_num_path = TInt(path_vec.size());
+  m_path_index = std::unordered_map<MNM_Path*, TInt>();
+  for (size_t i = 0; i < m_path_vec.size(); ++i){
+    m_path_index.insert(std::pair<MNM_Path*, TInt>(m_path_vec[i], TInt(i)));
+  }
+  // a flow recorded at time t counts in window w iff start_w < t <= end_w, 
+  // the same as get_result(end) - get_result(start) on the cc tree
+  TInt _max_time = 0;
+  for (auto _window : m_windows){
+    if (_window.second < _window.first){
+      throw std::runtime_error("Error, MNM_Dar_Observation::MNM_Dar_Observation, end time smaller than start time");
+    }
+    if (_window.second > _max_time) _max_time = _window.second;
+  }
+  m_time_to_window = std::vector<std::vector<TInt>>(_max_time + 1, std::vector<TInt>());
+  for (size_t w = 0; w < m_windows.size(); ++w){
+    for (int t = m_windows[w].first + 1; t <= m_windows[w].second; ++t){
+      if (t >= 0) m_time_to_window[t].push_back(TInt(w));
+    }
+  }
+}
+
+
+MNM_Dar_Observation::~MNM_Dar_Observation()
+{
+  m_windows.clear();
+  m_path_vec.clear();
+  m_path_index.clear();
+  m_time_to_window.clear();
+}
+
+
+MNM_Dar_Bins::MNM_Dar_Bins(MNM_Dar_Observation *observation)
+{
+  m_observation = observation;
+  // the bins are sparse, they grow with what is recorded
+  m_bins = std::vector<std::unordered_map<TInt, TFlt>>(observation -> m_windows.size());
+}
+
+
+MNM_Dar_Bins::~MNM_Dar_Bins()
+{
+  m_bins.clear();
+}
+
+
+int MNM_Dar_Bins::add_flow(TInt timestamp, TFlt flow, MNM_Path* path, TInt departing_int)
+{
+  if (timestamp < 0 || timestamp >= TInt(m_observation -> m_time_to_window.size())){
+    return 0;
+  }
+  std::vector<TInt> &_windows = m_observation -> m_time_to_window[timestamp];
+  if (_windows.empty()){
+    return 0;
+  }
+  auto _path_it = m_observation -> m_path_index.find(path);
+  if (_path_it == m_observation -> m_path_index.end()){
+    return 0;
+  }
+  TInt _key = _path_it -> second + m_observation -> m_num_path * departing_int;
+  for (TInt _w : _windows){
+    m_bins[_w][_key] += flow;
+  }
+  return 0;
+}
+
+
+int MNM_Dar_Bins::reset()
+{
+  for (auto &_bin : m_bins){
+    _bin.clear();
+  }
+  return 0;
+}
@@ -0,0 +1,390 @@
+#include "contraction_hierarchy.h"
+
+#include <limits>
+#include <functional>
+#include <queue>
+#include <iterator>
+
+MNM_CCH::MNM_CCH(const MNM_Graph_CSR *csr)
+{
+  m_csr = csr;
+  m_num_node = csr -> m_num_node;
+  const int _num_node = m_num_node;
+
+  // undirected neighbors without self loops and parallel links
+  std::vector<std::vector<int>> _adj = std::vector<std::vector<int>>(_num_node);
+  for (int _link = 0; _link < csr -> m_num_link; ++_link){
+    int _from = csr -> m_link_from[_link], _to = csr -> m_link_to[_link];
+    if (_from == _to) continue;
+    _adj[_from].push_back(_to);
+    _adj[_to].push_back(_from);
+  }
+  for (int i = 0; i < _num_node; ++i){
+    std::sort(_adj[i].begin(), _adj[i].end());
+    _adj[i].erase(std::unique(_adj[i].begin(), _adj[i].end()), _adj[i].end());
+  }
+
+  // minimum degree order, the neighbors left when a node is contracted become a clique
+  m_order = std::vector<int>();
+  m_order.reserve(_num_node);
+  m_rank = std::vector<int>(_num_node, -1);
+  std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>,
+                      std::greater<std::pair<int, int>>> _Q;
+  for (int i = 0; i < _num_node; ++i){
+    _Q.push(std::make_pair(int(_adj[i].size()), i));
+  }
+  std::vector<int> _merged = std::vector<int>();
+  while (!_Q.empty()){
+    int _degree = _Q.top().first;
+    int _node = _Q.top().second;
+    _Q.pop();
+    if (m_rank[_node] >= 0 || _degree != int(_adj[_node].size())) continue;
+    m_rank[_node] = int(m_order.size());
+    m_order.push_back(_node);
+    for (int _neighbor : _adj[_node]){
+      std::vector<int> &_list = _adj[_neighbor];
+      _merged.clear();
+      std::set_union(_list.begin(), _list.end(), _adj[_node].begin(), _adj[_node].end(),
+                     std::back_inserter(_merged));
+      _list.clear();
+      for (int _other : _merged){
+        if (_other != _neighbor && _other != _node) _list.push_back(_other);
+      }
+      _Q.push(std::make_pair(int(_list.size()), _neighbor));
+    }
+  }
+
+  // what is left in _adj[i] are the upward neighbors of i
+  m_up_offset = std::vector<int>(_num_node + 1, 0);
+  for (int i = 0; i < _num_node; ++i){
+    m_up_offset[i + 1] = m_up_offset[i] + int(_adj[i].size());
+  }
+  int _num_arc = m_up_offset[_num_node];
+  m_up_tail = std::vector<int>(_num_arc);
+  m_up_head = std::vector<int>(_num_arc);
+  m_parent = std::vector<int>(_num_node, -1);
+  for (int i = 0; i < _num_node; ++i){
+    std::sort(_adj[i].begin(), _adj[i].end(), [this](int a, int b){ return m_rank[a] < m_rank[b]; });
+    std::copy(_adj[i].begin(), _adj[i].end(), m_up_head.begin() + m_up_offset[i]);
+    std::fill(m_up_tail.begin() + m_up_offset[i], m_up_tail.begin() + m_up_offset[i + 1], i);
+    if (!_adj[i].empty()) m_parent[i] = _adj[i].front();
+  }
+  m_up_weight = std::vector<double>(_num_arc);
+  m_down_weight = std::vector<double>(_num_arc);
+  m_up_link = std::vector<int>(_num_arc);
+  m_down_link = std::vector<int>(_num_arc);
+  m_up_child = std::vector<int>(2 * _num_arc);
+  m_down_child = std::vector<int>(2 * _num_arc);
+}
+
+MNM_CCH::~MNM_CCH()
+{
+  ;
+}
+
+int MNM_CCH::find_arc(int low, int high)
+{
+  auto _begin = m_up_head.begin() + m_up_offset[low];
+  auto _end = m_up_head.begin() + m_up_offset[low + 1];
+  auto _it = std::lower_bound(_begin, _end, high, [this](int a, int b){ return m_rank[a] < m_rank[b]; });
+  if (_it == _end || *_it != high) return -1;
+  return int(_it - m_up_head.begin());
+}
+
+int MNM_CCH::customize(const double *cost)
+{
+  const double _inf = std::numeric_limits<double>::max();
+  std::fill(m_up_weight.begin(), m_up_weight.end(), _inf);
+  std::fill(m_down_weight.begin(), m_down_weight.end(), _inf);
+  std::fill(m_up_link.begin(), m_up_link.end(), -1);
+  std::fill(m_down_link.begin(), m_down_link.end(), -1);
+  std::fill(m_up_child.begin(), m_up_child.end(), -1);
+  std::fill(m_down_child.begin(), m_down_child.end(), -1);
+
+  // links, the cheapest of parallel links wins and ties go to the lower link index
+  int _from, _to, _arc;
+  for (int _link = 0; _link < m_csr -> m_num_link; ++_link){
+    _from = m_csr -> m_link_from[_link];
+    _to = m_csr -> m_link_to[_link];
+    if (_from == _to) continue;
+    if (m_rank[_from] < m_rank[_to]){
+      _arc = find_arc(_from, _to);
+      if (cost[_link] < m_up_weight[_arc]){
+        m_up_weight[_arc] = cost[_link];
+        m_up_link[_arc] = _link;
+      }
+    }
+    else{
+      _arc = find_arc(_to, _from);
+      if (cost[_link] < m_down_weight[_arc]){
+        m_down_weight[_arc] = cost[_link];
+        m_down_link[_arc] = _link;
+      }
+    }
+  }
+
+  // lower triangles bottom up: arc (u, w) through every node v below both,
+  // the arcs out of v are final because all their own lower triangles were done before
+  std::vector<int> _arc_to = std::vector<int>(m_num_node, -1);
+  double _alt;
+  for (int _node : m_order){
+    for (int i = m_up_offset[_node]; i < m_up_offset[_node + 1]; ++i){
+      int _head = m_up_head[i];
+      for (int c = m_up_offset[_head]; c < m_up_offset[_head + 1]; ++c){
+        _arc_to[m_up_head[c]] = c;
+      }
+      for (int j = i + 1; j < m_up_offset[_node + 1]; ++j){
+        _arc = _arc_to[m_up_head[j]];
+        // _head -> _node -> m_up_head[j]
+        if (m_down_weight[i] < _inf && m_up_weight[j] < _inf){
+          _alt = m_down_weight[i] + m_up_weight[j];
+          if (_alt < m_up_weight[_arc]){
+            m_up_weight[_arc] = _alt;
+            m_up_link[_arc] = -1;
+            m_up_child[2 * _arc] = i;
+            m_up_child[2 * _arc + 1] = j;
+          }
+        }
+        // m_up_head[j] -> _node -> _head
+        if (m_down_weight[j] < _inf && m_up_weight[i] < _inf){
+          _alt = m_down_weight[j] + m_up_weight[i];
+          if (_alt < m_down_weight[_arc]){
+            m_down_weight[_arc] = _alt;
+            m_down_link[_arc] = -1;
+            m_down_child[2 * _arc] = j;
+            m_down_child[2 * _arc + 1] = i;
+          }
+        }
+      }
+      for (int c = m_up_offset[_head]; c < m_up_offset[_head + 1]; ++c){
+        _arc_to[m_up_head[c]] = -1;
+      }
+    }
+  }
+  return 0;
+}
+
+int MNM_CCH::unpack(int arc, bool upward, std::vector<int> &path_link)
+{
+  int _link = upward ? m_up_link[arc] : m_down_link[arc];
+  if (_link >= 0){
+    path_link.push_back(_link);
+    return 0;
+  }
+  const int *_child = upward ? &m_up_child[2 * arc] : &m_down_child[2 * arc];
+  unpack(_child[0], false, path_link);
+  unpack(_child[1], true, path_link);
+  return 0;
+}
+
+int MNM_CCH::scan_up(int origin_index, double *dist, int *pred)
+{
+  const double _inf = std::numeric_limits<double>::max();
+  for (int _node = origin_index; _node >= 0; _node = m_parent[_node]){
+    dist[_node] = _inf;
+  }
+  dist[origin_index] = 0.;
+  pred[origin_index] = -1;
+  double _alt;
+  for (int _node = origin_index; _node >= 0; _node = m_parent[_node]){
+    if (dist[_node] == _inf) continue;
+    for (int e = m_up_offset[_node]; e < m_up_offset[_node + 1]; ++e){
+      if (m_up_weight[e] == _inf) continue;
+      _alt = dist[_node] + m_up_weight[e];
+      if (_alt < dist[m_up_head[e]]){
+        dist[m_up_head[e]] = _alt;
+        pred[m_up_head[e]] = e;
+      }
+    }
+  }
+  return 0;
+}
+
+int MNM_CCH::scan_down(int dest_index, double *dist, int *pred)
+{
+  const double _inf = std::numeric_limits<double>::max();
+  for (int _node = dest_index; _node >= 0; _node = m_parent[_node]){
+    dist[_node] = _inf;
+  }
+  dist[dest_index] = 0.;
+  pred[dest_index] = -1;
+  double _alt;
+  for (int _node = dest_index; _node >= 0; _node = m_parent[_node]){
+    if (dist[_node] == _inf) continue;
+    for (int e = m_up_offset[_node]; e < m_up_offset[_node + 1]; ++e){
+      if (m_down_weight[e] == _inf) continue;
+      _alt = dist[_node] + m_down_weight[e];
+      if (_alt < dist[m_up_head[e]]){
+        dist[m_up_head[e]] = _alt;
+        pred[m_up_head[e]] = e;
+      }
+    }
+  }
+  return 0;
+}
+
+int MNM_CCH::set_destination(int dest_index, MNM_SP_Workspace *workspace)
+{
+  workspace -> start_query(m_num_node);
+  scan_down(dest_index, workspace -> m_bwd_dist.data(), workspace -> m_bwd_pred.data());
+  for (int _node = dest_index; _node >= 0; _node = m_parent[_node]){
+    workspace -> m_bwd_stamp[_node] = workspace -> m_stamp;
+  }
+  return 0;
+}
+
+int MNM_CCH::find_meet(int origin_index, MNM_SP_Workspace *workspace, double &best)
+{
+  const double _inf = std::numeric_limits<double>::max();
+  double *_fwd_dist = workspace -> m_fwd_dist.data();
+  const double *_bwd_dist = workspace -> m_bwd_dist.data();
+  const unsigned int *_bwd_stamp = workspace -> m_bwd_stamp.data();
+  scan_up(origin_index, _fwd_dist, workspace -> m_fwd_pred.data());
+  best = _inf;
+  int _meet = -1;
+  for (int _node = origin_index; _node >= 0; _node = m_parent[_node]){
+    if (_bwd_stamp[_node] != workspace -> m_stamp || _fwd_dist[_node] == _inf || _bwd_dist[_node] == _inf) continue;
+    if (_fwd_dist[_node] + _bwd_dist[_node] < best){
+      best = _fwd_dist[_node] + _bwd_dist[_node];
+      _meet = _node;
+    }
+  }
+  return _meet;
+}
+
+int MNM_CCH::unpack_up(int origin_index, int meet, const int *pred, std::vector<int> &path_link)
+{
+  // pred goes from the meeting node back to the origin, the links are appended from the origin
+  if (meet == origin_index) return 0;
+  unpack_up(origin_index, m_up_tail[pred[meet]], pred, path_link);
+  unpack(pred[meet], true, path_link);
+  return 0;
+}
+
+double MNM_CCH::distance(int origin_index, int dest_index, MNM_SP_Workspace *workspace)
+{
+  if (workspace == NULL) workspace = MNM_SP_Workspace::get_thread_workspace();
+  set_destination(dest_index, workspace);
+  double _best;
+  find_meet(origin_index, workspace, _best);
+  return _best;
+}
+
+int MNM_CCH::one_to_one(int origin_index, int dest_index, std::vector<int> &path_link,
+                        MNM_SP_Workspace *workspace)
+{
+  if (workspace == NULL) workspace = MNM_SP_Workspace::get_thread_workspace();
+  path_link.clear();
+  set_destination(dest_index, workspace);
+  double _best;
+  int _meet = find_meet(origin_index, workspace, _best);
+  if (_meet < 0) return -1;
+  unpack_up(origin_index, _meet, workspace -> m_fwd_pred.data(), path_link);
+  for (int _node = _meet; workspace -> m_bwd_pred[_node] >= 0; _node = m_up_tail[workspace -> m_bwd_pred[_node]]){
+    unpack(workspace -> m_bwd_pred[_node], false, path_link);
+  }
+  return 0;
+}
+
+int MNM_CCH::set_targets(const std::vector<int> &target)
+{
+  const double _inf = std::numeric_limits<double>::max();
+  m_target = target;
+  m_target_offset = std::vector<int>(1, 0);
+  m_target_node.clear();
+  m_target_dist.clear();
+  m_target_pred.clear();
+  m_target_next.clear();
+  m_entry_target.clear();
+  m_bucket_offset = std::vector<int>(m_num_node + 1, 0);
+
+  // downward scan of every target, the reached ancestors are kept in rank order
+  std::vector<double> _dist = std::vector<double>(m_num_node);
+  std::vector<int> _pred = std::vector<int>(m_num_node);
+  std::vector<int> _entry = std::vector<int>(m_num_node);
+  for (int j = 0; j < int(target.size()); ++j){
+    scan_down(target[j], _dist.data(), _pred.data());
+    for (int _node = target[j]; _node >= 0; _node = m_parent[_node]){
+      if (_dist[_node] == _inf) continue;
+      _entry[_node] = int(m_target_node.size());
+      m_target_node.push_back(_node);
+      m_target_dist.push_back(_dist[_node]);
+      m_target_pred.push_back(_pred[_node]);
+      // the tail of the pred arc is below _node, so its entry is already there
+      m_target_next.push_back(_pred[_node] < 0 ? -1 : _entry[m_up_tail[_pred[_node]]]);
+      m_entry_target.push_back(j);
+      m_bucket_offset[_node + 1]++;
+    }
+    m_target_offset.push_back(int(m_target_node.size()));
+  }
+
+  // the bucket of a node lists the entries of all targets that reach it
+  for (int i = 0; i < m_num_node; ++i){
+    m_bucket_offset[i + 1] += m_bucket_offset[i];
+  }
+  m_bucket_entry = std::vector<int>(m_target_node.size());
+  std::vector<int> _pos = std::vector<int>(m_bucket_offset.begin(), m_bucket_offset.end() - 1);
+  for (int k = 0; k < int(m_target_node.size()); ++k){
+    m_bucket_entry[_pos[m_target_node[k]]++] = k;
+  }
+  return 0;
+}
+
+int MNM_CCH::scan_targets(int origin_index, double *dist, int *meet_entry, MNM_SP_Workspace *workspace)
+{
+  const double _inf = std::numeric_limits<double>::max();
+  std::fill(dist, dist + m_target.size(), _inf);
+  if (meet_entry != NULL) std::fill(meet_entry, meet_entry + m_target.size(), -1);
+  workspace -> start_query(m_num_node);
+  double *_fwd_dist = workspace -> m_fwd_dist.data();
+  scan_up(origin_index, _fwd_dist, workspace -> m_fwd_pred.data());
+  int _entry, _target;
+  for (int _node = origin_index; _node >= 0; _node = m_parent[_node]){
+    if (_fwd_dist[_node] == _inf) continue;
+    for (int b = m_bucket_offset[_node]; b < m_bucket_offset[_node + 1]; ++b){
+      _entry = m_bucket_entry[b];
+      _target = m_entry_target[_entry];
+      if (_fwd_dist[_node] + m_target_dist[_entry] < dist[_target]){
+        dist[_target] = _fwd_dist[_node] + m_target_dist[_entry];
+        if (meet_entry != NULL) meet_entry[_target] = _entry;
+      }
+    }
+  }
+  return 0;
+}
+
+int MNM_CCH::get_distance_from(int origin_index, double *dist, MNM_SP_Workspace *workspace)
+{
+  if (workspace == NULL) workspace = MNM_SP_Workspace::get_thread_workspace();
+  return scan_targets(origin_index, dist, NULL, workspace);
+}
+
+int MNM_CCH::get_paths_from(int origin_index, double *dist, std::vector<std::vector<int>> &path_link,
+                            MNM_SP_Workspace *workspace)
+{
+  if (workspace == NULL) workspace = MNM_SP_Workspace::get_thread_workspace();
+  std::vector<int> _meet_entry = std::vector<int>(m_target.size());
+  scan_targets(origin_index, dist, _meet_entry.data(), workspace);
+  path_link.resize(m_target.size());
+  int _entry;
+  for (int j = 0; j < int(m_target.size()); ++j){
+    path_link[j].clear();
+    _entry = _meet_entry[j];
+    if (_entry < 0) continue;
+    unpack_up(origin_index, m_target_node[_entry], workspace -> m_fwd_pred.data(), path_link[j]);
+    for (; m_target_pred[_entry] >= 0; _entry = m_target_next[_entry]){
+      unpack(m_target_pred[_entry], false, path_link[j]);
+    }
+  }
+  return 0;
+}
+
+int MNM_CCH::many_to_many(const std::vector<int> &source, const std::vector<int> &target, double *dist)
+{
+  set_targets(target);
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < int(source.size()); ++i){
+    get_distance_from(source[i], dist + size_t(i) * target.size());
+  }
+  return 0;
+}
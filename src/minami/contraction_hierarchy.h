@@ -0,0 +1,96 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include "Snap.h"
+#include "shortest_path.h"
+
+#include <vector>
+
+
+
+/*------------------------------------------------------------
+                  Customizable contraction hierarchy
+-------------------------------------------------------------*/
+// The nodes of the CSR snapshot are contracted once in a minimum degree order that does not
+// depend on the cost, every contraction adds the shortcuts between the remaining neighbors,
+// so the upward neighbors of a node form a clique and are all its ancestors in the elimination
+// tree (parent = lowest ranked upward neighbor).
+// customize() puts a cost vector on the shortcut graph in O(#triangles) and can be called again
+// whenever only the link costs change. A query scans the elimination tree ancestors of the origin
+// upwards and of the destination downwards, no heap, and the shortcuts are unpacked into links.
+class MNM_CCH
+{
+public:
+  MNM_CCH(const MNM_Graph_CSR *csr);
+  ~MNM_CCH();
+  // cost[i] is the cost of CSR link i, non negative
+  int customize(const double *cost);
+
+  // DBL_MAX if dest can not be reached
+  double distance(int origin_index, int dest_index, MNM_SP_Workspace *workspace = NULL);
+  // path_link gets the CSR link indices from origin to dest, returns -1 if dest can not be reached
+  int one_to_one(int origin_index, int dest_index, std::vector<int> &path_link,
+                 MNM_SP_Workspace *workspace = NULL);
+
+  // bucket based many to many: set_targets scans every target downwards once and files the reached
+  // nodes into buckets, then every origin is scanned upwards once against the buckets.
+  // set_targets is not thread safe, the get_*_from calls are once the targets are set
+  int set_targets(const std::vector<int> &target);
+  // dist[j] from origin to target j
+  int get_distance_from(int origin_index, double *dist, MNM_SP_Workspace *workspace = NULL);
+  // also path_link[j] from origin to target j, empty where dist[j] is DBL_MAX
+  int get_paths_from(int origin_index, double *dist, std::vector<std::vector<int>> &path_link,
+                     MNM_SP_Workspace *workspace = NULL);
+  // dist[i * target.size() + j] from source[i] to target[j]
+  int many_to_many(const std::vector<int> &source, const std::vector<int> &target, double *dist);
+
+  const MNM_Graph_CSR *m_csr;
+  int m_num_node;
+  // m_order[r] is the node contracted r-th, m_rank is its inverse
+  std::vector<int> m_order;
+  std::vector<int> m_rank;
+  std::vector<int> m_parent;
+  // upward arcs m_up_offset[i] .. m_up_offset[i+1] from node i to higher ranked m_up_head, in rank order
+  std::vector<int> m_up_offset;
+  std::vector<int> m_up_tail;
+  std::vector<int> m_up_head;
+  // customized costs, m_up_weight from tail to head and m_down_weight from head to tail
+  std::vector<double> m_up_weight;
+  std::vector<double> m_down_weight;
+  // an arc is either the link m_*_link or, when that is -1, the two arcs m_*_child[2 * arc] (taken
+  // downwards) and m_*_child[2 * arc + 1] (taken upwards) through a lower node
+  std::vector<int> m_up_link;
+  std::vector<int> m_down_link;
+  std::vector<int> m_up_child;
+  std::vector<int> m_down_child;
+  // downward scans of the targets, entries m_target_offset[j] .. m_target_offset[j+1] of target j in rank order,
+  // m_target_pred is the arc from the entry node down towards the target
+  std::vector<int> m_target;
+  std::vector<int> m_target_offset;
+  std::vector<int> m_target_node;
+  std::vector<double> m_target_dist;
+  std::vector<int> m_target_pred;
+  // entry of the tail of m_target_pred, the next node towards the target
+  std::vector<int> m_target_next;
+  std::vector<int> m_entry_target;
+  // the entries reaching node i are m_bucket_entry[m_bucket_offset[i] .. m_bucket_offset[i+1])
+  std::vector<int> m_bucket_offset;
+  std::vector<int> m_bucket_entry;
+private:
+  int find_arc(int low, int high);
+  int unpack(int arc, bool upward, std::vector<int> &path_link);
+  // scans of the ancestors of node_index, upward from an origin or downward to a destination
+  int scan_up(int origin_index, double *dist, int *pred);
+  int scan_down(int dest_index, double *dist, int *pred);
+  // one to one: the downward scan of dest is kept in the workspace, find_meet returns the best node
+  // on the ancestors of origin_index, -1 for none
+  int set_destination(int dest_index, MNM_SP_Workspace *workspace);
+  int find_meet(int origin_index, MNM_SP_Workspace *workspace, double &best);
+  // appends the links of the upward part of a path, pred holds the arcs of scan_up
+  int unpack_up(int origin_index, int meet, const int *pred, std::vector<int> &path_link);
+  int scan_targets(int origin_index, double *dist, int *meet_entry, MNM_SP_Workspace *workspace);
+};
+
+
+
+#endif
@@ -33,6 +33,7 @@ MNM_Dlink::MNM_Dlink( TInt ID,
   m_N_out = NULL;
   m_N_in_tree = NULL;
   m_N_out_tree = NULL;
+  m_dar_bins = NULL;
 }
 
 MNM_Dlink::~MNM_Dlink()
@@ -43,6 +44,7 @@ MNM_Dlink::~MNM_Dlink()
   if (m_N_in != NULL) delete m_N_in;
   if (m_N_in_tree != NULL) delete m_N_in_tree;
   if (m_N_out_tree != NULL) delete m_N_out_tree;  
+  if (m_dar_bins != NULL) delete m_dar_bins;
 }
 
 int MNM_Dlink::hook_up_node(MNM_Dnode *from, MNM_Dnode *to)
@@ -81,6 +83,31 @@ int MNM_Dlink::install_cumulative_curve_tree()
   return 0;
 }
 
+int MNM_Dlink::install_dar_bins(MNM_Dar_Observation *observation)
+{
+  if (m_dar_bins != NULL){
+    delete m_dar_bins;
+  }
+  m_dar_bins = new MNM_Dar_Bins(observation);
+  return 0;
+}
+
+int MNM_Dlink::reset()
+{
+  m_finished_array.clear();
+  m_incoming_array.clear();
+  if (m_N_in != NULL || m_N_out != NULL){
+    install_cumulative_curve();
+  }
+  if (m_N_in_tree != NULL || m_N_out_tree != NULL){
+    install_cumulative_curve_tree();
+  }
+  if (m_dar_bins != NULL){
+    m_dar_bins -> reset();
+  }
+  return 0;
+}
+
 int MNM_Dlink::move_veh_queue(std::deque<MNM_Veh*> *from_queue,
                                   std::deque<MNM_Veh*> *to_queue, 
                                   TInt number_tomove)
@@ -248,6 +275,16 @@ int MNM_Dlink_Ctm::evolve(TInt timestamp)
   return 0;
 }
 
+int MNM_Dlink_Ctm::reset()
+{
+  MNM_Dlink::reset();
+  for (Ctm_Cell* _cell : m_cell_array){
+    _cell -> m_veh_queue.clear();
+    _cell -> m_volume = TInt(0);
+    _cell -> m_out_veh = TInt(0);
+  }
+  return 0;
+}
 
 TFlt MNM_Dlink_Ctm::get_link_supply() {
   return m_cell_array[0] -> get_supply();
@@ -431,6 +468,14 @@ int MNM_Dlink_Pq::evolve(TInt timestamp)
   return 0;
 }
 
+int MNM_Dlink_Pq::reset()
+{
+  MNM_Dlink::reset();
+  m_veh_queue.clear();
+  m_volume = TInt(0);
+  return 0;
+}
+
 TFlt MNM_Dlink_Pq::get_link_flow()
 {
   return TFlt(m_volume) / m_flow_scalar;
@@ -549,6 +594,14 @@ int MNM_Dlink_Lq::evolve(TInt timestamp)
   return 0;
 }
 
+int MNM_Dlink_Lq::reset()
+{
+  MNM_Dlink::reset();
+  m_veh_queue.clear();
+  m_volume = TInt(0);
+  return 0;
+}
+
 TFlt MNM_Dlink_Lq::get_link_flow()
 {
   return TFlt(m_volume) / m_flow_scalar;
@@ -826,6 +879,18 @@ MNM_Dlink_Ltm::~MNM_Dlink_Ltm()
   m_veh_queue.clear();
 }
 
+int MNM_Dlink_Ltm::reset()
+{
+  MNM_Dlink::reset();
+  m_veh_queue.clear();
+  m_volume = TInt(0);
+  m_current_timestamp = TInt(0);
+  m_N_in2.m_recorder.clear();
+  m_N_out2.m_recorder.clear();
+  m_previous_finished_flow = TFlt(0);
+  return 0;
+}
+
 TFlt MNM_Dlink_Ltm::get_link_flow()
 {
   return TFlt(m_volume) / m_flow_scalar;
@@ -48,6 +48,33 @@ public:
   int print_out();
 };
 
+// observation windows and registered paths shared by all MNM_Dar_Bins,
+// a window w covers the loading intervals (m_windows[w].first, m_windows[w].second]
+class MNM_Dar_Observation
+{
+public:
+  MNM_Dar_Observation(std::vector<std::pair<TInt, TInt>> &windows, std::vector<MNM_Path*> &path_vec);
+  ~MNM_Dar_Observation();
+  std::vector<std::pair<TInt, TInt>> m_windows;
+  std::vector<MNM_Path*> m_path_vec;
+  std::unordered_map<MNM_Path*, TInt> m_path_index;
+  std::vector<std::vector<TInt>> m_time_to_window;
+  TInt m_num_path;
+};
+
+// online DAR accumulation, replaces the cc tree when only DAR is needed
+// one bin map per window, keyed by path_index + num_path * departing_int
+class MNM_Dar_Bins
+{
+public:
+  MNM_Dar_Bins(MNM_Dar_Observation *observation);
+  ~MNM_Dar_Bins();
+  MNM_Dar_Observation *m_observation;
+  std::vector<std::unordered_map<TInt, TFlt>> m_bins;
+  int add_flow(TInt timestamp, TFlt flow, MNM_Path* path, TInt departing_int);
+  int reset();
+};
+
 
 /**************************************************************************
                           Dlink family
@@ -68,9 +95,12 @@ public:
   int hook_up_node(MNM_Dnode *from, MNM_Dnode *to);
   TFlt virtual get_link_flow() {return TFlt(0);};
   TFlt virtual get_link_tt() {return TFlt(0);};
+  // drop all vehicles and recorded curves, back to the state before loading
+  int virtual reset();
 
   int install_cumulative_curve();
   int install_cumulative_curve_tree();
+  int install_dar_bins(MNM_Dar_Observation *observation);
 // protected:
   TInt m_link_ID;
   MNM_Dnode *m_from_node;
@@ -85,6 +115,7 @@ public:
   MNM_Cumulative_Curve *m_N_out;
   MNM_Tree_Cumulative_Curve *m_N_in_tree;
   MNM_Tree_Cumulative_Curve *m_N_out_tree;
+  MNM_Dar_Bins *m_dar_bins;
 
 //protected:
   int virtual move_veh_queue(std::deque<MNM_Veh*> *from_queue, std::deque<MNM_Veh*> *to_queue, TInt number_tomove);
@@ -109,6 +140,7 @@ public:
   void virtual print_info() override;
   TFlt virtual get_link_flow() override;
   TFlt virtual get_link_tt() override;
+  int virtual reset() override;
 
 // private:
   class Ctm_Cell;
@@ -163,6 +195,7 @@ public:
   void virtual print_info() override;
   TFlt virtual get_link_flow() override;
   TFlt virtual get_link_tt() override;
+  int virtual reset() override;
 // private:
   std::unordered_map<MNM_Veh*, TInt> m_veh_queue;
   TInt m_volume; //vehicle number, without the flow scalar
@@ -197,6 +230,7 @@ public:
   void virtual print_info() override;
   TFlt virtual get_link_flow() override;
   TFlt virtual get_link_tt() override;
+  int virtual reset() override;
 // private:
   std::deque<MNM_Veh*> m_veh_queue;
   TInt m_volume; //vehicle number, without the flow scalar
@@ -236,6 +270,7 @@ public:
   void virtual print_info() override;
   TFlt virtual get_link_flow() override;
   TFlt virtual get_link_tt() override;
+  int virtual reset() override;
 // private:
   std::deque<MNM_Veh*> m_veh_queue;
   MNM_Cumulative_Curve m_N_in2;
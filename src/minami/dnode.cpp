@@ -113,6 +113,15 @@ int MNM_DMOND::add_out_link(MNM_Dlink* out_link)
   return 0;
 }
 
+int MNM_DMOND::reset()
+{
+  m_in_veh_queue.clear();
+  for (auto _it = m_out_volume.begin(); _it != m_out_volume.end(); _it++){
+    _it -> second = TInt(0);
+  }
+  return 0;
+}
+
 void MNM_DMOND::print_info()
 {
   ;
@@ -172,6 +181,12 @@ int MNM_DMDND::evolve(TInt timestamp)
   return 0;
 }
 
+int MNM_DMDND::reset()
+{
+  m_out_veh_queue.clear();
+  return 0;
+}
+
 void MNM_DMDND::print_info()
 {
   ;
@@ -209,6 +224,11 @@ int MNM_Dnode_Inout::prepare_loading()
   TInt _num_in = m_in_link_array.size();
   TInt _num_out = m_out_link_array.size();
   // printf("node id %d, num_in: %d, num_out: %d\n",m_node_ID(), _num_in(), _num_out());
+  // called again after MNM_Dta::reset
+  if (m_demand != NULL) free(m_demand);
+  if (m_supply != NULL) free(m_supply);
+  if (m_veh_flow != NULL) free(m_veh_flow);
+  if (m_veh_tomove != NULL) free(m_veh_tomove);
   m_demand = (TFlt*) malloc(sizeof(TFlt) * _num_in * _num_out);
   memset(m_demand, 0x0, sizeof(TFlt) * _num_in * _num_out);
   m_supply = (TFlt*) malloc(sizeof(TFlt) * _num_out);
@@ -379,6 +399,9 @@ int MNM_Dnode_Inout::move_vehicle(TInt timestamp)
               // printf("record in link cc tree: link ID %d, time %d, path id %d, assign interval %d\n", _in_link -> m_link_ID(), timestamp()+1, _veh -> m_path -> m_path_ID(), _veh -> m_assign_interval());
               _in_link -> m_N_out_tree -> add_flow(TFlt(timestamp + 1), TFlt(1)/m_flow_scalar, _veh -> m_path, _veh -> m_assign_interval);
             }
+            if (_out_link -> m_dar_bins != NULL) {
+              _out_link -> m_dar_bins -> add_flow(timestamp + 1, TFlt(1)/m_flow_scalar, _veh -> m_path, _veh -> m_assign_interval);
+            }
           }
           else {
             _veh_it++;
@@ -495,6 +518,8 @@ int MNM_Dnode_GRJ::prepare_loading()
 {
   MNM_Dnode_Inout::prepare_loading();
   TInt _num_in = m_in_link_array.size();
+  if (m_d_a != NULL) free(m_d_a);
+  if (m_C_a != NULL) free(m_C_a);
   m_d_a = (TFlt*) malloc(sizeof(TFlt) * _num_in);
   memset(m_d_a, 0x0, sizeof(TFlt) * _num_in);
   m_C_a = (TFlt*) malloc(sizeof(TFlt) * _num_in);
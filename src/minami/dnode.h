@@ -25,6 +25,8 @@ public:
   int virtual evolve(TInt timestamp){return 0;};
   void virtual print_info(){};
   int virtual prepare_loading(){return 0;};
+  // drop the vehicles held by the node, back to the state before loading
+  int virtual reset(){return 0;};
   int virtual add_out_link(MNM_Dlink* out_link){printf("Error!\n"); return 0;};
   int virtual add_in_link(MNM_Dlink* in_link){printf("Error!\n"); return 0;};
   std::vector<MNM_Dlink*> m_out_link_array;
@@ -41,6 +43,7 @@ public:
   int virtual evolve(TInt timestamp) override;
   void virtual print_info();
   int virtual add_out_link(MNM_Dlink* out_link) override;
+  int virtual reset() override;
   int hook_up_origin(MNM_Origin *origin);
   std::deque<MNM_Veh *> m_in_veh_queue;
 // private:
@@ -56,6 +59,7 @@ public:
   int virtual evolve(TInt timestamp) override;
   void virtual print_info() override;
   int virtual add_in_link(MNM_Dlink *link) override;
+  int virtual reset() override;
   int hook_up_destination(MNM_Destination *dest);
   std::deque<MNM_Veh *> m_out_veh_queue;
 // private:
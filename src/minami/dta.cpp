@@ -1,6 +1,8 @@
 #include "dta.h"
 #include "omp.h"
 
+#include <limits>
+
 MNM_Dta::MNM_Dta(std::string file_folder)
 {
   m_file_folder = file_folder;
@@ -83,14 +85,36 @@ int MNM_Dta::set_statistics()
   return 0;
 }
 
-int MNM_Dta::set_routing()
+int MNM_Dta::set_routing(Path_Table *path_table)
 {
+  // a given path table is only used by the fixed route types
+  std::string _routing_type = m_config -> get_string("routing_type");
+  if (path_table != NULL && _routing_type != "Fixed" && _routing_type != "Hybrid" && _routing_type != "Biclass_Hybrid"){
+    MNM::delete_path_table(path_table);
+    throw std::runtime_error("Error, MNM_Dta::set_routing, routing_type " + _routing_type + " does not take a path table");
+  }
+  auto _check_path_table = [path_table](MNM_ConfReader *conf){
+    if (conf -> get_string("choice_portion") == "Buffer" && !MNM::has_path_table_buffer(path_table)){
+      MNM::delete_path_table(path_table);
+      delete conf;
+      throw std::runtime_error("Error, MNM_Dta::set_routing, choice_portion is Buffer but the path table has no path_buffer");
+    }
+    return path_table;
+  };
   if (m_config -> get_string("routing_type") == "Adaptive"){
     m_routing = new MNM_Routing_Adaptive(m_file_folder, m_graph, m_statistics, m_od_factory, m_node_factory, m_link_factory);
     m_routing -> init_routing();
   }
   else if (m_config -> get_string("routing_type") == "Predetermined"){
-    Path_Table *_path_table = MNM::build_pathset(m_graph, m_od_factory, m_link_factory);
+    // optional, the number of k shortest paths per OD pair, 0 keeps the penalty heuristic
+    TInt _ksp_num_path = TInt(int(m_config -> m_configFile -> Value("DTA", "ksp_num_path", 0.)));
+    Path_Table *_path_table;
+    if (_ksp_num_path > 0){
+      _path_table = MNM::build_pathset_ksp(m_graph, m_od_factory, m_link_factory, _ksp_num_path);
+    }
+    else{
+      _path_table = MNM::build_pathset(m_graph, m_od_factory, m_link_factory);
+    }
     MNM_Pre_Routing *_pre_routing = new MNM_Pre_Routing(_path_table, m_od_factory);
     m_routing = new MNM_Routing_Predetermined(m_graph, m_od_factory, m_node_factory,
                     m_link_factory, _path_table, _pre_routing, m_total_assign_inter);
@@ -98,7 +122,10 @@ int MNM_Dta::set_routing()
   else if (m_config -> get_string("routing_type") == "Fixed"){
     MNM_ConfReader* _tmp_conf = new MNM_ConfReader(m_file_folder + "/config.conf", "FIXED");
     Path_Table *_path_table;
-    if (_tmp_conf -> get_string("choice_portion") == "Buffer"){
+    if (path_table != NULL){
+      _path_table = _check_path_table(_tmp_conf);
+    }
+    else if (_tmp_conf -> get_string("choice_portion") == "Buffer"){
       _path_table = MNM_IO::load_path_table(m_file_folder + "/" + _tmp_conf -> get_string("path_file_name"), 
                       m_graph, _tmp_conf -> get_int("num_path"), true);
     }
@@ -107,8 +134,10 @@ int MNM_Dta::set_routing()
                       m_graph, _tmp_conf -> get_int("num_path"), false);
     }
     TInt _buffer_len = _tmp_conf -> get_int("buffer_length");
-    m_routing = new MNM_Routing_Fixed(m_graph, m_od_factory, m_node_factory, m_link_factory,
+    MNM_Routing_Fixed *_routing = new MNM_Routing_Fixed(m_graph, m_od_factory, m_node_factory, m_link_factory,
                _tmp_conf -> get_int("route_frq"), _buffer_len);
+    _routing -> set_seed(TInt(int(_tmp_conf -> m_configFile -> Value("FIXED", "route_seed", 0.))));
+    m_routing = _routing;
     m_routing -> init_routing(_path_table);
     delete _tmp_conf;
   }
@@ -124,7 +153,10 @@ int MNM_Dta::set_routing()
   else if (m_config -> get_string("routing_type") == "Hybrid"){
     MNM_ConfReader* _tmp_conf = new MNM_ConfReader(m_file_folder + "/config.conf", "FIXED");
     Path_Table *_path_table;
-    if (_tmp_conf -> get_string("choice_portion") == "Buffer"){
+    if (path_table != NULL){
+      _path_table = _check_path_table(_tmp_conf);
+    }
+    else if (_tmp_conf -> get_string("choice_portion") == "Buffer"){
       _path_table = MNM_IO::load_path_table(m_file_folder + "/" + _tmp_conf -> get_string("path_file_name"), 
                       m_graph, _tmp_conf -> get_int("num_path"), true);
     }
@@ -134,8 +166,10 @@ int MNM_Dta::set_routing()
     }
     TInt _route_freq_fixed = _tmp_conf -> get_int("route_frq");
     TInt _buffer_len = _tmp_conf -> get_int("buffer_length");
-    m_routing = new MNM_Routing_Hybrid(m_file_folder, m_graph, m_statistics, m_od_factory, m_node_factory, 
+    MNM_Routing_Hybrid *_routing = new MNM_Routing_Hybrid(m_file_folder, m_graph, m_statistics, m_od_factory, m_node_factory, 
                             m_link_factory, _route_freq_fixed, _buffer_len);
+    _routing -> m_routing_fixed -> set_seed(TInt(int(_tmp_conf -> m_configFile -> Value("FIXED", "route_seed", 0.))));
+    m_routing = _routing;
     m_routing -> init_routing(_path_table);
     delete _tmp_conf;
   }
@@ -147,7 +181,10 @@ int MNM_Dta::set_routing()
   else if (m_config -> get_string("routing_type") == "Biclass_Hybrid"){
     MNM_ConfReader* _tmp_conf = new MNM_ConfReader(m_file_folder + "/config.conf", "FIXED");
     Path_Table *_path_table;
-    if (_tmp_conf -> get_string("choice_portion") == "Buffer"){
+    if (path_table != NULL){
+      _path_table = _check_path_table(_tmp_conf);
+    }
+    else if (_tmp_conf -> get_string("choice_portion") == "Buffer"){
       _path_table = MNM_IO::load_path_table(m_file_folder + "/" + _tmp_conf -> get_string("path_file_name"), 
                       m_graph, _tmp_conf -> get_int("num_path"), true);
     }
@@ -157,9 +194,14 @@ int MNM_Dta::set_routing()
     }
     TInt _buffer_len = _tmp_conf -> get_int("buffer_length");
     TInt _route_freq_fixed = _tmp_conf -> get_int("route_frq");
-    m_routing = new MNM_Routing_Biclass_Hybrid(m_file_folder, m_graph, m_statistics, m_od_factory, 
+    MNM_Routing_Biclass_Hybrid *_routing = new MNM_Routing_Biclass_Hybrid(m_file_folder, m_graph, m_statistics, m_od_factory, 
                                               m_node_factory, m_link_factory, 
                                               _route_freq_fixed, _buffer_len);
+    // the truck streams are shifted so that cars and trucks of an origin do not draw the same numbers
+    TInt _route_seed = TInt(int(_tmp_conf -> m_configFile -> Value("FIXED", "route_seed", 0.)));
+    _routing -> m_routing_fixed_car -> set_seed(_route_seed);
+    _routing -> m_routing_fixed_truck -> set_seed(_route_seed + 1);
+    m_routing = _routing;
     m_routing -> init_routing(_path_table);
     delete _tmp_conf;
   }
@@ -182,21 +224,53 @@ int MNM_Dta::build_workzone()
 
 int MNM_Dta::build_from_files()
 {
-  MNM_IO::build_node_factory(m_file_folder, m_config, m_node_factory);
-  // std::cout << m_node_factory -> m_node_map.size() << "\n";
-  MNM_IO::build_link_factory(m_file_folder, m_config, m_link_factory);
-  // std::cout << m_link_factory -> m_link_map.size() << "\n";
-  MNM_IO::build_od_factory(m_file_folder, m_config, m_od_factory, m_node_factory);
-  // std::cout << m_od_factory -> m_origin_map.size() << "\n";
-  // std::cout << m_od_factory -> m_destination_map.size() << "\n";
-  m_graph = MNM_IO::build_graph(m_file_folder, m_config);
-  MNM_IO::build_demand(m_file_folder, m_config, m_od_factory);
+  MNM_Network_Bundle *_bundle = MNM_IO::load_network_bundle(m_file_folder, m_config);
+  if (_bundle != NULL){
+    build_network(_bundle);
+    delete _bundle;
+  }
+  else{
+    MNM_IO::build_node_factory(m_file_folder, m_config, m_node_factory);
+    // std::cout << m_node_factory -> m_node_map.size() << "\n";
+    MNM_IO::build_link_factory(m_file_folder, m_config, m_link_factory);
+    // std::cout << m_link_factory -> m_link_map.size() << "\n";
+    MNM_IO::build_od_factory(m_file_folder, m_config, m_od_factory, m_node_factory);
+    // std::cout << m_od_factory -> m_origin_map.size() << "\n";
+    // std::cout << m_od_factory -> m_destination_map.size() << "\n";
+    m_graph = MNM_IO::build_graph(m_file_folder, m_config);
+    MNM_IO::build_demand(m_file_folder, m_config, m_od_factory);
+  }
   build_workzone();
   set_statistics();
   set_routing();
   return 0;  
 }
 
+int MNM_Dta::build_from_memory(MNM_Network_Bundle *bundle)
+{
+  build_network(bundle);
+  build_workzone();
+  set_statistics();
+  Path_Table *_path_table = NULL;
+  if (bundle -> m_num_path > 0){
+    _path_table = MNM_IO::build_path_table(m_graph, bundle -> m_num_path, bundle -> m_path_node_offset, 
+                                           bundle -> m_path_node, bundle -> m_num_path_node, 
+                                           bundle -> m_path_buffer, bundle -> m_path_buffer_length);
+  }
+  set_routing(_path_table);
+  return 0;
+}
+
+int MNM_Dta::build_network(MNM_Network_Bundle *bundle)
+{
+  MNM_IO::build_node_factory(bundle, m_config, m_node_factory);
+  MNM_IO::build_link_factory(bundle, m_config, m_link_factory);
+  MNM_IO::build_od_factory(bundle, m_config, m_od_factory, m_node_factory);
+  m_graph = MNM_IO::build_graph(bundle);
+  MNM_IO::build_demand(bundle, m_config, m_od_factory);
+  return 0;
+}
+
 int MNM_Dta::hook_up_node_and_link()
 {
   TInt _node_ID;
@@ -292,24 +366,27 @@ bool MNM_Dta::is_ok()
 
 int MNM_Dta::check_origin_destination_connectivity()
 {
-  MNM_Destination *_dest;
-  TInt _dest_node_ID;
-  std::unordered_map<TInt, TInt> _shortest_path_tree = std::unordered_map<TInt, TInt>();
-  std::unordered_map<TInt, TFlt> _cost_map;
-  for (auto _map_it : m_link_factory -> m_link_map){
-    _cost_map.insert(std::pair<TInt, TFlt>(_map_it.first, TFlt(1)));
+  // unit cost OD distance table on a contraction hierarchy, instead of one tree per destination
+  MNM_Graph_CSR *_csr = new MNM_Graph_CSR(m_graph);
+  std::vector<double> _cost = std::vector<double>(_csr -> m_num_link, 1.);
+  std::vector<int> _origin_index = std::vector<int>();
+  std::vector<int> _dest_index = std::vector<int>();
+  for (auto _map_it : m_od_factory -> m_origin_map){
+    _origin_index.push_back(_csr -> get_node_index(_map_it.second -> m_origin_node -> m_node_ID));
   }
-  
   for (auto _it = m_od_factory -> m_destination_map.begin(); _it != m_od_factory -> m_destination_map.end(); _it++){
-    _dest = _it -> second;
-    _dest_node_ID = _dest -> m_dest_node -> m_node_ID;
-    MNM_Shortest_Path::all_to_one_FIFO(_dest_node_ID, m_graph, _cost_map, _shortest_path_tree);
-    for (auto _map_it : m_od_factory -> m_origin_map){
-      if (_shortest_path_tree.find(_map_it.second -> m_origin_node -> m_node_ID)-> second == -1){
-        return false;
-      }
+    _dest_index.push_back(_csr -> get_node_index(_it -> second -> m_dest_node -> m_node_ID));
+  }
+  MNM_CCH *_cch = new MNM_CCH(_csr);
+  _cch -> customize(_cost.data());
+  std::vector<double> _dist = std::vector<double>(_origin_index.size() * _dest_index.size());
+  _cch -> many_to_many(_origin_index, _dest_index, _dist.data());
+  delete _cch;
+  delete _csr;
+  for (double _d : _dist){
+    if (_d == std::numeric_limits<double>::max()){
+      return false;
     }
-// }
   }
   return true;
 }
@@ -346,6 +423,35 @@ int MNM_Dta::pre_loading()
 }
 
 
+int MNM_Dta::reset()
+{
+  m_statistics -> reset_record();
+  m_routing -> reset();
+  for (auto _node_it : m_node_factory -> m_node_map){
+    _node_it.second -> reset();
+  }
+  for (auto _link_it : m_link_factory -> m_link_map){
+    _link_it.second -> reset();
+  }
+  for (auto _origin_it : m_od_factory -> m_origin_map){
+    _origin_it.second -> m_current_assign_interval = 0;
+  }
+  // vehicles are only referenced by the containers cleared above
+  m_veh_factory -> reset();
+  if (m_emission != NULL) m_emission -> reset();
+
+  m_queue_veh_num.clear();
+  m_enroute_veh_num.clear();
+  for (auto _it = m_queue_veh_map.begin(); _it != m_queue_veh_map.end(); _it++){
+    _it -> second -> clear();
+    delete _it -> second;
+  }  
+  m_queue_veh_map.clear();
+  m_current_loading_interval = TInt(0);
+  return 0;
+}
+
+
 int MNM_Dta::load_once(bool verbose, TInt load_int, TInt assign_int)
 {
   MNM_Origin *_origin;
@@ -11,6 +11,7 @@
 #include "statistics.h"
 #include "routing.h"
 #include "shortest_path.h"
+#include "contraction_hierarchy.h"
 #include "pre_routing.h"
 #include "emission.h"
 
@@ -23,16 +24,25 @@ public:
   virtual ~MNM_Dta();
   int virtual initialize();
   int virtual build_from_files();
+  // the same without the input files: the network and, for the fixed route types, the paths
+  // from the columns of a bundle filled in memory
+  int virtual build_from_memory(MNM_Network_Bundle *bundle);
   bool is_ok();
   int hook_up_node_and_link();
   int loading(bool verbose);
   int load_once(bool verbose, TInt load_int, TInt assign_int);
+  // back to t=0 with the network, demand and path table kept, call pre_loading() before loading again
+  int reset();
   int test();
 // private:
   bool finished_loading(int cur_int);
   int set_statistics();
-  int set_routing();
+  // path_table replaces the path table file of the fixed route types when it is not NULL,
+  // it is owned by the routing afterwards and deleted when it cannot be used
+  int set_routing(Path_Table *path_table = NULL);
   int build_workzone();
+  // factories and graph from a bundle
+  int virtual build_network(MNM_Network_Bundle *bundle);
   int check_origin_destination_connectivity();
   int virtual pre_loading();
   
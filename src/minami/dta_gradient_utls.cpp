@@ -143,4 +143,174 @@ int add_dar_records_eigen(std::vector<Eigen::Triplet<double>> &record, MNM_Dlink
 }
 
 
+int add_dar_records_tree_eigen(std::vector<Eigen::Triplet<double>> &record, MNM_Tree_Cumulative_Curve* tree, 
+                    std::unordered_map<MNM_Path*, int> &path_map, TFlt start_time, TFlt end_time,
+                    int link_ind, int interval_ind, int num_e_link, int num_e_path, int small_assign_freq,
+                    double *f_ptr)
+{
+  if (tree == NULL){
+    throw std::runtime_error("Error, add_dar_records_tree_eigen cummulative curve tree is not installed");
+  }
+  if (small_assign_freq <= 0){
+    throw std::runtime_error("Error, add_dar_records_tree_eigen small_assign_freq must be positive");
+  }
+  int _x, _y;
+  _x = link_ind + num_e_link * interval_ind;
+  for (auto path_it : tree -> m_record){
+    auto _path_iter = path_map.find(path_it.first);
+    if (_path_iter != path_map.end()){
+      for (auto depart_it : path_it.second){
+        TFlt tmp_flow = depart_it.second -> get_result(end_time) - depart_it.second -> get_result(start_time);
+        if (tmp_flow > DBL_EPSILON){
+          _y = (*_path_iter).second + num_e_path * (depart_it.first / small_assign_freq);
+          record.push_back(Eigen::Triplet<double>((double)_x, (double) _y, tmp_flow() / f_ptr[_y]));
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+
+int add_dar_records_bins(std::vector<dar_record*> &record, MNM_Dlink* link, MNM_Dar_Bins* bins)
+{
+  if (link == NULL){
+    throw std::runtime_error("Error, add_dar_records_bins link is null");
+  }
+  if (bins == NULL){
+    throw std::runtime_error("Error, add_dar_records_bins dar bins are not installed");
+  }
+  MNM_Dar_Observation *_observation = bins -> m_observation;
+  TInt _num_path = _observation -> m_num_path;
+  for (size_t w = 0; w < bins -> m_bins.size(); ++w){
+    for (auto _bin_it : bins -> m_bins[w]){
+      if (_bin_it.second > DBL_EPSILON){
+        auto new_record = new dar_record();
+        new_record -> path_ID = _observation -> m_path_vec[_bin_it.first % _num_path] -> m_path_ID;
+        new_record -> assign_int = _bin_it.first / _num_path;
+        new_record -> link_ID = link -> m_link_ID;
+        new_record -> link_start_int = TFlt(_observation -> m_windows[w].first);
+        new_record -> flow = _bin_it.second;
+        record.push_back(new_record);
+      }
+    }
+  }
+  return 0;
+}
+
+
+int add_dar_records_bins_eigen(std::vector<Eigen::Triplet<double>> &record, MNM_Dar_Bins* bins,
+                    int link_ind, int num_e_link, int small_assign_freq, double *f_ptr)
+{
+  if (bins == NULL){
+    throw std::runtime_error("Error, add_dar_records_bins_eigen dar bins are not installed");
+  }
+  if (small_assign_freq <= 0){
+    throw std::runtime_error("Error, add_dar_records_bins_eigen small_assign_freq must be positive");
+  }
+  int _num_e_path = bins -> m_observation -> m_num_path;
+  int _x, _y;
+  for (size_t w = 0; w < bins -> m_bins.size(); ++w){
+    _x = link_ind + num_e_link * int(w);
+    for (auto _bin_it : bins -> m_bins[w]){
+      if (_bin_it.second > DBL_EPSILON){
+        // the bin key is path_index + num_e_path * assign_int
+        _y = _bin_it.first % _num_e_path + _num_e_path * ((_bin_it.first / _num_e_path) / small_assign_freq);
+        record.push_back(Eigen::Triplet<double>((double)_x, (double) _y, _bin_it.second() / f_ptr[_y]));
+      }
+    }
+  }
+  return 0;
+}
+
+int dar_transpose_product(std::vector<MNM_Dar_Bins*> &bins_vec, double *v_ptr, double *f_ptr, double *result_ptr,
+                    int num_intervals, int small_assign_freq)
+{
+  if (bins_vec.size() == 0){
+    return 0;
+  }
+  if (small_assign_freq <= 0){
+    throw std::runtime_error("Error, dar_transpose_product small_assign_freq must be positive");
+  }
+  for (MNM_Dar_Bins *_bins : bins_vec){
+    if (_bins == NULL){
+      throw std::runtime_error("Error, dar_transpose_product dar bins are not installed");
+    }
+  }
+  int _num_e_link = bins_vec.size();
+  int _num_e_path = bins_vec[0] -> m_observation -> m_num_path;
+  int _num_col = num_intervals * _num_e_path;
+  for (int j = 0; j < _num_col; ++j){
+    result_ptr[j] = 0;
+  }
+  // links write to the same columns, so every thread sums into its own buffer first
+  #pragma omp parallel
+  {
+    std::vector<double> _local(_num_col, 0.0);
+    int _x, _y;
+    #pragma omp for schedule(dynamic)
+    for (int i = 0; i < _num_e_link; ++i){
+      for (size_t w = 0; w < bins_vec[i] -> m_bins.size(); ++w){
+        _x = i + _num_e_link * int(w);
+        if (v_ptr[_x] == 0) continue;
+        for (auto _bin_it : bins_vec[i] -> m_bins[w]){
+          if (_bin_it.second > DBL_EPSILON){
+            _y = _bin_it.first % _num_e_path + _num_e_path * ((_bin_it.first / _num_e_path) / small_assign_freq);
+            if (_y < _num_col){
+              _local[_y] += _bin_it.second() / f_ptr[_y] * v_ptr[_x];
+            }
+          }
+        }
+      }
+    }
+    #pragma omp critical
+    {
+      for (int j = 0; j < _num_col; ++j){
+        result_ptr[j] += _local[j];
+      }
+    }
+  }
+  return 0;
+}
+
+
+int dar_product(std::vector<MNM_Dar_Bins*> &bins_vec, double *u_ptr, double *f_ptr, double *result_ptr,
+                    int num_intervals, int small_assign_freq)
+{
+  if (bins_vec.size() == 0){
+    return 0;
+  }
+  if (small_assign_freq <= 0){
+    throw std::runtime_error("Error, dar_product small_assign_freq must be positive");
+  }
+  for (MNM_Dar_Bins *_bins : bins_vec){
+    if (_bins == NULL){
+      throw std::runtime_error("Error, dar_product dar bins are not installed");
+    }
+  }
+  int _num_e_link = bins_vec.size();
+  int _num_e_path = bins_vec[0] -> m_observation -> m_num_path;
+  int _num_col = num_intervals * _num_e_path;
+  // every row belongs to exactly one link, so links can be processed independently
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < _num_e_link; ++i){
+    int _x, _y;
+    double _sum;
+    for (size_t w = 0; w < bins_vec[i] -> m_bins.size(); ++w){
+      _x = i + _num_e_link * int(w);
+      _sum = 0;
+      for (auto _bin_it : bins_vec[i] -> m_bins[w]){
+        if (_bin_it.second > DBL_EPSILON){
+          _y = _bin_it.first % _num_e_path + _num_e_path * ((_bin_it.first / _num_e_path) / small_assign_freq);
+          if (_y < _num_col){
+            _sum += _bin_it.second() / f_ptr[_y] * u_ptr[_y];
+          }
+        }
+      }
+      result_ptr[_x] = _sum;
+    }
+  }
+  return 0;
+}
+
 }//end namespace MNM_DTA_GRADIENT
\ No newline at end of file
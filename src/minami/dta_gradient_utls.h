@@ -35,5 +35,24 @@ int add_dar_records_eigen(std::vector<Eigen::Triplet<double>> &record, MNM_Dlink
                     std::unordered_map<MNM_Path*, int> path_map, TFlt start_time, TFlt end_time,
                     int link_ind, int interval_ind, int num_e_link, int num_e_path,
                     double *f_ptr);
+
+// works on any cc tree (e.g. per class), departing intervals are grouped by small_assign_freq
+int add_dar_records_tree_eigen(std::vector<Eigen::Triplet<double>> &record, MNM_Tree_Cumulative_Curve* tree, 
+                    std::unordered_map<MNM_Path*, int> &path_map, TFlt start_time, TFlt end_time,
+                    int link_ind, int interval_ind, int num_e_link, int num_e_path, int small_assign_freq,
+                    double *f_ptr);
+
+// read the online DAR bins, all observation windows at once
+int add_dar_records_bins(std::vector<dar_record*> &record, MNM_Dlink* link, MNM_Dar_Bins* bins);
+int add_dar_records_bins_eigen(std::vector<Eigen::Triplet<double>> &record, MNM_Dar_Bins* bins,
+                    int link_ind, int num_e_link, int small_assign_freq, double *f_ptr);
+
+// matrix-free products with the DAR matrix built from the online bins, bins_vec[i] is the i-th observed link,
+// D^T v: v has num_window * num_e_link entries, result has num_intervals * num_e_path entries
+// D u: u has num_intervals * num_e_path entries, result has num_window * num_e_link entries
+int dar_transpose_product(std::vector<MNM_Dar_Bins*> &bins_vec, double *v_ptr, double *f_ptr, double *result_ptr,
+                    int num_intervals, int small_assign_freq);
+int dar_product(std::vector<MNM_Dar_Bins*> &bins_vec, double *u_ptr, double *f_ptr, double *result_ptr,
+                    int num_intervals, int small_assign_freq);
 };
 #endif
\ No newline at end of file
@@ -23,6 +23,7 @@ MNM_Due::MNM_Due(std::string file_folder)
   m_late_rate = m_due_config -> get_float("late_rate");
   m_target_time = m_due_config -> get_float("target_time");
   m_step_size = 0.01;
+  m_tdsp_compact = int(m_due_config -> m_configFile -> Value("DUE", "tdsp_compact", 0.)) == 1;
   m_cost_map = std::unordered_map<TInt, TFlt*>();
 }
 
@@ -81,21 +82,17 @@ int MNM_Due::update_demand_from_path_table(MNM_Dta* dta)
   TFlt _tot_dmd;
   MNM_Origin* _org;
   MNM_Destination* _dest;
-  MNM_Path *_one_path;
-  for(auto _it : *m_path_table){
-    for (auto _it_it : *(_it.second)){
-      for (int _col = 0; _col < m_total_assign_inter; _col++){
-        _tot_dmd = 0.0;
-        for (MNM_Path* _path : _it_it.second -> m_path_vec){
-          _tot_dmd += _path -> m_buffer[_col];
-        }
-        if (_it_it.second -> m_path_vec.size() > 0){
-          _one_path = _it_it.second -> m_path_vec[0];
-          _org = ((MNM_DMOND*) dta -> m_node_factory -> get_node(_one_path -> m_node_vec.front())) -> m_origin;
-          _dest = ((MNM_DMDND*) dta -> m_node_factory -> get_node(_one_path -> m_node_vec.back())) -> m_dest;
-          _org -> m_demand[_dest][_col] = _tot_dmd;
-        }
+  const int _num_dest = int(m_path_table -> m_dest_node_ID.size());
+  for (size_t k = 0; k + 1 < m_path_table -> m_od_offset.size(); ++k){
+    if (m_path_table -> m_od_offset[k] == m_path_table -> m_od_offset[k + 1]) continue;
+    _org = ((MNM_DMOND*) dta -> m_node_factory -> get_node(m_path_table -> m_origin_node_ID[k / _num_dest])) -> m_origin;
+    _dest = ((MNM_DMDND*) dta -> m_node_factory -> get_node(m_path_table -> m_dest_node_ID[k % _num_dest])) -> m_dest;
+    for (int _col = 0; _col < m_total_assign_inter; _col++){
+      _tot_dmd = 0.0;
+      for (int i = m_path_table -> m_od_offset[k]; i < m_path_table -> m_od_offset[k + 1]; ++i){
+        _tot_dmd += m_path_table -> m_buffer[i * m_path_table -> m_buffer_length + _col];
       }
+      _org -> m_demand[_dest][_col] = _tot_dmd;
     }
   }
   return 0;
@@ -112,25 +109,42 @@ TFlt MNM_Due::compute_total_demand(MNM_Origin *orig, MNM_Destination* dest, TInt
 
 TFlt MNM_Due::compute_merit_function()
 {
-  TFlt _tt, _depart_time, _dis_utl, _lowest_dis_utl;
+  // all paths are evaluated on all departing intervals in one pass over the cost map
+  std::vector<MNM_Path*> &_path_vec = m_path_table -> m_path;
+  std::unordered_map<TInt, TInt> _link_index = std::unordered_map<TInt, TInt>();
+  std::vector<double> _cost_matrix = std::vector<double>();
+  _cost_matrix.reserve(m_cost_map.size() * m_total_loading_inter);
+  for (auto _cost_it : m_cost_map){
+    _link_index.insert(std::pair<TInt, TInt>(_cost_it.first, TInt(_link_index.size())));
+    for (int i = 0; i < m_total_loading_inter; ++i){
+      _cost_matrix.push_back(_cost_it.second[i]());
+    }
+  }
+  std::vector<double> _depart_time = std::vector<double>(m_total_assign_inter);
+  for (int _col = 0; _col < m_total_assign_inter; _col++){
+    _depart_time[_col] = double(_col);
+  }
+  std::vector<double> _path_tt = std::vector<double>(_path_vec.size() * m_total_assign_inter);
+  MNM_Path_TT_Trie _trie(_path_vec, _link_index);
+  _trie.get_path_tt(_cost_matrix.data(), m_total_loading_inter, _depart_time.data(), m_total_assign_inter, _path_tt.data());
+
+  TFlt _tt, _depart, _dis_utl, _lowest_dis_utl;
   TFlt _total_gap = 0.0;
-  for(auto _it : *m_path_table){
-    for (auto _it_it : *(_it.second)){
-      _lowest_dis_utl = DBL_MAX;
-      for (int _col = 0; _col < m_total_assign_inter; _col++){
-        for (MNM_Path* _path : _it_it.second -> m_path_vec){
-          _depart_time = TFlt(_col);
-          _tt = get_tt(_depart_time, _path);
-          _dis_utl = get_disutility(_depart_time, _tt);
-          if (_dis_utl < _lowest_dis_utl) _lowest_dis_utl = _dis_utl; 
-        }
-        for (MNM_Path* _path : _it_it.second -> m_path_vec){
-          _depart_time = TFlt(_col);
-          _tt = get_tt(_depart_time, _path);
-          _dis_utl = get_disutility(_depart_time, _tt);
-          _total_gap += (_dis_utl - _lowest_dis_utl) * _path -> m_buffer[_col];
-        }        
+  for (size_t k = 0; k + 1 < m_path_table -> m_od_offset.size(); ++k){
+    // the lowest disutility is kept over the departing intervals of an OD, as before
+    _lowest_dis_utl = DBL_MAX;
+    for (int _col = 0; _col < m_total_assign_inter; _col++){
+      _depart = TFlt(_col);
+      for (int i = m_path_table -> m_od_offset[k]; i < m_path_table -> m_od_offset[k + 1]; ++i){
+        _tt = _path_tt[i * m_total_assign_inter + _col];
+        _dis_utl = get_disutility(_depart, _tt);
+        if (_dis_utl < _lowest_dis_utl) _lowest_dis_utl = _dis_utl; 
       }
+      for (int i = m_path_table -> m_od_offset[k]; i < m_path_table -> m_od_offset[k + 1]; ++i){
+        _tt = _path_tt[i * m_total_assign_inter + _col];
+        _dis_utl = get_disutility(_depart, _tt);
+        _total_gap += (_dis_utl - _lowest_dis_utl) * m_path_table -> m_buffer[i * m_path_table -> m_buffer_length + _col];
+      }        
     }
   }
   return _total_gap;
@@ -228,21 +242,16 @@ int MNM_Due_Msa::init_path_flow()
   TFlt _len, _dmd;
   MNM_Origin* _org;
   MNM_Destination* _dest;
-  for(auto _it : *m_path_table){
-    // printf("22m\n");
-    for (auto _it_it : *(_it.second)){
-      // printf("23m\n");
-      _len = TFlt(_it_it.second -> m_path_vec.size());
-      for (MNM_Path* _path : _it_it.second -> m_path_vec){
-        // printf("24m\n");
-        for (int _col = 0; _col < m_total_assign_inter; _col++){
-          // printf("25m\n");
-          _org = ((MNM_DMOND*) m_base_dta -> m_node_factory -> get_node(_path -> m_node_vec.front())) -> m_origin;
-          _dest = ((MNM_DMDND*) m_base_dta -> m_node_factory -> get_node(_path -> m_node_vec.back())) -> m_dest;
-          _dmd = _org -> m_demand[_dest][_col];
-          // printf("%lf\n", _dmd());
-          _path -> m_buffer[_col] = TFlt(1.0) / _len * _dmd;
-        }
+  const int _num_dest = int(m_path_table -> m_dest_node_ID.size());
+  for (size_t k = 0; k + 1 < m_path_table -> m_od_offset.size(); ++k){
+    if (m_path_table -> m_od_offset[k] == m_path_table -> m_od_offset[k + 1]) continue;
+    _len = TFlt(m_path_table -> m_od_offset[k + 1] - m_path_table -> m_od_offset[k]);
+    _org = ((MNM_DMOND*) m_base_dta -> m_node_factory -> get_node(m_path_table -> m_origin_node_ID[k / _num_dest])) -> m_origin;
+    _dest = ((MNM_DMDND*) m_base_dta -> m_node_factory -> get_node(m_path_table -> m_dest_node_ID[k % _num_dest])) -> m_dest;
+    for (int i = m_path_table -> m_od_offset[k]; i < m_path_table -> m_od_offset[k + 1]; ++i){
+      for (int _col = 0; _col < m_total_assign_inter; _col++){
+        _dmd = _org -> m_demand[_dest][_col];
+        m_path_table -> m_buffer[i * m_path_table -> m_buffer_length + _col] = TFlt(1.0) / _len * _dmd;
       }
     }
   }
@@ -271,7 +280,7 @@ std::pair<MNM_Path*, TInt> MNM_Due_Msa::get_best_route(TInt o_node_ID,
   }
   IAssert(_cur_best_time >= 0);
   MNM_Path *_path = new MNM_Path();
-  tdsp_tree -> get_tdsp(o_node_ID, _cur_best_time, m_cost_map, _path);
+  tdsp_tree -> get_tdsp(o_node_ID, _cur_best_time, _path);
   std::pair<MNM_Path*, TInt> _best = std::make_pair(_path, _cur_best_time);
   return _best;
 }
@@ -289,18 +298,53 @@ int MNM_Due_Msa::update_path_table(MNM_Dta *dta, int iter)
   TFlt _tot_change, _tmp_change, _tot_oneOD_demand;
   MNM_Path* _best_path;
   int _best_time_col;
+
+  // one cost array and graph snapshot for all destinations
+  build_cost_map(dta);
+  MNM_Graph_CSR *_csr = new MNM_Graph_CSR(dta -> m_graph);
+  std::vector<float> _cost = std::vector<float>();
+  MNM_TDSP_Tree::build_cost_array(_csr, m_cost_map, m_total_loading_inter, _cost);
+  std::vector<MNM_Destination*> _dest_vec = std::vector<MNM_Destination*>();
+  std::vector<MNM_Origin*> _orig_vec = std::vector<MNM_Origin*>();
   for (auto _it : dta -> m_od_factory -> m_destination_map){
-    _dest = _it.second;
-    _dest_node_ID = _dest -> m_dest_node -> m_node_ID;
-    MNM_TDSP_Tree *_tdsp_tree = new MNM_TDSP_Tree(_dest_node_ID, dta -> m_graph, m_total_loading_inter);
+    _dest_vec.push_back(_it.second);
+  }
+  std::vector<TInt> _orig_node_vec = std::vector<TInt>();
+  for (auto _map_it : dta -> m_od_factory -> m_origin_map){
+    _orig_vec.push_back(_map_it.second);
+    _orig_node_vec.push_back(_map_it.second -> m_origin_node -> m_node_ID);
+  }
+
+  // the trees only read shared data, the best routes are merged below in the serial order
+  int _num_dest = int(_dest_vec.size());
+  int _num_orig = int(_orig_vec.size());
+  std::vector<std::pair<MNM_Path*, TInt>> _best_route 
+    = std::vector<std::pair<MNM_Path*, TInt>>(size_t(_num_dest) * _num_orig);
+  #pragma omp parallel for schedule(dynamic)
+  for (int d = 0; d < _num_dest; ++d){
+    MNM_TDSP_Tree *_tdsp_tree;
+    if (m_tdsp_compact){
+      _tdsp_tree = new MNM_TDSP_Tree_Compact(_dest_vec[d] -> m_dest_node -> m_node_ID, _csr, m_total_loading_inter,
+                     "", _orig_node_vec);
+    }
+    else{
+      _tdsp_tree = new MNM_TDSP_Tree(_dest_vec[d] -> m_dest_node -> m_node_ID, _csr, m_total_loading_inter);
+    }
     _tdsp_tree -> initialize();
-    build_cost_map(dta);
-    // printf("111\n");
-    _tdsp_tree -> update_tree(m_cost_map);
-    for (auto _map_it : dta -> m_od_factory -> m_origin_map){
-      _orig = _map_it.second;
+    _tdsp_tree -> update_tree(_cost.data());
+    for (int o = 0; o < _num_orig; ++o){
+      _best_route[size_t(d) * _num_orig + o] = get_best_route(_orig_vec[o] -> m_origin_node -> m_node_ID, _tdsp_tree);
+    }
+    delete _tdsp_tree;
+  }
+
+  for (int d = 0; d < _num_dest; ++d){
+    _dest = _dest_vec[d];
+    _dest_node_ID = _dest -> m_dest_node -> m_node_ID;
+    for (int o = 0; o < _num_orig; ++o){
+      _orig = _orig_vec[o];
       _orig_node_ID = _orig -> m_origin_node -> m_node_ID;
-      _path_result = get_best_route(_orig_node_ID, _tdsp_tree);
+      _path_result = _best_route[size_t(d) * _num_orig + o];
       _path = _path_result.first;
       _path_set = MNM::get_pathset(m_path_table, _orig_node_ID, _dest_node_ID);
       // TFlt _len = TFlt(_path_set -> m_path_vec.size());
@@ -342,6 +386,9 @@ int MNM_Due_Msa::update_path_table(MNM_Dta *dta, int iter)
       }
     }
   }
+  delete _csr;
+  // the new paths get their rows, the buffers of the old ones are kept
+  m_path_table -> compact();
   MNM::print_path_table(m_path_table, dta -> m_od_factory, true);
   return 0;
 }
\ No newline at end of file
@@ -36,6 +36,8 @@ public:
   TFlt m_late_rate;
   TFlt m_target_time;
   TFlt m_step_size;
+  // optional, 1 keeps the TDSP predecessors in memory mapped files next to the inputs
+  bool m_tdsp_compact;
 
   
   std::unordered_map<TInt, TFlt*> m_cost_map;
@@ -152,4 +152,17 @@ int MNM_Cumulative_Emission::output()
   printf("The emission stats are: ");
   printf("%d, %lf, %lf, %lf, %lf, %lf, %lf\n", m_link_vector[0] -> m_link_ID(), m_fuel(), m_CO2(), m_HC(), m_CO(), m_NOX(), m_VMT());
   return 0;
-}
\ No newline at end of file
+}
+
+int MNM_Cumulative_Emission::reset()
+{
+  m_fuel = TFlt(0);
+  m_CO2 = TFlt(0);
+  m_HC = TFlt(0);
+  m_CO = TFlt(0);
+  m_NOX = TFlt(0);
+  m_VMT = TFlt(0);
+  m_counter = 0;
+  m_link_vector.clear();
+  return 0;
+}
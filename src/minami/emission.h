@@ -23,6 +23,8 @@ public:
 
   int virtual update();
   int virtual output();
+  // zero the totals and unregister all links
+  int virtual reset();
 
   TFlt m_fuel;
   TFlt m_CO2;
@@ -6,6 +6,7 @@ enum DLink_type {MNM_TYPE_CTM, MNM_TYPE_PQ, MNM_TYPE_LQ, MNM_TYPE_LTM};
 enum Dta_type {MNM_TYPE_RANDOM, MNM_TYPE_BOSTON, MNM_TYPE_HYBRID};
 enum Vehicle_type {MNM_TYPE_ADAPTIVE, MNM_TYPE_STATIC};
 enum Record_type {MNM_TYPE_LRN};
+enum SP_heap_type {MNM_TYPE_HEAP_BINARY, MNM_TYPE_HEAP_RADIX, MNM_TYPE_HEAP_DARY};
 
 enum DNode_type_multiclass {MNM_TYPE_ORIGIN_MULTICLASS, MNM_TYPE_DEST_MULTICLASS, MNM_TYPE_FWJ_MULTICLASS};
 enum DLink_type_multiclass {MNM_TYPE_CTM_MULTICLASS, MNM_TYPE_LQ_MULTICLASS, MNM_TYPE_PQ_MULTICLASS};
@@ -29,6 +29,16 @@ MNM_Veh *MNM_Veh_Factory::make_veh(TInt timestamp, Vehicle_type veh_type)
   return _veh;
 }
 
+int MNM_Veh_Factory::reset()
+{
+  for (auto _veh_it : m_veh_map){
+    delete _veh_it.second;
+  }
+  m_veh_map.clear();
+  m_num_veh = TInt(0);
+  return 0;
+}
+
 
 /**************************************************************************
                           Node factory
@@ -24,6 +24,7 @@ public:
   MNM_Veh_Factory();
   virtual ~MNM_Veh_Factory();
   MNM_Veh* make_veh(TInt timestamp, Vehicle_type veh_type);
+  int reset();
   TInt m_num_veh;
   std::unordered_map<TInt, MNM_Veh*> m_veh_map;
 };
@@ -2,6 +2,11 @@
 
 #include <fstream>
 #include <iostream>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 
 int MNM_IO::build_node_factory(std::string file_folder, MNM_ConfReader *conf_reader, MNM_Node_Factory *node_factory)
@@ -411,6 +416,227 @@ Path_Table *MNM_IO::load_path_table(std::string file_name, PNEGraph graph,
   if (w_ID){
     throw std::runtime_error("Error, MNM_IO::load_path_table, with ID loading not implemented");
   }
+  std::string _bin_file_name = file_name + ".bin";
+  struct stat _bin_stat, _text_stat;
+  // a text file written in the same second as the .bin still counts as newer unless its mtime is earlier
+  auto _not_older = [&_bin_stat](const struct stat &text_stat){
+    return text_stat.st_mtim.tv_sec > _bin_stat.st_mtim.tv_sec 
+           || (text_stat.st_mtim.tv_sec == _bin_stat.st_mtim.tv_sec && text_stat.st_mtim.tv_nsec >= _bin_stat.st_mtim.tv_nsec);
+  };
+  if (stat(_bin_file_name.c_str(), &_bin_stat) == 0){
+    bool _stale = (stat(file_name.c_str(), &_text_stat) == 0) && _not_older(_text_stat);
+    if (w_buffer){
+      _stale = _stale || ((stat((file_name + "_buffer").c_str(), &_text_stat) == 0) && _not_older(_text_stat));
+    }
+    if (_stale){
+      printf("%s is older than the text path table, not used\n", _bin_file_name.c_str());
+    }
+    else{
+      Path_Table *_path_table = load_path_table_binary(_bin_file_name, graph, num_path, w_buffer);
+      if (_path_table != NULL) return _path_table;
+    }
+  }
+  return load_path_table_text(file_name, graph, num_path, w_buffer);
+}
+
+
+Path_Table *MNM_IO::load_path_table_binary(std::string file_name, PNEGraph graph, TInt num_path, bool w_buffer)
+{
+  int _fd = open(file_name.c_str(), O_RDONLY);
+  if (_fd < 0){
+    printf("Can't open path table file %s!\n", file_name.c_str());
+    return NULL;
+  }
+  struct stat _stat;
+  fstat(_fd, &_stat);
+  size_t _size = size_t(_stat.st_size);
+  if (_size < sizeof(MNM_Path_Table_Bin_Header)){
+    printf("%s is not a binary path table\n", file_name.c_str());
+    close(_fd);
+    return NULL;
+  }
+  void *_map = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+  close(_fd);
+  if (_map == MAP_FAILED){
+    printf("Can't map path table file %s!\n", file_name.c_str());
+    return NULL;
+  }
+
+  const MNM_Path_Table_Bin_Header *_header = (const MNM_Path_Table_Bin_Header*) _map;
+  const int _num_path = _header -> m_num_path;
+  const int _num_link = _header -> m_num_link;
+  const int _buffer_length = _header -> m_buffer_length;
+  size_t _offset = sizeof(MNM_Path_Table_Bin_Header) + (size_t(_num_path + 1) + 2 * size_t(_num_link) + _num_path) * sizeof(int32_t);
+  _offset += (8 - _offset % 8) % 8;
+  if (memcmp(_header -> m_magic, MNM_PATH_TABLE_BIN_MAGIC, 8) != 0 || _num_path != num_path
+      || _size != _offset + size_t(_num_path) * _buffer_length * _header -> m_value_size){
+    printf("%s does not hold %d paths, not used\n", file_name.c_str(), num_path());
+    munmap(_map, _size);
+    return NULL;
+  }
+  if (w_buffer && (_header -> m_value_size == 0 || _buffer_length <= 0)){
+    printf("%s has no path buffer, not used\n", file_name.c_str());
+    munmap(_map, _size);
+    return NULL;
+  }
+  const int32_t *_link_offset = (const int32_t*) (_header + 1);
+  const int32_t *_link = _link_offset + _num_path + 1;
+  const int32_t *_node = _link + _num_link;
+  // every stored link has to join its two nodes in graph
+  for (int i = 0; i < _num_path; ++i){
+    if (_link_offset[i] < 0 || _link_offset[i + 1] < _link_offset[i] || _link_offset[i + 1] > _num_link){
+      printf("%s has broken link offsets, not used\n", file_name.c_str());
+      munmap(_map, _size);
+      return NULL;
+    }
+    const int32_t *_path_node = _node + _link_offset[i] + i;
+    for (int k = _link_offset[i]; k < _link_offset[i + 1]; ++k){
+      const int j = k - _link_offset[i];
+      if (!graph -> IsEdge(_link[k]) || graph -> GetEI(_link[k]).GetSrcNId() != _path_node[j] 
+          || graph -> GetEI(_link[k]).GetDstNId() != _path_node[j + 1]){
+        printf("%s does not match the graph at path %d link %d, not used\n", file_name.c_str(), i, _link[k]);
+        munmap(_map, _size);
+        return NULL;
+      }
+    }
+  }
+  printf("Loading Path Table from %s!\n", file_name.c_str());
+
+  Path_Table *_path_table = new Path_Table();
+  std::unordered_map<TInt, MNM_Pathset*> *_new_map;
+  MNM_Pathset *_pathset;
+  MNM_Path *_path;
+  TInt _origin_node_ID, _dest_node_ID;
+  int _num_path_link;
+  for (int i = 0; i < _num_path; ++i){
+    _num_path_link = _link_offset[i + 1] - _link_offset[i];
+    const int32_t *_path_node = _node + _link_offset[i] + i;
+    _origin_node_ID = TInt(_path_node[0]);
+    _dest_node_ID = TInt(_path_node[_num_path_link]);
+    auto _o_it = _path_table -> find(_origin_node_ID);
+    if (_o_it == _path_table -> end()){
+      _new_map = new std::unordered_map<TInt, MNM_Pathset*>();
+      _o_it = _path_table -> insert(std::pair<TInt, std::unordered_map<TInt, MNM_Pathset*>*>(_origin_node_ID, _new_map)).first;
+    }
+    auto _d_it = _o_it -> second -> find(_dest_node_ID);
+    if (_d_it == _o_it -> second -> end()){
+      _pathset = new MNM_Pathset();
+      _d_it = _o_it -> second -> insert(std::pair<TInt, MNM_Pathset*>(_dest_node_ID, _pathset)).first;
+    }
+    _path = new MNM_Path();
+    _path -> m_path_ID = i;
+    _path -> m_link_vec.assign(_link + _link_offset[i], _link + _link_offset[i + 1]);
+    _path -> m_node_vec.assign(_path_node, _path_node + _num_path_link + 1);
+    _d_it -> second -> m_path_vec.push_back(_path);
+  }
+
+  if (w_buffer){
+    _path_table -> compact(_buffer_length);
+    const char *_buffer = (const char*) _map + _offset;
+    TFlt *_row;
+    for (int i = 0; i < _num_path; ++i){
+      const size_t _row_offset = size_t(_path_table -> m_path[i] -> m_path_ID) * _buffer_length;
+      _row = _path_table -> m_buffer.data() + size_t(i) * _buffer_length;
+      if (_header -> m_value_size == 4){
+        for (int j = 0; j < _buffer_length; ++j) _row[j] = TFlt(((const float*) _buffer)[_row_offset + j]);
+      }
+      else{
+        for (int j = 0; j < _buffer_length; ++j) _row[j] = TFlt(((const double*) _buffer)[_row_offset + j]);
+      }
+    }
+  }
+  else{
+    _path_table -> compact();
+  }
+  munmap(_map, _size);
+  printf("Finish Loading Path Table!\n");
+  return _path_table;
+}
+
+
+Path_Table *MNM_IO::build_path_table(PNEGraph graph, int num_path, const int *node_offset, const int *node, int num_node,
+                                     const double *buffer, int buffer_length)
+{
+  // every path has to be a chain of edges of graph within node
+  if (num_path < 0 || (num_path > 0 && node_offset[0] < 0)){
+    throw std::runtime_error("Error, MNM_IO::build_path_table, node offsets out of range");
+  }
+  if (buffer != NULL && buffer_length < 0){
+    throw std::runtime_error("Error, MNM_IO::build_path_table, negative buffer length");
+  }
+  for (int i = 0; i < num_path; ++i){
+    if (node_offset[i + 1] > num_node){
+      throw std::runtime_error("Error, MNM_IO::build_path_table, node offsets out of range");
+    }
+    if (node_offset[i + 1] - node_offset[i] < 2){
+      throw std::runtime_error("Error, MNM_IO::build_path_table, path " + std::to_string(i) + " has less than two nodes");
+    }
+    for (int j = node_offset[i]; j + 1 < node_offset[i + 1]; ++j){
+      if (!graph -> IsNode(node[j]) || !graph -> IsNode(node[j + 1]) || !graph -> IsEdge(node[j], node[j + 1])){
+        throw std::runtime_error("Error, MNM_IO::build_path_table, path " + std::to_string(i) + " has no link from node " 
+                                 + std::to_string(node[j]) + " to node " + std::to_string(node[j + 1]));
+      }
+    }
+  }
+
+  Path_Table *_path_table = new Path_Table();
+  std::unordered_map<TInt, MNM_Pathset*> *_new_map;
+  MNM_Path *_path;
+  TInt _origin_node_ID, _dest_node_ID;
+  for (int i = 0; i < num_path; ++i){
+    _origin_node_ID = TInt(node[node_offset[i]]);
+    _dest_node_ID = TInt(node[node_offset[i + 1] - 1]);
+    auto _o_it = _path_table -> find(_origin_node_ID);
+    if (_o_it == _path_table -> end()){
+      _new_map = new std::unordered_map<TInt, MNM_Pathset*>();
+      _o_it = _path_table -> insert(std::pair<TInt, std::unordered_map<TInt, MNM_Pathset*>*>(_origin_node_ID, _new_map)).first;
+    }
+    auto _d_it = _o_it -> second -> find(_dest_node_ID);
+    if (_d_it == _o_it -> second -> end()){
+      _d_it = _o_it -> second -> insert(std::pair<TInt, MNM_Pathset*>(_dest_node_ID, new MNM_Pathset())).first;
+    }
+    _path = new MNM_Path();
+    _path -> m_path_ID = i;
+    _path -> m_node_vec.assign(node + node_offset[i], node + node_offset[i + 1]);
+    for (size_t j = 0; j + 1 < _path -> m_node_vec.size(); ++j){
+      _path -> m_link_vec.push_back(graph -> GetEI(_path -> m_node_vec[j], _path -> m_node_vec[j + 1]).GetId());
+    }
+    _d_it -> second -> m_path_vec.push_back(_path);
+  }
+  _path_table -> compact(buffer != NULL ? buffer_length : 0);
+  if (buffer != NULL){
+    for (int i = 0; i < num_path; ++i){
+      std::copy(buffer + size_t(_path_table -> m_path[i] -> m_path_ID) * buffer_length, 
+                buffer + size_t(_path_table -> m_path[i] -> m_path_ID + 1) * buffer_length, 
+                _path_table -> m_buffer.begin() + size_t(i) * buffer_length);
+    }
+  }
+  return _path_table;
+}
+
+
+int MNM_IO::convert_path_table(std::string file_name, PNEGraph graph, TInt num_path, bool w_buffer, bool single_precision)
+{
+  Path_Table *_path_table = load_path_table_text(file_name, graph, num_path, w_buffer);
+  // back to the line order
+  std::vector<MNM_Path*> _path_vec = _path_table -> m_path;
+  std::sort(_path_vec.begin(), _path_vec.end(), 
+            [](MNM_Path *a, MNM_Path *b){ return a -> m_path_ID < b -> m_path_ID; });
+  MNM::save_path_table_binary(file_name + ".bin", _path_vec, w_buffer ? (single_precision ? 4 : 8) : 0);
+  for (auto _it : *_path_table){
+    for (auto _it_it : *(_it.second)){
+      delete _it_it.second;
+    }
+    delete _it.second;
+  }
+  delete _path_table;
+  return 0;
+}
+
+
+Path_Table *MNM_IO::load_path_table_text(std::string file_name, PNEGraph graph, 
+                  TInt num_path, bool w_buffer)
+{
   printf("Loading Path Table!\n");
   TInt Num_Path = num_path;
   printf("Number of path %d\n", Num_Path());
@@ -489,6 +715,7 @@ Path_Table *MNM_IO::load_path_table(std::string file_name, PNEGraph graph,
     printf("Can't open path table file!\n");
     exit(-1);
   }
+  _path_table -> compact();
   printf("Finish Loading Path Table!\n");
   // printf("path table %p\n", _path_table);
   // printf("path table %s\n", _path_table -> find(100283) -> second -> find(150153) -> second 
@@ -690,6 +917,468 @@ int MNM_IO::dump_cumulative_curve(std::string file_folder, MNM_Link_Factory *lin
   return 0;
 }
 
+/**************************************************************************
+                        Binary network bundle
+**************************************************************************/
+static const char *MNM_BUNDLE_TYPE_NAME[] = {"FWJ", "GRJ", "DMOND", "DMDND", "PQ", "CTM", "LQ", "LTM"};
+static const int MNM_BUNDLE_NUM_TYPE = 8;
+
+static size_t align_bundle_offset(size_t offset)
+{
+  return offset + (8 - offset % 8) % 8;
+}
+
+MNM_Network_Bundle::MNM_Network_Bundle()
+{
+  memset(&m_memory_header, 0, sizeof(MNM_Network_Bundle_Header));
+  m_header = NULL;
+  m_num_path = 0;
+  m_num_path_node = 0;
+  m_path_buffer_length = 0;
+  m_path_node_offset = NULL;
+  m_path_node = NULL;
+  m_path_buffer = NULL;
+  m_num_emission_link = 0;
+  m_emission_link_ID = NULL;
+  m_map = NULL;
+  m_size = 0;
+}
+
+MNM_Network_Bundle::~MNM_Network_Bundle()
+{
+  if (m_map != NULL) munmap(m_map, m_size);
+}
+
+std::string MNM_Network_Bundle::get_type(int32_t code)
+{
+  if (code < 0 || code >= MNM_BUNDLE_NUM_TYPE){
+    printf("MNM_Network_Bundle::get_type, wrong type code %d\n", code);
+    exit(-1);
+  }
+  return std::string(MNM_BUNDLE_TYPE_NAME[code]);
+}
+
+int32_t MNM_Network_Bundle::get_type_code(const std::string &type)
+{
+  for (int i = 0; i < MNM_BUNDLE_NUM_TYPE; ++i){
+    if (type == MNM_BUNDLE_TYPE_NAME[i]) return i;
+  }
+  printf("MNM_Network_Bundle::get_type_code, unknown type %s\n", type.c_str());
+  exit(-1);
+}
+
+MNM_Network_Bundle *MNM_Network_Bundle::map_file(std::string file_name)
+{
+  int _fd = open(file_name.c_str(), O_RDONLY);
+  if (_fd < 0) return NULL;
+  struct stat _stat;
+  fstat(_fd, &_stat);
+  size_t _size = size_t(_stat.st_size);
+  if (_size < sizeof(MNM_Network_Bundle_Header)){
+    close(_fd);
+    return NULL;
+  }
+  void *_map = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+  close(_fd);
+  if (_map == MAP_FAILED) return NULL;
+
+  MNM_Network_Bundle *_bundle = new MNM_Network_Bundle();
+  _bundle -> m_map = _map;
+  _bundle -> m_size = _size;
+  const MNM_Network_Bundle_Header *_header = (const MNM_Network_Bundle_Header*) _map;
+  _bundle -> m_header = _header;
+  if (memcmp(_header -> m_magic, MNM_NETWORK_BUNDLE_MAGIC, 8) != 0){
+    delete _bundle;
+    return NULL;
+  }
+  if (_header -> m_num_node < 0 || _header -> m_num_link < 0 || _header -> m_num_origin < 0 || _header -> m_num_dest < 0 
+      || _header -> m_num_edge < 0 || _header -> m_num_OD < 0 || _header -> m_node_width < 0 
+      || _header -> m_link_width < 0 || _header -> m_demand_width < 0){
+    printf("%s has negative counts\n", file_name.c_str());
+    delete _bundle;
+    return NULL;
+  }
+  // the sections are laid out from the header counts, they have to end exactly at the end of the file
+  size_t _offset = sizeof(MNM_Network_Bundle_Header);
+  bool _fit = true;
+  auto _advance = [&_offset, &_fit, _size](size_t num, size_t width){
+    if (!_fit || _offset > _size || num > (_size - _offset) / width){
+      _fit = false;
+      return;
+    }
+    _offset += num * width;
+  };
+  const size_t _node_offset = _offset;
+  _advance(2 * size_t(_header -> m_num_node), sizeof(int32_t));
+  _offset = align_bundle_offset(_offset);
+  const size_t _node_value_offset = _offset;
+  _advance(size_t(_header -> m_num_node) * size_t(_header -> m_node_width), sizeof(double));
+  const size_t _link_offset = _offset;
+  _advance(2 * size_t(_header -> m_num_link), sizeof(int32_t));
+  _offset = align_bundle_offset(_offset);
+  const size_t _link_value_offset = _offset;
+  _advance(size_t(_header -> m_num_link) * size_t(_header -> m_link_width), sizeof(double));
+  const size_t _od_offset = _offset;
+  _advance(2 * size_t(_header -> m_num_origin) + 2 * size_t(_header -> m_num_dest) + 3 * size_t(_header -> m_num_edge), 
+           sizeof(int32_t));
+  const size_t _demand_offset = _offset;
+  _advance(2 * size_t(_header -> m_num_OD), sizeof(int32_t));
+  _offset = align_bundle_offset(_offset);
+  const size_t _demand_value_offset = _offset;
+  _advance(size_t(_header -> m_num_OD) * size_t(_header -> m_demand_width), sizeof(double));
+  if (!_fit || _offset != _size){
+    printf("%s is truncated\n", file_name.c_str());
+    delete _bundle;
+    return NULL;
+  }
+
+  const char *_base = (const char*) _map;
+  _bundle -> m_node_ID = (const int32_t*) (_base + _node_offset);
+  _bundle -> m_node_type = _bundle -> m_node_ID + _header -> m_num_node;
+  _bundle -> m_node_value = (const double*) (_base + _node_value_offset);
+
+  _bundle -> m_link_ID = (const int32_t*) (_base + _link_offset);
+  _bundle -> m_link_type = _bundle -> m_link_ID + _header -> m_num_link;
+  _bundle -> m_link_value = (const double*) (_base + _link_value_offset);
+
+  _bundle -> m_origin_ID = (const int32_t*) (_base + _od_offset);
+  _bundle -> m_origin_node_ID = _bundle -> m_origin_ID + _header -> m_num_origin;
+  _bundle -> m_dest_ID = _bundle -> m_origin_node_ID + _header -> m_num_origin;
+  _bundle -> m_dest_node_ID = _bundle -> m_dest_ID + _header -> m_num_dest;
+  _bundle -> m_edge_link_ID = _bundle -> m_dest_node_ID + _header -> m_num_dest;
+  _bundle -> m_edge_from_ID = _bundle -> m_edge_link_ID + _header -> m_num_edge;
+  _bundle -> m_edge_to_ID = _bundle -> m_edge_from_ID + _header -> m_num_edge;
+
+  _bundle -> m_demand_O_ID = (const int32_t*) (_base + _demand_offset);
+  _bundle -> m_demand_D_ID = _bundle -> m_demand_O_ID + _header -> m_num_OD;
+  _bundle -> m_demand_value = (const double*) (_base + _demand_value_offset);
+  return _bundle;
+}
+
+MNM_Network_Bundle *MNM_IO::load_network_bundle(std::string file_folder, MNM_ConfReader *conf_reader)
+{
+  std::string _bundle_file_name = file_folder + "/" + MNM_NETWORK_BUNDLE_FILE;
+  struct stat _bundle_stat, _text_stat;
+  if (stat(_bundle_file_name.c_str(), &_bundle_stat) != 0) return NULL;
+  // as for the binary path table, a text file with the same mtime as the bundle counts as newer
+  auto _not_older = [&_bundle_stat](const struct stat &text_stat){
+    return text_stat.st_mtim.tv_sec > _bundle_stat.st_mtim.tv_sec 
+           || (text_stat.st_mtim.tv_sec == _bundle_stat.st_mtim.tv_sec && text_stat.st_mtim.tv_nsec >= _bundle_stat.st_mtim.tv_nsec);
+  };
+  std::vector<std::string> _text_file_name = {"MNM_input_node", "MNM_input_link", "MNM_input_od", 
+                                              conf_reader -> get_string("network_name"), "MNM_input_demand"};
+  for (std::string _name : _text_file_name){
+    if ((stat((file_folder + "/" + _name).c_str(), &_text_stat) == 0) && _not_older(_text_stat)){
+      printf("%s is older than %s, not used\n", _bundle_file_name.c_str(), _name.c_str());
+      return NULL;
+    }
+  }
+  MNM_Network_Bundle *_bundle = MNM_Network_Bundle::map_file(_bundle_file_name);
+  if (_bundle == NULL){
+    printf("%s is not a network bundle, not used\n", _bundle_file_name.c_str());
+    return NULL;
+  }
+  if ((_bundle -> m_header -> m_num_node != conf_reader -> get_int("num_of_node"))
+      || (_bundle -> m_header -> m_num_link != conf_reader -> get_int("num_of_link"))
+      || (_bundle -> m_header -> m_num_OD != conf_reader -> get_int("OD_pair"))){
+    printf("%s does not match the config, not used\n", _bundle_file_name.c_str());
+    delete _bundle;
+    return NULL;
+  }
+  printf("Loading network bundle %s\n", _bundle_file_name.c_str());
+  return _bundle;
+}
+
+// the same lines as the text builders read, the values after the ID (and type) columns are kept as they are
+int MNM_IO::save_network_bundle(std::string file_folder, MNM_ConfReader *conf_reader)
+{
+  TInt _num_of_node = conf_reader -> get_int("num_of_node");
+  TInt _num_of_link = conf_reader -> get_int("num_of_link");
+  TInt _num_of_O = conf_reader -> get_int("num_of_O");
+  TInt _num_of_D = conf_reader -> get_int("num_of_D");
+  TInt _num_OD = conf_reader -> get_int("OD_pair");
+
+  MNM_Network_Bundle_Header _header;
+  memset(&_header, 0x0, sizeof(_header));
+  memcpy(_header.m_magic, MNM_NETWORK_BUNDLE_MAGIC, 8);
+  _header.m_node_width = -1;
+  _header.m_link_width = -1;
+  _header.m_demand_width = -1;
+  std::vector<int32_t> _node_ID, _node_type, _link_ID, _link_type, _origin_ID, _origin_node_ID, _dest_ID, _dest_node_ID;
+  std::vector<int32_t> _edge_link_ID, _edge_from_ID, _edge_to_ID, _demand_O_ID, _demand_D_ID;
+  std::vector<double> _node_value, _link_value, _demand_value;
+
+  std::string _line;
+  std::vector<std::string> _words;
+  // ID, type or second ID and the values, the empty words of repeated spaces are dropped
+  auto _read_record = [&](std::ifstream &file, int num_key, std::vector<int32_t> &key_1, std::vector<int32_t> &key_2, 
+                          bool type_key, std::vector<double> &value, int32_t &width, const char *name){
+    std::getline(file, _line);
+    _words.clear();
+    for (std::string _s : split(_line, ' ')){
+      if (!trim(_s).empty()) _words.push_back(_s);
+    }
+    if (int(_words.size()) < num_key){
+      printf("MNM_IO::save_network_bundle, wrong line in %s: %s\n", name, _line.c_str());
+      exit(-1);
+    }
+    key_1.push_back(int32_t(std::stoi(_words[0])));
+    key_2.push_back(type_key ? MNM_Network_Bundle::get_type_code(_words[1]) : int32_t(std::stoi(_words[1])));
+    if (width < 0) width = int32_t(_words.size()) - num_key;
+    if (int(_words.size()) - num_key != width){
+      printf("MNM_IO::save_network_bundle, %s has lines of %d and %d values\n", name, width, int(_words.size()) - num_key);
+      exit(-1);
+    }
+    for (size_t j = num_key; j < _words.size(); ++j){
+      value.push_back(std::stod(_words[j]));
+    }
+  };
+
+  std::ifstream _file;
+  _file.open(file_folder + "/MNM_input_node", std::ios::in);
+  if (!_file.is_open()){
+    printf("MNM_IO::save_network_bundle, can not open MNM_input_node\n");
+    exit(-1);
+  }
+  std::getline(_file, _line); //skip the first line
+  for (int i = 0; i < _num_of_node; ++i){
+    _read_record(_file, 2, _node_ID, _node_type, true, _node_value, _header.m_node_width, "MNM_input_node");
+  }
+  _file.close();
+
+  _file.open(file_folder + "/MNM_input_link", std::ios::in);
+  if (!_file.is_open()){
+    printf("MNM_IO::save_network_bundle, can not open MNM_input_link\n");
+    exit(-1);
+  }
+  std::getline(_file, _line); //skip the first line
+  for (int i = 0; i < _num_of_link; ++i){
+    _read_record(_file, 2, _link_ID, _link_type, true, _link_value, _header.m_link_width, "MNM_input_link");
+  }
+  _file.close();
+
+  // lines of other lengths are skipped as in build_od_factory and build_graph
+  _file.open(file_folder + "/MNM_input_od", std::ios::in);
+  if (_file.is_open()){
+    std::getline(_file, _line); //skip the first line
+    for (int i = 0; i < _num_of_O; ++i){
+      std::getline(_file, _line);
+      _words = split(_line, ' ');
+      if (_words.size() == 2){
+        _origin_ID.push_back(int32_t(std::stoi(_words[0])));
+        _origin_node_ID.push_back(int32_t(std::stoi(_words[1])));
+      }
+    }
+    std::getline(_file, _line); // skip another line
+    for (int i = 0; i < _num_of_D; ++i){
+      std::getline(_file, _line);
+      _words = split(_line, ' ');
+      if (_words.size() == 2){
+        _dest_ID.push_back(int32_t(std::stoi(_words[0])));
+        _dest_node_ID.push_back(int32_t(std::stoi(_words[1])));
+      }
+    }
+    _file.close();
+  }
+
+  _file.open(file_folder + "/" + conf_reader -> get_string("network_name"), std::ios::in);
+  if (_file.is_open()){
+    std::getline(_file, _line); // skip one line
+    for (int i = 0; i < _num_of_link; ++i){
+      std::getline(_file, _line);
+      _words = split(_line, ' ');
+      if (_words.size() == 3){
+        _edge_link_ID.push_back(int32_t(std::stoi(_words[0])));
+        _edge_from_ID.push_back(int32_t(std::stoi(_words[1])));
+        _edge_to_ID.push_back(int32_t(std::stoi(_words[2])));
+      }
+    }
+    _file.close();
+  }
+
+  _file.open(file_folder + "/MNM_input_demand", std::ios::in);
+  if (!_file.is_open()){
+    printf("MNM_IO::save_network_bundle, can not open MNM_input_demand\n");
+    exit(-1);
+  }
+  std::getline(_file, _line); //skip the first line
+  for (int i = 0; i < _num_OD; ++i){
+    _read_record(_file, 2, _demand_O_ID, _demand_D_ID, false, _demand_value, _header.m_demand_width, "MNM_input_demand");
+  }
+  _file.close();
+
+  _header.m_num_node = int32_t(_node_ID.size());
+  _header.m_num_link = int32_t(_link_ID.size());
+  _header.m_num_origin = int32_t(_origin_ID.size());
+  _header.m_num_dest = int32_t(_dest_ID.size());
+  _header.m_num_edge = int32_t(_edge_link_ID.size());
+  _header.m_num_OD = int32_t(_demand_O_ID.size());
+  _header.m_node_width = std::max(_header.m_node_width, 0);
+  _header.m_link_width = std::max(_header.m_link_width, 0);
+  _header.m_demand_width = std::max(_header.m_demand_width, 0);
+
+  std::string _bundle_file_name = file_folder + "/" + MNM_NETWORK_BUNDLE_FILE;
+  std::ofstream _bundle_file;
+  _bundle_file.open(_bundle_file_name, std::ofstream::out | std::ofstream::binary);
+  if (!_bundle_file.is_open()){
+    printf("MNM_IO::save_network_bundle, can not open %s\n", _bundle_file_name.c_str());
+    exit(-1);
+  }
+  size_t _offset = 0;
+  const char _pad[8] = {0};
+  auto _write_int = [&](std::vector<int32_t> &column){
+    _bundle_file.write((const char*) column.data(), column.size() * sizeof(int32_t));
+    _offset += column.size() * sizeof(int32_t);
+  };
+  auto _write_float = [&](std::vector<double> &column){
+    _bundle_file.write(_pad, align_bundle_offset(_offset) - _offset);
+    _offset = align_bundle_offset(_offset);
+    _bundle_file.write((const char*) column.data(), column.size() * sizeof(double));
+    _offset += column.size() * sizeof(double);
+  };
+  _bundle_file.write((const char*) &_header, sizeof(_header));
+  _offset += sizeof(_header);
+  _write_int(_node_ID);
+  _write_int(_node_type);
+  _write_float(_node_value);
+  _write_int(_link_ID);
+  _write_int(_link_type);
+  _write_float(_link_value);
+  _write_int(_origin_ID);
+  _write_int(_origin_node_ID);
+  _write_int(_dest_ID);
+  _write_int(_dest_node_ID);
+  _write_int(_edge_link_ID);
+  _write_int(_edge_from_ID);
+  _write_int(_edge_to_ID);
+  _write_int(_demand_O_ID);
+  _write_int(_demand_D_ID);
+  _write_float(_demand_value);
+  _bundle_file.close();
+  return 0;
+}
+
+int MNM_IO::build_node_factory(MNM_Network_Bundle *bundle, MNM_ConfReader *conf_reader, MNM_Node_Factory *node_factory)
+{
+  TFlt _flow_scalar = conf_reader -> get_float("flow_scalar");
+  std::string _type;
+  for (int i = 0; i < bundle -> m_header -> m_num_node; ++i){
+    _type = bundle -> get_type(bundle -> m_node_type[i]);
+    if (_type == "FWJ"){
+      node_factory -> make_node(TInt(bundle -> m_node_ID[i]), MNM_TYPE_FWJ, _flow_scalar);
+      continue;
+    }
+    if (_type == "GRJ"){
+      node_factory -> make_node(TInt(bundle -> m_node_ID[i]), MNM_TYPE_GRJ, _flow_scalar);
+      continue;
+    }
+    if (_type == "DMOND"){
+      node_factory -> make_node(TInt(bundle -> m_node_ID[i]), MNM_TYPE_ORIGIN, _flow_scalar);
+      continue;
+    }
+    if (_type == "DMDND"){
+      node_factory -> make_node(TInt(bundle -> m_node_ID[i]), MNM_TYPE_DEST, _flow_scalar);
+      continue;
+    }
+    printf("Wrong node type, %s\n", _type.c_str());
+    exit(-1);
+  }
+  return 0;
+}
+
+int MNM_IO::build_link_factory(MNM_Network_Bundle *bundle, MNM_ConfReader *conf_reader, MNM_Link_Factory *link_factory)
+{
+  TFlt _flow_scalar = conf_reader -> get_float("flow_scalar");
+  TFlt _unit_time = conf_reader -> get_float("unit_time");
+  const int _width = bundle -> m_header -> m_link_width;
+  if (_width < 5){
+    printf("MNM_IO::build_link_factory::Wrong length of line.\n");
+    exit(-1);
+  }
+  std::string _type;
+  const double *_value;
+  DLink_type _link_type;
+  for (int i = 0; i < bundle -> m_header -> m_num_link; ++i){
+    _type = bundle -> get_type(bundle -> m_link_type[i]);
+    if (_type == "PQ") _link_type = MNM_TYPE_PQ;
+    else if (_type == "CTM") _link_type = MNM_TYPE_CTM;
+    else if (_type == "LQ") _link_type = MNM_TYPE_LQ;
+    else if (_type == "LTM") _link_type = MNM_TYPE_LTM;
+    else {
+      printf("Wrong link type, %s\n", _type.c_str());
+      exit(-1);
+    }
+    _value = bundle -> m_link_value + size_t(i) * _width;
+    /* unit conversion as in the text builder */
+    link_factory -> make_link(TInt(bundle -> m_link_ID[i]), _link_type, 
+                              TFlt(_value[3]) / TFlt(1600), TFlt(_value[2]) / TFlt(3600), TInt(int(_value[4])),
+                              TFlt(_value[0]) * TFlt(1600), TFlt(_value[1]) * TFlt(1600) / TFlt(3600), 
+                              _unit_time, _flow_scalar);
+  }
+  return 0;
+}
+
+int MNM_IO::build_od_factory(MNM_Network_Bundle *bundle, MNM_ConfReader *conf_reader, 
+                             MNM_OD_Factory *od_factory, MNM_Node_Factory *node_factory)
+{
+  TFlt _flow_scalar = conf_reader -> get_float("flow_scalar");
+  TInt _max_interval = conf_reader -> get_int("max_interval");
+  TInt _frequency = conf_reader -> get_int("assign_frq");
+  MNM_Origin *_origin;
+  MNM_Destination *_dest;
+  TInt _node_ID;
+  for (int i = 0; i < bundle -> m_header -> m_num_origin; ++i){
+    _node_ID = TInt(bundle -> m_origin_node_ID[i]);
+    _origin = od_factory -> make_origin(TInt(bundle -> m_origin_ID[i]), _max_interval, _flow_scalar, _frequency);
+    _origin -> m_origin_node = (MNM_DMOND*) node_factory -> get_node(_node_ID);
+    ((MNM_DMOND*) node_factory -> get_node(_node_ID)) -> hook_up_origin(_origin);
+  }
+  for (int i = 0; i < bundle -> m_header -> m_num_dest; ++i){
+    _node_ID = TInt(bundle -> m_dest_node_ID[i]);
+    _dest = od_factory -> make_destination(TInt(bundle -> m_dest_ID[i]));
+    _dest -> m_dest_node = (MNM_DMDND*) node_factory -> get_node(_node_ID);
+    ((MNM_DMDND*) node_factory -> get_node(_node_ID)) -> hook_up_destination(_dest);
+  }
+  return 0;
+}
+
+PNEGraph MNM_IO::build_graph(MNM_Network_Bundle *bundle)
+{
+  PNEGraph _graph = PNEGraph::TObj::New();
+  int _from_ID, _to_ID;
+  for (int i = 0; i < bundle -> m_header -> m_num_edge; ++i){
+    _from_ID = bundle -> m_edge_from_ID[i];
+    _to_ID = bundle -> m_edge_to_ID[i];
+    if (! _graph -> IsNode(_from_ID)) { _graph -> AddNode(_from_ID); }
+    if (! _graph -> IsNode(_to_ID)) { _graph -> AddNode(_to_ID); }
+    _graph -> AddEdge(_from_ID, _to_ID, bundle -> m_edge_link_ID[i]);
+  }
+  _graph -> Defrag();
+  return _graph;
+}
+
+int MNM_IO::build_demand(MNM_Network_Bundle *bundle, MNM_ConfReader *conf_reader, MNM_OD_Factory *od_factory)
+{
+  TInt _max_interval = conf_reader -> get_int("max_interval");
+  const int _width = bundle -> m_header -> m_demand_width;
+  if (_width < _max_interval){
+    printf("Something wrong in build_demand!\n");
+    exit(-1);
+  }
+  std::vector<TFlt> _demand_vector = std::vector<TFlt>(_max_interval);
+  MNM_Origin *_origin;
+  MNM_Destination *_dest;
+  for (int i = 0; i < bundle -> m_header -> m_num_OD; ++i){
+    for (int j = 0; j < _max_interval; ++j){
+      _demand_vector[j] = TFlt(bundle -> m_demand_value[size_t(i) * _width + j]);
+    }
+    _origin = od_factory -> get_origin(TInt(bundle -> m_demand_O_ID[i]));
+    _dest = od_factory -> get_destination(TInt(bundle -> m_demand_D_ID[i]));
+    _origin -> add_dest_demand(_dest, _demand_vector.data());
+  }
+  return 0;
+}
+
 std::vector<std::string> MNM_IO::split(const std::string &text, char sep) 
 {
   std::vector<std::string> tokens;
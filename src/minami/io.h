@@ -11,9 +11,85 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 
 class MNM_Node_Factory;
 
+/**************************************************************************
+                        Binary network bundle
+**************************************************************************/
+// MNM_network_bundle.bin holds the columns of MNM_input_node, MNM_input_link, MNM_input_od, the graph
+// file and MNM_input_demand as they are in the text files, before any unit conversion, so one
+// bundle serves the single class and the multiclass builders and the config still applies.
+// each section is its int32 columns, zero padding to 8 bytes and its float64 columns, row major
+// with the width of the header, in native byte order. types are indices in MNM_BUNDLE_TYPE_NAME
+#define MNM_NETWORK_BUNDLE_MAGIC "MNMNET01"
+#define MNM_NETWORK_BUNDLE_FILE "MNM_network_bundle.bin"
+
+struct MNM_Network_Bundle_Header
+{
+  char m_magic[8];
+  // node: ID, type | the values after the type
+  int32_t m_num_node;
+  int32_t m_node_width;
+  // link: ID, type | length, ffs, capacities, lanes, ... as in the file
+  int32_t m_num_link;
+  int32_t m_link_width;
+  // origin: ID, node ID; destination: ID, node ID
+  int32_t m_num_origin;
+  int32_t m_num_dest;
+  // edge: link ID, from node ID, to node ID
+  int32_t m_num_edge;
+  // demand: origin ID, destination ID | the values of all intervals (and classes)
+  int32_t m_num_OD;
+  int32_t m_demand_width;
+  int32_t m_reserved;
+};
+
+class MNM_Network_Bundle
+{
+public:
+  MNM_Network_Bundle();
+  ~MNM_Network_Bundle();
+  // NULL if the file is not a network bundle
+  static MNM_Network_Bundle *map_file(std::string file_name);
+  // type name of a node / link record and back
+  std::string get_type(int32_t code);
+  static int32_t get_type_code(const std::string &type);
+  // a bundle filled in memory points m_header here and its columns to arrays of the caller
+  MNM_Network_Bundle_Header m_memory_header;
+  const MNM_Network_Bundle_Header *m_header;
+  const int32_t *m_node_ID;
+  const int32_t *m_node_type;
+  const double *m_node_value;
+  const int32_t *m_link_ID;
+  const int32_t *m_link_type;
+  const double *m_link_value;
+  const int32_t *m_origin_ID;
+  const int32_t *m_origin_node_ID;
+  const int32_t *m_dest_ID;
+  const int32_t *m_dest_node_ID;
+  const int32_t *m_edge_link_ID;
+  const int32_t *m_edge_from_ID;
+  const int32_t *m_edge_to_ID;
+  const int32_t *m_demand_O_ID;
+  const int32_t *m_demand_D_ID;
+  const double *m_demand_value;
+  // only in memory: path i has the nodes m_path_node[m_path_node_offset[i] .. m_path_node_offset[i+1]),
+  // m_path_buffer is m_num_path x m_path_buffer_length or NULL
+  int32_t m_num_path;
+  int32_t m_num_path_node;
+  int32_t m_path_buffer_length;
+  const int32_t *m_path_node_offset;
+  const int32_t *m_path_node;
+  const double *m_path_buffer;
+  // only in memory: IDs of the links whose emissions are recorded
+  int32_t m_num_emission_link;
+  const int32_t *m_emission_link_ID;
+  void *m_map;
+  size_t m_size;
+};
+
 class MNM_IO
 {
 public:
@@ -24,7 +100,18 @@ public:
   static int  hook_up_od_node(std::string file_folder, MNM_ConfReader *conf_reader, MNM_OD_Factory *od_factory, MNM_Node_Factory *node_factory);  
   static PNEGraph build_graph(std::string file_folder, MNM_ConfReader *conf_reader);
   static int build_demand(std::string file_folder, MNM_ConfReader *conf_reader, MNM_OD_Factory *od_factory);
+  // uses file_name.bin instead of the text files when it holds num_path paths and is not older than them
   static Path_Table *load_path_table(std::string file_name, PNEGraph graph, TInt num_path, bool w_buffer = false, bool w_ID = false);
+  static Path_Table *load_path_table_text(std::string file_name, PNEGraph graph, TInt num_path, bool w_buffer = false);
+  // NULL if the file is not a binary path table of num_path paths on graph, or has no buffer when w_buffer
+  static Path_Table *load_path_table_binary(std::string file_name, PNEGraph graph, TInt num_path, bool w_buffer = false);
+  // path i has the nodes node[node_offset[i] .. node_offset[i+1]) of the num_node ones and ID i, 
+  // buffer is num_path x buffer_length or NULL, throws if a path is not in graph
+  static Path_Table *build_path_table(PNEGraph graph, int num_path, const int *node_offset, const int *node, int num_node,
+                                      const double *buffer = NULL, int buffer_length = 0);
+  // writes file_name.bin from the text path table and its buffer
+  static int convert_path_table(std::string file_name, PNEGraph graph, TInt num_path, bool w_buffer = false, 
+                                bool single_precision = false);
   static int build_vms_facotory(std::string file_folder, PNEGraph graph, TInt num_vms, MNM_Vms_Factory *vms_factory);
   static int read_int_float(std::string file_name, std::unordered_map<TInt, TFlt>* reader);
   static int read_int(std::string file_name, std::vector<TInt>* reader);
@@ -32,6 +119,17 @@ public:
   static int build_workzone_list(std::string file_folder, MNM_Workzone* workzone);
   static int dump_cumulative_curve(std::string file_folder, MNM_Link_Factory *link_factory);
 
+  // the bundle of file_folder when it matches the counts of the config and is newer than the
+  // text files, NULL otherwise
+  static MNM_Network_Bundle *load_network_bundle(std::string file_folder, MNM_ConfReader *conf_reader);
+  // converts the MNM_input_* text files of file_folder into the bundle
+  static int save_network_bundle(std::string file_folder, MNM_ConfReader *conf_reader);
+  static int build_node_factory(MNM_Network_Bundle *bundle, MNM_ConfReader *conf_reader, MNM_Node_Factory *node_factory);
+  static int build_link_factory(MNM_Network_Bundle *bundle, MNM_ConfReader *conf_reader, MNM_Link_Factory *link_factory);
+  static int build_od_factory(MNM_Network_Bundle *bundle, MNM_ConfReader *conf_reader, MNM_OD_Factory *od_factory, MNM_Node_Factory *node_factory);
+  static PNEGraph build_graph(MNM_Network_Bundle *bundle);
+  static int build_demand(MNM_Network_Bundle *bundle, MNM_ConfReader *conf_reader, MNM_OD_Factory *od_factory);
+
 //private:
   static std::vector<std::string> split(const std::string &text, char sep);
   static  std::string inline &ltrim(std::string &s) {s.erase(s.begin(), std::find_if(s.begin(), s.end(), std::not1(std::ptr_fun<int, int>(std::isspace))));
@@ -2,131 +2,213 @@
 
 #include <functional>
 #include <queue>
+#include <limits>
 
-// double get_cost_from_cost(MNM_Cost c){return c.m_cost();}
-
-// double get_cost_from_three_heap(KSP_Heap th){return th.m_top_cost.m_cost();}
-
-KSP_Heap::KSP_Heap()
-{
-  m_top_cost = NULL;
-}
-
-KSP_Heap::~KSP_Heap()
+MNM_KSP_Tree::MNM_KSP_Tree(TInt dest_node_ID, PNEGraph graph)
+  : MNM_KSP_Tree(dest_node_ID, new MNM_Graph_CSR(graph))
 {
+  m_own_csr = true;
 }
 
-MNM_KSP_Tree::MNM_KSP_Tree(TInt dest_node_ID, PNEGraph graph)
+MNM_KSP_Tree::MNM_KSP_Tree(TInt dest_node_ID, MNM_Graph_CSR *csr)
 {
   m_dest_node_ID = dest_node_ID;
-  m_graph = graph;
-  m_dist_to_dest_map = std::unordered_map<TInt, TFlt>();
-  m_sp_tree_map = std::unordered_map<TInt, TInt>();
-  m_link_ID_heap_map = std::unordered_map<TInt, heap<MNM_Cost*>::node*>();
-  m_node_ID_ksp_heap_map = std::unordered_map<TInt, heap<KSP_Heap*>::node*>();
+  m_csr = csr;
+  m_own_csr = false;
+  m_dest_index = m_csr -> get_node_index(dest_node_ID);
+  m_cost = std::vector<double>();
+  m_dist = std::vector<double>();
+  m_pred = std::vector<int>();
+  m_heap_root = std::vector<int>();
+  m_heap_key = std::vector<double>();
+  m_heap_link = std::vector<int>();
+  m_heap_left = std::vector<int>();
+  m_heap_right = std::vector<int>();
+  m_heap_rank = std::vector<int>();
 }
 
 MNM_KSP_Tree::~MNM_KSP_Tree()
 {
-  m_dist_to_dest_map.clear();
-  m_sp_tree_map.clear();
+  if (m_own_csr) delete m_csr;
 }
 
 int MNM_KSP_Tree::initialize()
 {
+  m_cost.resize(m_csr -> m_num_link);
+  m_dist.resize(m_csr -> m_num_node);
+  m_pred.resize(m_csr -> m_num_node);
+  m_heap_root.resize(m_csr -> m_num_node);
   return 0;
 }
 
 int MNM_KSP_Tree::update_tree(std::unordered_map<TInt, TFlt>& cost_map)
 {
-  MNM_Shortest_Path::all_to_one_Dijkstra(m_dest_node_ID, m_graph, m_dist_to_dest_map, cost_map, m_sp_tree_map);
-  update_DG(cost_map);
-
-  return 0;
+  m_csr -> build_cost_array(cost_map, m_cost.data());
+  return update_tree(m_cost.data());
 }
 
-int MNM_KSP_Tree::get_ksp(TInt src_node_ID, TInt k, MNM_Pathset* path_set)
+int MNM_KSP_Tree::update_tree(const double *cost)
 {
-  // std::deque<TInt> _Q = std::deque<TInt>();
-  std::priority_queue<MNM_Path*, std::vector<MNM_Path*>, LessByPathP> _Q \
-  = std::priority_queue<MNM_Path*, std::vector<MNM_Path*>, LessByPathP>();
-  // _Q.push(m_DG.minimal() -> m_top_cost -> m_ID);
+  if (cost != m_cost.data()){
+    std::copy(cost, cost + m_csr -> m_num_link, m_cost.begin());
+  }
+  MNM_Shortest_Path::all_to_one_Dijkstra(m_dest_index, m_csr, m_cost.data(), m_dist.data(), m_pred.data());
+  update_DG();
   return 0;
 }
 
-int MNM_KSP_Tree::update_DG(std::unordered_map<TInt, TFlt>& cost_map)
+double MNM_KSP_Tree::delta(int link_index)
 {
-  // construct D(G)
-  KSP_Heap *_temp_ksp_heap;
-  TInt _temp_node_ID, _temp_link_ID;
-  MNM_Cost *_temp_cost;
-  heap<MNM_Cost*>::node *_temp_node;
-  heap<KSP_Heap*>::node *_temp_ksp_node;
-  for (auto _map_it = m_sp_tree_map.begin(); _map_it != m_sp_tree_map.end(); ++_map_it){
-    _temp_ksp_heap = new KSP_Heap();
-    _temp_node_ID = _map_it -> first;
-    TNEGraph::TNodeI _node_it = m_graph -> GetNI(_temp_node_ID);
-    for (int e = 0; e < m_graph -> GetNI(_temp_node_ID).GetOutDeg(); ++e) {
-      _temp_link_ID = _node_it.GetOutEId(e);
-      if (_temp_link_ID != _map_it -> second){
-        _temp_cost = new MNM_Cost(_temp_link_ID, delta(_temp_link_ID, cost_map));
-        _temp_node = _temp_ksp_heap -> m_binary_heap_cost.insert(_temp_cost);
-        m_link_ID_heap_map.insert({_temp_link_ID, _temp_node});
-      }
-    }
-    _temp_ksp_heap -> m_top_cost = _temp_ksp_heap -> m_binary_heap_cost.minimal();
+  double _delta = m_cost[link_index] + m_dist[m_csr -> m_link_to[link_index]]
+                  - m_dist[m_csr -> m_link_from[link_index]];
+  // round off of the tree distances
+  return _delta > 0 ? _delta : 0.0;
+}
 
-    
-    // _temp_ksp_node = m_DG.insert(_temp_ksp_heap);
-    // m_node_ID_ksp_heap_map.insert({_temp_node_ID,_temp_ksp_node});
+int MNM_KSP_Tree::new_heap_node(double key, int link_index, int left, int right)
+{
+  int _left_rank = left < 0 ? 0 : m_heap_rank[left];
+  int _right_rank = right < 0 ? 0 : m_heap_rank[right];
+  if (_left_rank < _right_rank){
+    std::swap(left, right);
+    std::swap(_left_rank, _right_rank);
   }
-  
-  return 0;
+  m_heap_key.push_back(key);
+  m_heap_link.push_back(link_index);
+  m_heap_left.push_back(left);
+  m_heap_right.push_back(right);
+  m_heap_rank.push_back(_right_rank + 1);
+  return int(m_heap_key.size()) - 1;
 }
 
-
-TFlt MNM_KSP_Tree::delta(TInt link_ID, std::unordered_map<TInt, TFlt>& cost_map)
+// persistent merge, the nodes on the right spine of a are copied and nothing else is touched
+int MNM_KSP_Tree::merge_heap(int a, int b)
 {
-  auto _link_it = m_graph -> GetEI(link_ID);
-  return cost_map[link_ID] + m_dist_to_dest_map[_link_it.GetDstNId()] - m_dist_to_dest_map[_link_it.GetSrcNId()];
+  if (a < 0) return b;
+  if (b < 0) return a;
+  if (m_heap_key[b] < m_heap_key[a]) std::swap(a, b);
+  int _right = merge_heap(m_heap_right[a], b);
+  return new_heap_node(m_heap_key[a], m_heap_link[a], m_heap_left[a], _right);
 }
 
-MNM_Path *MNM_KSP_Tree::build_path_with_one_more_sidetrack(MNM_Path *path)
+int MNM_KSP_Tree::update_DG()
 {
-  MNM_Cost *_temp_cost;
-  TInt _last_link_ID = path -> m_link_vec.back();
-  TInt _head_node_ID = m_graph -> GetEI(_last_link_ID).GetDstNId();
-  if (m_node_ID_ksp_heap_map.find(_head_node_ID) != m_node_ID_ksp_heap_map.end()){
-    MNM_Path *_new_path = new MNM_Path();
-    _new_path -> m_link_vec = path -> m_link_vec;
-    _temp_cost = m_node_ID_ksp_heap_map[_head_node_ID] -> value -> m_top_cost;
-    _new_path -> m_link_vec.push_back(_temp_cost -> m_ID);
-    _new_path -> m_p = path -> m_p + _temp_cost -> m_cost;
-    return _new_path;
+  // construct D(G), H(v) = H(next node on the tree) + the sidetracks leaving v
+  const int _num_node = m_csr -> m_num_node;
+  const double _inf = std::numeric_limits<double>::max();
+  m_heap_key.clear();
+  m_heap_link.clear();
+  m_heap_left.clear();
+  m_heap_right.clear();
+  m_heap_rank.clear();
+  std::fill(m_heap_root.begin(), m_heap_root.end(), -1);
+
+  // nodes in tree order from the destination, so the next node is always done first
+  std::vector<int> _order = std::vector<int>();
+  _order.reserve(_num_node);
+  _order.push_back(m_dest_index);
+  for (size_t i = 0; i < _order.size(); ++i){
+    int _node = _order[i];
+    for (int p = m_csr -> m_in_offset[_node]; p < m_csr -> m_in_offset[_node + 1]; ++p){
+      if (m_pred[m_csr -> m_in_tail[p]] == m_csr -> m_in_link[p]){
+        _order.push_back(m_csr -> m_in_tail[p]);
+      }
+    }
   }
-  else{
-    return NULL;
+
+  int _root, _link;
+  for (int _node : _order){
+    _root = _node == m_dest_index ? -1 : m_heap_root[m_csr -> m_link_to[m_pred[_node]]];
+    for (int p = m_csr -> m_out_offset[_node]; p < m_csr -> m_out_offset[_node + 1]; ++p){
+      _link = m_csr -> m_out_link[p];
+      if (_link == m_pred[_node] || m_dist[m_csr -> m_link_to[_link]] == _inf) continue;
+      _root = merge_heap(_root, new_heap_node(delta(_link), _link, -1, -1));
+    }
+    m_heap_root[_node] = _root;
   }
+  return 0;
 }
 
-std::vector<MNM_Path*> MNM_KSP_Tree::build_path_with_except_last_sidetrack(MNM_Path *path)
+int MNM_KSP_Tree::get_ksp(TInt src_node_ID, TInt k, MNM_Pathset* path_set, TInt max_walk)
 {
-  std::vector<MNM_Path*> _path_set = std::vector<MNM_Path*>();
-  TInt _last_link_ID = path -> m_link_vec.back();
-  // TInt _head_node_ID = m_graph -> GetEI(_last_link_ID).GetSrcNId();
-  heap<MNM_Cost*>::node *_temp_cost_node =  m_link_ID_heap_map[_last_link_ID];
-  TFlt _delta_e = _temp_cost_node -> value -> m_cost;
-  MNM_Cost *_temp_cost;
-  for (auto _temp_cost_child : _temp_cost_node -> children){
-    if (_temp_cost_child != NULL){
-      _temp_cost = _temp_cost_child -> value;
-      MNM_Path *_new_path = new MNM_Path();
-      _new_path -> m_link_vec = path -> m_link_vec;
-      _new_path -> m_link_vec.pop_back();
-      _new_path -> m_link_vec.push_back(_temp_cost -> m_ID);
-      _new_path -> m_p = path -> m_p - _delta_e + _temp_cost -> m_cost;
-      _path_set.push_back(_new_path);
+  int _src = m_csr -> get_node_index(src_node_ID);
+  // the only loopless path would have no link
+  if (_src == m_dest_index) return 0;
+  if (m_dist[_src] == std::numeric_limits<double>::max()) return 0;
+  if (max_walk <= 0) max_walk = 100 * k;
+
+  // a walk is the tree path with the sidetracks of a chain of states (heap node, previous state)
+  std::vector<std::pair<int, int>> _state = std::vector<std::pair<int, int>>();
+  std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>,
+                      std::greater<std::pair<double, int>>> _Q;
+  std::vector<int> _visited = std::vector<int>(m_csr -> m_num_node, -1);
+  std::vector<int> _sidetrack = std::vector<int>();
+  int _num_path = 0, _num_walk = 0;
+
+  std::vector<int> _walk = std::vector<int>();
+  auto _add_walk = [&](int state){
+    _sidetrack.clear();
+    for (int s = state; s >= 0; s = _state[s].second){
+      _sidetrack.push_back(m_heap_link[_state[s].first]);
+    }
+    _walk.clear();
+    _num_walk++;
+    int _cur = _src, _link;
+    while (true){
+      if (_visited[_cur] == _num_walk) return;
+      _visited[_cur] = _num_walk;
+      if (!_sidetrack.empty() && m_csr -> m_link_from[_sidetrack.back()] == _cur){
+        _link = _sidetrack.back();
+        _sidetrack.pop_back();
+      }
+      else if (_cur == m_dest_index){
+        break;
+      }
+      else{
+        _link = m_pred[_cur];
+      }
+      _walk.push_back(_link);
+      _cur = m_csr -> m_link_to[_link];
+    }
+    MNM_Path *_path = new MNM_Path();
+    _path -> m_node_vec.push_back(src_node_ID);
+    for (int _link_index : _walk){
+      _path -> m_link_vec.push_back(m_csr -> m_link_ID[_link_index]);
+      _path -> m_node_vec.push_back(m_csr -> m_node_ID[m_csr -> m_link_to[_link_index]]);
+    }
+    if (path_set -> is_in(_path)){
+      delete _path;
+      return;
+    }
+    path_set -> m_path_vec.push_back(_path);
+    _num_path++;
+  };
+
+  _add_walk(-1);
+  if (m_heap_root[_src] >= 0){
+    _state.push_back(std::make_pair(m_heap_root[_src], -1));
+    _Q.push(std::make_pair(m_dist[_src] + m_heap_key[m_heap_root[_src]], 0));
+  }
+  int _cur_state, _heap_node, _next;
+  double _cost;
+  while (_num_path < k && !_Q.empty() && _num_walk < max_walk){
+    _cost = _Q.top().first;
+    _cur_state = _Q.top().second;
+    _Q.pop();
+    _add_walk(_cur_state);
+    _heap_node = _state[_cur_state].first;
+    // swap the last sidetrack for one of the next larger ones
+    for (int _child : {m_heap_left[_heap_node], m_heap_right[_heap_node]}){
+      if (_child < 0) continue;
+      _state.push_back(std::make_pair(_child, _state[_cur_state].second));
+      _Q.push(std::make_pair(_cost - m_heap_key[_heap_node] + m_heap_key[_child], int(_state.size()) - 1));
+    }
+    // or append one more sidetrack after it
+    _next = m_heap_root[m_csr -> m_link_to[m_heap_link[_heap_node]]];
+    if (_next >= 0){
+      _state.push_back(std::make_pair(_next, _cur_state));
+      _Q.push(std::make_pair(_cost + m_heap_key[_next], int(_state.size()) - 1));
     }
   }
-  return _path_set;
+  return _num_path;
 }
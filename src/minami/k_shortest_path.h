@@ -4,50 +4,57 @@
 #include "Snap.h"
 #include "path.h"
 #include "shortest_path.h"
-#include "d_array_heap.h"
 
 #include <unordered_map>
-
-
-
-/* tailed-heap used in the ksp algorithm */
-class KSP_Heap
-{ 
-public:
-  KSP_Heap();
-  ~KSP_Heap();
-  MNM_Cost *m_top_cost;
-  heap<MNM_Cost*> m_binary_heap_cost = heap<MNM_Cost*>([](MNM_Cost *c) {return c -> m_cost();});  
-};
+#include <vector>
 
 
 
 /*------------------------------------------------------------
                   K-shortest path one destination tree
 -------------------------------------------------------------*/
+// Eppstein's algorithm: the shortest path tree to the destination plus D(G), the heaps of
+// sidetracks (non tree links) reachable along the tree path of every node, kept as persistent
+// leftist heaps so H(v) shares all of H(next node) and building D(G) is O(m log n).
+// get_ksp then enumerates the paths from a source in increasing cost, O(k log k).
 class MNM_KSP_Tree
 {
 public:
   MNM_KSP_Tree(TInt dest_node_ID, PNEGraph graph);
+  // shares a snapshot owned by the caller, e.g. one for all destinations
+  MNM_KSP_Tree(TInt dest_node_ID, MNM_Graph_CSR *csr);
   ~MNM_KSP_Tree();
 
   int initialize();
   int update_tree(std::unordered_map<TInt, TFlt>& cost_map);
-  int update_DG(std::unordered_map<TInt, TFlt>& cost_map);
-  int get_ksp(TInt src_node_ID, TInt k, MNM_Pathset* path_set);
-  TFlt delta(TInt link_ID, std::unordered_map<TInt, TFlt>& cost_map);
-
-  MNM_Path *build_path_with_one_more_sidetrack(MNM_Path *path);
-  std::vector<MNM_Path*> build_path_with_except_last_sidetrack(MNM_Path *path);
+  // cost[i] is the cost of CSR link i
+  int update_tree(const double *cost);
+  int update_DG();
+  // appends the k shortest loopless paths from src to the destination, shortest first,
+  // walks with a loop are skipped, at most max_walk walks are enumerated (0 for 100 * k),
+  // nothing is appended when src is the destination
+  int get_ksp(TInt src_node_ID, TInt k, MNM_Pathset* path_set, TInt max_walk = 0);
+  // extra cost of taking link_index once and then going back to the tree
+  double delta(int link_index);
 
   TInt m_dest_node_ID;
-  std::unordered_map<TInt, TFlt> m_dist_to_dest_map;
-  std::unordered_map<TInt, TInt> m_sp_tree_map;
-  heap<KSP_Heap*> m_DG = heap<KSP_Heap*>([](KSP_Heap *th){return th -> m_top_cost -> m_cost();});
-  std::unordered_map<TInt, heap<MNM_Cost*>::node*> m_link_ID_heap_map;
-  std::unordered_map<TInt, heap<KSP_Heap*>::node*> m_node_ID_ksp_heap_map;
-  std::unordered_map<TInt, MNM_Cost*> m_node_ID_sidetrack_map;
-  PNEGraph m_graph;
+  int m_dest_index;
+  MNM_Graph_CSR *m_csr;
+  bool m_own_csr;
+  std::vector<double> m_cost;
+  std::vector<double> m_dist;
+  std::vector<int> m_pred;
+
+  // D(G): m_heap_root[v] is H(v), -1 for empty
+  std::vector<int> m_heap_root;
+  std::vector<double> m_heap_key;
+  std::vector<int> m_heap_link;
+  std::vector<int> m_heap_left;
+  std::vector<int> m_heap_right;
+  std::vector<int> m_heap_rank;
+private:
+  int new_heap_node(double key, int link_index, int left, int right);
+  int merge_heap(int a, int b);
 };
 
 
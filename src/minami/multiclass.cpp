@@ -33,6 +33,9 @@ MNM_Dlink_Multiclass::MNM_Dlink_Multiclass(TInt ID,
 	m_N_in_tree_truck = NULL;
 	m_N_out_tree_truck = NULL;
 
+	m_dar_bins_car = NULL;
+	m_dar_bins_truck = NULL;
+
 	// average waiting time per vehicle = tot_wait_time/(tot_num_car + tot_num_truck)
 	m_tot_wait_time_at_intersection = 0; // seconds
 
@@ -55,6 +58,8 @@ MNM_Dlink_Multiclass::~MNM_Dlink_Multiclass()
   	if (m_N_in_tree_car != NULL) delete m_N_in_tree_car;
   	if (m_N_out_tree_truck != NULL) delete m_N_out_tree_truck;
   	if (m_N_in_tree_truck != NULL) delete m_N_in_tree_truck;
+  	if (m_dar_bins_car != NULL) delete m_dar_bins_car;
+  	if (m_dar_bins_truck != NULL) delete m_dar_bins_truck;
 }
 
 int MNM_Dlink_Multiclass::install_cumulative_curve_multiclass()
@@ -91,6 +96,31 @@ int MNM_Dlink_Multiclass::install_cumulative_curve_tree_multiclass()
   	return 0;
 }
 
+int MNM_Dlink_Multiclass::install_dar_bins_multiclass(MNM_Dar_Observation *observation)
+{
+	if (m_dar_bins_car != NULL) delete m_dar_bins_car;
+  	if (m_dar_bins_truck != NULL) delete m_dar_bins_truck;
+	m_dar_bins_car = new MNM_Dar_Bins(observation);
+	m_dar_bins_truck = new MNM_Dar_Bins(observation);
+  	return 0;
+}
+
+int MNM_Dlink_Multiclass::reset()
+{
+	MNM_Dlink::reset();
+	if (m_N_in_car != NULL || m_N_in_truck != NULL){
+		install_cumulative_curve_multiclass();
+	}
+	if (m_N_in_tree_car != NULL || m_N_in_tree_truck != NULL){
+		install_cumulative_curve_tree_multiclass();
+	}
+	if (m_dar_bins_car != NULL) m_dar_bins_car -> reset();
+	if (m_dar_bins_truck != NULL) m_dar_bins_truck -> reset();
+	m_tot_wait_time_at_intersection = 0;
+	m_spill_back = false;
+	return 0;
+}
+
 TFlt MNM_Dlink_Multiclass::get_link_freeflow_tt_car()
 {
 	return m_length/m_ffs_car;
@@ -592,6 +622,21 @@ int MNM_Dlink_Ctm_Multiclass::clear_incoming_array()
 	return 0;
 }
 
+int MNM_Dlink_Ctm_Multiclass::reset()
+{
+	MNM_Dlink_Multiclass::reset();
+	for (Ctm_Cell_Multiclass* _cell : m_cell_array){
+		_cell -> m_veh_queue_car.clear();
+		_cell -> m_veh_queue_truck.clear();
+		_cell -> m_volume_car = TInt(0);
+		_cell -> m_volume_truck = TInt(0);
+		_cell -> m_out_veh_car = TInt(0);
+		_cell -> m_out_veh_truck = TInt(0);
+		_cell -> update_perceived_density();
+	}
+	return 0;
+}
+
 TFlt MNM_Dlink_Ctm_Multiclass::get_link_flow_car()
 {
 	TInt _total_volume_car = 0;
@@ -1142,6 +1187,19 @@ void MNM_Dlink_Lq_Multiclass::print_info()
 	printf("Total truck volume in the link: %.4f\n", (float)(m_volume_truck/m_flow_scalar));
 }
 
+int MNM_Dlink_Lq_Multiclass::reset()
+{
+	MNM_Dlink_Multiclass::reset();
+	m_veh_queue_car.clear();
+	m_veh_queue_truck.clear();
+	m_veh_out_buffer_car.clear();
+	m_veh_out_buffer_truck.clear();
+	m_volume_car = TInt(0);
+	m_volume_truck = TInt(0);
+	update_perceived_density();
+	return 0;
+}
+
 TFlt MNM_Dlink_Lq_Multiclass::get_link_flow_car()
 {
 	return TFlt(m_volume_car) / m_flow_scalar;
@@ -1288,6 +1346,15 @@ int MNM_Dlink_Pq_Multiclass::evolve(TInt timestamp)
 	return 0;
 }
 
+int MNM_Dlink_Pq_Multiclass::reset()
+{
+	MNM_Dlink_Multiclass::reset();
+	m_veh_pool.clear();
+	m_volume_car = TInt(0);
+	m_volume_truck = TInt(0);
+	return 0;
+}
+
 TFlt MNM_Dlink_Pq_Multiclass::get_link_flow_car()
 {
 	return 0;
@@ -1521,6 +1588,12 @@ int MNM_Dnode_Inout_Multiclass::prepare_loading()
 {
 	TInt _num_in = m_in_link_array.size();
 	TInt _num_out = m_out_link_array.size();
+	// called again after MNM_Dta::reset
+	if (m_demand != NULL) free(m_demand);
+	if (m_supply != NULL) free(m_supply);
+	if (m_veh_flow != NULL) free(m_veh_flow);
+	if (m_veh_moved_car != NULL) free(m_veh_moved_car);
+	if (m_veh_moved_truck != NULL) free(m_veh_moved_truck);
 	m_demand = (TFlt*) malloc(sizeof(TFlt) * _num_in * _num_out); // real-world vehicles
 	memset(m_demand, 0x0, sizeof(TFlt) * _num_in * _num_out);
 	m_supply = (TFlt*) malloc(sizeof(TFlt) * _num_out); // real-world vehicles
@@ -1650,6 +1723,9 @@ int MNM_Dnode_Inout_Multiclass::move_vehicle(TInt timestamp)
 									if (_ilink -> m_N_in_tree_car != NULL) {
 										_ilink -> m_N_in_tree_car -> add_flow(TFlt(timestamp), 1/m_flow_scalar, _veh -> m_path, _veh -> m_assign_interval);
 									}
+									if (_ilink -> m_dar_bins_car != NULL) {
+										_ilink -> m_dar_bins_car -> add_flow(timestamp, 1/m_flow_scalar, _veh -> m_path, _veh -> m_assign_interval);
+									}
 								}
 								else {
 									IAssert(_veh -> m_class == 1);
@@ -1662,6 +1738,9 @@ int MNM_Dnode_Inout_Multiclass::move_vehicle(TInt timestamp)
 									if (_ilink -> m_N_in_tree_truck != NULL) {
 										_ilink -> m_N_in_tree_truck -> add_flow(TFlt(timestamp), 1/m_flow_scalar, _veh -> m_path, _veh -> m_assign_interval);
 									}
+									if (_ilink -> m_dar_bins_truck != NULL) {
+										_ilink -> m_dar_bins_truck -> add_flow(timestamp, 1/m_flow_scalar, _veh -> m_path, _veh -> m_assign_interval);
+									}
 								}
 								_veh_it = _in_link -> m_finished_array.erase(_veh_it);
 							}
@@ -1679,6 +1758,9 @@ int MNM_Dnode_Inout_Multiclass::move_vehicle(TInt timestamp)
 								if (_ilink -> m_N_in_tree_car != NULL) {
 									_ilink -> m_N_in_tree_car -> add_flow(TFlt(timestamp), 1/m_flow_scalar, _veh -> m_path, _veh -> m_assign_interval);
 								}
+								if (_ilink -> m_dar_bins_car != NULL) {
+									_ilink -> m_dar_bins_car -> add_flow(timestamp, 1/m_flow_scalar, _veh -> m_path, _veh -> m_assign_interval);
+								}
 							}
 							else {
 								IAssert(_veh -> m_class == 1);
@@ -1691,6 +1773,9 @@ int MNM_Dnode_Inout_Multiclass::move_vehicle(TInt timestamp)
 								if (_ilink -> m_N_in_tree_truck != NULL) {
 									_ilink -> m_N_in_tree_truck -> add_flow(TFlt(timestamp), 1/m_flow_scalar, _veh -> m_path, _veh -> m_assign_interval);
 								}
+								if (_ilink -> m_dar_bins_truck != NULL) {
+									_ilink -> m_dar_bins_truck -> add_flow(timestamp, 1/m_flow_scalar, _veh -> m_path, _veh -> m_assign_interval);
+								}
 							}
 							_veh_it = _in_link -> m_finished_array.erase(_veh_it);
 						}
@@ -1837,6 +1922,8 @@ int MNM_Dnode_GRJ_Multiclass::prepare_loading()
 {
 	MNM_Dnode_Inout_Multiclass::prepare_loading();
 	TInt _num_in = m_in_link_array.size();
+	if (m_d_a != NULL) free(m_d_a);
+	if (m_C_a != NULL) free(m_C_a);
 	m_d_a = (TFlt*) malloc(sizeof(TFlt) * _num_in);
 	memset(m_d_a, 0x0, sizeof(TFlt) * _num_in);
 	m_C_a = (TFlt*) malloc(sizeof(TFlt) * _num_in);
@@ -1887,17 +1974,18 @@ MNM_Origin_Multiclass::~MNM_Origin_Multiclass()
 
 int MNM_Origin_Multiclass::add_dest_demand_multiclass(MNM_Destination_Multiclass *dest, 
 													TFlt* demand_car, 
-													TFlt* demand_truck)
+													TFlt* demand_truck,
+													TInt num_of_minute)
 {
-	// split (15-mins demand) to (15 * 1-minute demand)
-  	TFlt* _demand_car = (TFlt*) malloc(sizeof(TFlt) * m_max_assign_interval * 15);
-  	for (int i = 0; i < m_max_assign_interval * 15; ++i) {
+	// the (assign interval demand) split to (num_of_minute * 1-minute demand)
+  	TFlt* _demand_car = (TFlt*) malloc(sizeof(TFlt) * m_max_assign_interval * num_of_minute);
+  	for (int i = 0; i < m_max_assign_interval * num_of_minute; ++i) {
   		_demand_car[i] =  TFlt(demand_car[i]);
   	}
   	m_demand_car.insert({dest, _demand_car});
 
-  	TFlt* _demand_truck = (TFlt*) malloc(sizeof(TFlt) * m_max_assign_interval * 15);
-  	for (int i = 0; i < m_max_assign_interval * 15; ++i) {
+  	TFlt* _demand_truck = (TFlt*) malloc(sizeof(TFlt) * m_max_assign_interval * num_of_minute);
+  	for (int i = 0; i < m_max_assign_interval * num_of_minute; ++i) {
   		_demand_truck[i] =  TFlt(demand_truck[i]);
   	}
   	m_demand_truck.insert({dest, _demand_truck});
@@ -1905,6 +1993,23 @@ int MNM_Origin_Multiclass::add_dest_demand_multiclass(MNM_Destination_Multiclass
   	return 0;
 }
 
+int MNM_Origin_Multiclass::set_dest_demand_multiclass(MNM_Destination_Multiclass *dest, 
+													TFlt* demand_car, 
+													TFlt* demand_truck,
+													TInt num_of_minute)
+{
+	if (m_demand_car.find(dest) == m_demand_car.end()){
+		return add_dest_demand_multiclass(dest, demand_car, demand_truck, num_of_minute);
+	}
+	TFlt* _demand_car = m_demand_car.find(dest) -> second;
+	TFlt* _demand_truck = m_demand_truck.find(dest) -> second;
+	for (int i = 0; i < m_max_assign_interval * num_of_minute; ++i) {
+		_demand_car[i] = TFlt(demand_car[i]);
+		_demand_truck[i] = TFlt(demand_truck[i]);
+	}
+	return 0;
+}
+
 int MNM_Origin_Multiclass::release(MNM_Veh_Factory* veh_factory, TInt current_interval)
 {
   	// if ((m_current_assign_interval < m_max_assign_interval) && (current_interval % m_frequency == 0)){
@@ -2534,7 +2639,7 @@ int MNM_IO_Multiclass::build_demand_multiclass(std::string file_folder,
 				}
 				_origin = dynamic_cast<MNM_Origin_Multiclass *>(od_factory -> get_origin(_O_ID));
 				_dest = dynamic_cast<MNM_Destination_Multiclass *>(od_factory -> get_destination(_D_ID));
-				_origin -> add_dest_demand_multiclass(_dest, _demand_vector_car, _demand_vector_truck);
+				_origin -> add_dest_demand_multiclass(_dest, _demand_vector_car, _demand_vector_truck, _num_of_minute);
 			}
 			else{
 				printf("Something wrong in build_demand!\n");
@@ -2553,6 +2658,114 @@ int MNM_IO_Multiclass::build_demand_multiclass(std::string file_folder,
 
 
 
+int MNM_IO_Multiclass::build_node_factory_multiclass(MNM_Network_Bundle *bundle, 
+											MNM_ConfReader *conf_reader, 
+											MNM_Node_Factory *node_factory)
+{
+	TFlt _flow_scalar = conf_reader -> get_float("flow_scalar");
+	if (bundle -> m_header -> m_node_width != 1){
+		printf("MNM_IO_Multiclass::build_node_factory_Multiclass: Wrong length of line.\n");
+		exit(-1);
+	}
+	MNM_Node_Factory_Multiclass* _node_factory = dynamic_cast<MNM_Node_Factory_Multiclass *>(node_factory);
+	std::string _type;
+	DNode_type_multiclass _node_type;
+	for (int i = 0; i < bundle -> m_header -> m_num_node; ++i){
+		_type = bundle -> get_type(bundle -> m_node_type[i]);
+		if (_type == "FWJ") _node_type = MNM_TYPE_FWJ_MULTICLASS;
+		else if (_type == "DMOND") _node_type = MNM_TYPE_ORIGIN_MULTICLASS;
+		else if (_type == "DMDND") _node_type = MNM_TYPE_DEST_MULTICLASS;
+		else {
+			printf("Wrong node type, %s\n", _type.c_str());
+			exit(-1);
+		}
+		_node_factory -> make_node_multiclass(TInt(bundle -> m_node_ID[i]), 
+											_node_type, 
+											_flow_scalar,
+											TFlt(bundle -> m_node_value[i]));
+	}
+	return 0;
+}
+
+int MNM_IO_Multiclass::build_link_factory_multiclass(MNM_Network_Bundle *bundle, 
+										MNM_ConfReader *conf_reader, 
+										MNM_Link_Factory *link_factory)
+{
+	TFlt _flow_scalar = conf_reader -> get_float("flow_scalar");
+	TFlt _unit_time = conf_reader -> get_float("unit_time");
+	const int _width = bundle -> m_header -> m_link_width;
+	if (_width != 9){
+		printf("MNM_IO::build_link_factory::Wrong length of line.\n");
+		exit(-1);
+	}
+	MNM_Link_Factory_Multiclass* _link_factory = dynamic_cast<MNM_Link_Factory_Multiclass *>(link_factory);
+	std::string _type;
+	DLink_type_multiclass _link_type;
+	const double *_value;
+	for (int i = 0; i < bundle -> m_header -> m_num_link; ++i){
+		_type = bundle -> get_type(bundle -> m_link_type[i]);
+		if (_type == "PQ") _link_type = MNM_TYPE_PQ_MULTICLASS;
+		else if (_type == "LQ") _link_type = MNM_TYPE_LQ_MULTICLASS;
+		else if (_type == "CTM") _link_type = MNM_TYPE_CTM_MULTICLASS;
+		else {
+			printf("Wrong link type, %s\n", _type.c_str());
+			exit(-1);
+		}
+		_value = bundle -> m_link_value + size_t(i) * _width;
+		/* unit conversion as in the text builder */
+		_link_factory -> make_link_multiclass(TInt(bundle -> m_link_ID[i]),
+											_link_type,
+											TInt(int(_value[4])),
+											TFlt(_value[0]) * TFlt(1600),
+											TFlt(_value[3]) / TFlt(1600),
+											TFlt(_value[7]) / TFlt(1600),
+											TFlt(_value[2]) / TFlt(3600),
+											TFlt(_value[6]) / TFlt(3600),
+											TFlt(_value[1]) * TFlt(1600) / TFlt(3600),
+											TFlt(_value[5]) * TFlt(1600) / TFlt(3600),
+											_unit_time,
+											TFlt(_value[8]),
+											_flow_scalar);
+	}
+	return 0;
+}
+
+int MNM_IO_Multiclass::build_demand_multiclass(MNM_Network_Bundle *bundle, 
+ 											MNM_ConfReader *conf_reader, 
+ 											MNM_OD_Factory *od_factory)
+{
+	TInt _unit_time = conf_reader -> get_int("unit_time");
+	TInt _num_of_minute =  int(conf_reader -> get_int("assign_frq")) / (60 / _unit_time);
+	TInt _max_interval = conf_reader -> get_int("max_interval"); 
+	const int _width = bundle -> m_header -> m_demand_width;
+	if (_width != 2 * _max_interval){
+		printf("Something wrong in build_demand!\n");
+		exit(-1);
+	}
+	std::vector<TFlt> _demand_vector_car = std::vector<TFlt>(_max_interval * _num_of_minute);
+	std::vector<TFlt> _demand_vector_truck = std::vector<TFlt>(_max_interval * _num_of_minute);
+	TFlt _demand_car, _demand_truck;
+	const double *_value;
+	MNM_Origin_Multiclass *_origin;
+	MNM_Destination_Multiclass *_dest;
+	for (int i = 0; i < bundle -> m_header -> m_num_OD; ++i){
+		_value = bundle -> m_demand_value + size_t(i) * _width;
+		for (int j = 0; j < _max_interval; ++j) {
+			_demand_car = TFlt(_value[j]) / TFlt(_num_of_minute);
+			_demand_truck = TFlt(_value[j + _max_interval]) / TFlt(_num_of_minute);
+			for (int k = 0; k < _num_of_minute; ++k){
+				_demand_vector_car[j * _num_of_minute + k] = _demand_car;
+				_demand_vector_truck[j * _num_of_minute + k] = _demand_truck;
+			}
+		}
+		_origin = dynamic_cast<MNM_Origin_Multiclass *>(od_factory -> get_origin(TInt(bundle -> m_demand_O_ID[i])));
+		_dest = dynamic_cast<MNM_Destination_Multiclass *>(od_factory -> get_destination(TInt(bundle -> m_demand_D_ID[i])));
+		_origin -> add_dest_demand_multiclass(_dest, _demand_vector_car.data(), _demand_vector_truck.data(), _num_of_minute);
+	}
+	return 0;
+}
+
+
 /******************************************************************************************************************
 *******************************************************************************************************************
 												Multiclass DTA
@@ -2599,12 +2812,26 @@ int MNM_Dta_Multiclass::initialize()
 
 int MNM_Dta_Multiclass::build_from_files()
 {
-	MNM_IO_Multiclass::build_node_factory_multiclass(m_file_folder, m_config, m_node_factory);
-	MNM_IO_Multiclass::build_link_factory_multiclass(m_file_folder, m_config, m_link_factory);
-	// MNM_IO_Multiclass::build_od_factory_multiclass(m_file_folder, m_config, m_od_factory, m_node_factory);
-	MNM_IO_Multiclass::build_od_factory(m_file_folder, m_config, m_od_factory, m_node_factory);
-	m_graph = MNM_IO_Multiclass::build_graph(m_file_folder, m_config);
-	MNM_IO_Multiclass::build_demand_multiclass(m_file_folder, m_config, m_od_factory);
+	MNM_Network_Bundle *_bundle = MNM_IO::load_network_bundle(m_file_folder, m_config);
+	if (_bundle != NULL){
+		build_network(_bundle);
+		delete _bundle;
+	}
+	else{
+		MNM_IO_Multiclass::build_node_factory_multiclass(m_file_folder, m_config, m_node_factory);
+		MNM_IO_Multiclass::build_link_factory_multiclass(m_file_folder, m_config, m_link_factory);
+		// MNM_IO_Multiclass::build_od_factory_multiclass(m_file_folder, m_config, m_od_factory, m_node_factory);
+		MNM_IO_Multiclass::build_od_factory(m_file_folder, m_config, m_od_factory, m_node_factory);
+		m_graph = MNM_IO_Multiclass::build_graph(m_file_folder, m_config);
+		MNM_IO_Multiclass::build_demand_multiclass(m_file_folder, m_config, m_od_factory);
+	}
+	std::ifstream _emission_file(m_file_folder + "/MNM_input_emission_linkID");
+	int _link_ID;
+	while (_emission_file >> _link_ID)
+	{
+	    m_emission_links.insert({_link_ID, 0});
+	}
+	_emission_file.close();
 	// build_workzone();
 	m_workzone = NULL;
 	set_statistics();
@@ -2612,6 +2839,34 @@ int MNM_Dta_Multiclass::build_from_files()
 	return 0;
 }
 
+int MNM_Dta_Multiclass::build_from_memory(MNM_Network_Bundle *bundle)
+{
+	build_network(bundle);
+	for (int i = 0; i < bundle -> m_num_emission_link; ++i){
+		m_emission_links.insert({int(bundle -> m_emission_link_ID[i]), 0});
+	}
+	m_workzone = NULL;
+	set_statistics();
+	Path_Table *_path_table = NULL;
+	if (bundle -> m_num_path > 0){
+		_path_table = MNM_IO::build_path_table(m_graph, bundle -> m_num_path, bundle -> m_path_node_offset, 
+		                                       bundle -> m_path_node, bundle -> m_num_path_node, 
+		                                       bundle -> m_path_buffer, bundle -> m_path_buffer_length);
+	}
+	set_routing(_path_table);
+	return 0;
+}
+
+int MNM_Dta_Multiclass::build_network(MNM_Network_Bundle *bundle)
+{
+	MNM_IO_Multiclass::build_node_factory_multiclass(bundle, m_config, m_node_factory);
+	MNM_IO_Multiclass::build_link_factory_multiclass(bundle, m_config, m_link_factory);
+	MNM_IO_Multiclass::build_od_factory(bundle, m_config, m_od_factory, m_node_factory);
+	m_graph = MNM_IO_Multiclass::build_graph(bundle);
+	MNM_IO_Multiclass::build_demand_multiclass(bundle, m_config, m_od_factory);
+	return 0;
+}
+
 int MNM_Dta_Multiclass::pre_loading()
 {
 	MNM_Dnode *_node;
@@ -2622,21 +2877,12 @@ int MNM_Dta_Multiclass::pre_loading()
 		_node -> prepare_loading();
 	}
 
-	std::ifstream _emission_file(m_file_folder + "/MNM_input_emission_linkID");
-	int _link_ID;
-	std::unordered_map<int, int> _emission_links = {};
-	while (_emission_file >> _link_ID)
-	{
-	    _emission_links.insert({_link_ID, 0});
-	}
-	_emission_file.close();
-
 	std::deque<TInt> *_rec;
   	for (auto _map_it : m_link_factory -> m_link_map)
   	{
     	_rec = new std::deque<TInt>();
     	m_queue_veh_map.insert({_map_it.second -> m_link_ID, _rec});
-    	if (_emission_links.find(int(_map_it.second -> m_link_ID)) != _emission_links.end()) 
+    	if (m_emission_links.find(int(_map_it.second -> m_link_ID)) != m_emission_links.end()) 
     		m_emission -> register_link(_map_it.second);
   	}
   	
@@ -3033,4 +3279,19 @@ int MNM_Cumulative_Emission_Multiclass::output()
 	printf("fuel: %lf gallons, CO2: %lf g, HC: %lf g, CO: %lf g, NOX: %lf g, VMT: %lf miles, VHT: %lf hours\n", 
 		   m_fuel_truck(), m_CO2_truck(), m_HC_truck(), m_CO_truck(), m_NOX_truck(), m_VMT_truck(), m_VHT_truck());
 	return 0;
-}
\ No newline at end of file
+}
+
+int MNM_Cumulative_Emission_Multiclass::reset()
+{
+	MNM_Cumulative_Emission::reset();
+	m_fuel_truck = TFlt(0);
+	m_CO2_truck = TFlt(0);
+	m_HC_truck = TFlt(0);
+	m_CO_truck = TFlt(0);
+	m_NOX_truck = TFlt(0);
+	m_VMT_truck = TFlt(0);
+
+	m_VHT_car = TFlt(0);
+	m_VHT_truck = TFlt(0);
+	return 0;
+}
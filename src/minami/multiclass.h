@@ -31,6 +31,9 @@ public:
 	int install_cumulative_curve_multiclass();
 	// use this one instead of the one in Dlink class
 	int install_cumulative_curve_tree_multiclass();
+	// online DAR bins, use instead of cc_tree when only DAR is needed
+	int install_dar_bins_multiclass(MNM_Dar_Observation *observation);
+	int virtual reset() override;
 
 	TFlt virtual get_link_flow_car(){return 0;};
 	TFlt virtual get_link_flow_truck(){return 0;};
@@ -55,6 +58,10 @@ public:
   	MNM_Tree_Cumulative_Curve *m_N_out_tree_car;
   	MNM_Tree_Cumulative_Curve *m_N_in_tree_truck;
   	MNM_Tree_Cumulative_Curve *m_N_out_tree_truck;
+
+  	// Two seperate online DAR bins for private cars and trucks
+  	MNM_Dar_Bins *m_dar_bins_car;
+  	MNM_Dar_Bins *m_dar_bins_truck;
 };
 
 
@@ -88,6 +95,7 @@ public:
 	TFlt virtual get_link_flow_truck() override;
 	TFlt virtual get_link_flow() override;
 	TFlt virtual get_link_tt() override;
+	int virtual reset() override;
 
 	int virtual move_veh_queue(std::deque<MNM_Veh*> *from_queue, 
 						std::deque<MNM_Veh*> *to_queue, 
@@ -193,6 +201,7 @@ public:
 	TFlt virtual get_link_flow_truck() override;
 	TFlt virtual get_link_flow() override;
 	TFlt virtual get_link_tt() override;
+	int virtual reset() override;
 
 	int update_perceived_density();
 
@@ -252,6 +261,7 @@ public:
 	TFlt virtual get_link_flow_truck() override;
 	TFlt virtual get_link_flow() override;
 	TFlt virtual get_link_tt() override;
+	int virtual reset() override;
 
 	std::unordered_map<MNM_Veh*, TInt> m_veh_pool;
 	TInt m_volume_car; //vehicle number, without the flow scalar
@@ -378,10 +388,17 @@ public:
 									TFlt adaptive_ratio_car,
 									TFlt adaptive_ratio_truck) override;
 
-	// use this one instead of add_dest_demand in the base class
+	// use this one instead of add_dest_demand in the base class,
+	// the demand has num_of_minute 1-minute values per assign interval
 	int add_dest_demand_multiclass(MNM_Destination_Multiclass *dest, 
 								TFlt* demand_car, 
-								TFlt* demand_truck);
+								TFlt* demand_truck,
+								TInt num_of_minute);
+	// overwrite the demand to dest in place, add it if not exists
+	int set_dest_demand_multiclass(MNM_Destination_Multiclass *dest, 
+								TFlt* demand_car, 
+								TFlt* demand_truck,
+								TInt num_of_minute);
 	// two new unordered_map for both classes
 	std::unordered_map<MNM_Destination_Multiclass*, TFlt*> m_demand_car;
 	std::unordered_map<MNM_Destination_Multiclass*, TFlt*> m_demand_truck;
@@ -502,6 +519,16 @@ public:
  	static int build_demand_multiclass(std::string file_folder, 
  									MNM_ConfReader *conf_reader, 
  									MNM_OD_Factory *od_factory);
+ 	// from the binary network bundle, see MNM_Network_Bundle
+ 	static int build_node_factory_multiclass(MNM_Network_Bundle *bundle, 
+											MNM_ConfReader *conf_reader, 
+											MNM_Node_Factory *node_factory);
+ 	static int build_link_factory_multiclass(MNM_Network_Bundle *bundle, 
+ 											MNM_ConfReader *conf_reader, 
+ 											MNM_Link_Factory *link_factory);
+ 	static int build_demand_multiclass(MNM_Network_Bundle *bundle, 
+ 									MNM_ConfReader *conf_reader, 
+ 									MNM_OD_Factory *od_factory);
 };
 
 
@@ -519,7 +546,11 @@ public:
 	~MNM_Dta_Multiclass();
 	int virtual initialize() override;
 	int virtual build_from_files() override;
+	int virtual build_from_memory(MNM_Network_Bundle *bundle) override;
+	int virtual build_network(MNM_Network_Bundle *bundle) override;
 	int virtual pre_loading() override;
+	// links whose emissions are recorded
+	std::unordered_map<int, int> m_emission_links;
 }; 
 
 
@@ -577,6 +608,7 @@ public:
 
   int virtual update() override;
   int virtual output() override;
+  int virtual reset() override;
 
   TFlt m_fuel_truck;
   TFlt m_CO2_truck;
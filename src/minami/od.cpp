@@ -32,6 +32,18 @@ int MNM_Origin::add_dest_demand(MNM_Destination *dest, TFlt* demand)
   return 0;
 }
 
+int MNM_Origin::set_dest_demand(MNM_Destination *dest, TFlt* demand)
+{
+  auto _demand_it = m_demand.find(dest);
+  if (_demand_it == m_demand.end()){
+    return add_dest_demand(dest, demand);
+  }
+  for (int i = 0; i < m_max_assign_interval; ++i) {
+    _demand_it -> second[i] = TFlt(demand[i]);
+  }
+  return 0;
+}
+
 int MNM_Origin::release(MNM_Veh_Factory* veh_factory, TInt current_interval)
 {
   if (m_current_assign_interval < m_max_assign_interval && current_interval % m_frequency == 0){
@@ -88,6 +100,7 @@ int MNM_Origin::release_one_interval(TInt current_interval, MNM_Veh_Factory* veh
 MNM_Destination::MNM_Destination(TInt ID)
 {
   m_Dest_ID = ID;
+  m_dest_index = -1;
 }
 
 
@@ -31,6 +31,8 @@ public:
                                           TFlt adaptive_ratio_truck){return 0;};
 
   int add_dest_demand(MNM_Destination *dest, TFlt* demand);
+  // overwrite the demand to dest in place, add it if not exists
+  int set_dest_demand(MNM_Destination *dest, TFlt* demand);
   MNM_DMOND *m_origin_node;
 // private:
   TInt m_frequency;
@@ -47,6 +49,8 @@ public:
   MNM_Destination(TInt ID);
   virtual ~MNM_Destination();
   TInt m_Dest_ID;
+  // row of this destination in the next link table of MNM_Routing_Adaptive
+  TInt m_dest_index;
   TFlt m_flow_scalar;
   MNM_DMDND *m_dest_node;
   int receive(TInt current_interval);
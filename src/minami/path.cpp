@@ -1,15 +1,22 @@
 #include "path.h"
+#include "k_shortest_path.h"
+#include "contraction_hierarchy.h"
+
+#include <algorithm>
+#include <limits>
+#include <cstring>
 
 /**************************************************************************
                               Path
 **************************************************************************/
 MNM_Path::MNM_Path()
 {
-  m_link_vec = std::deque<TInt>();
-  m_node_vec = std::deque<TInt>();
+  m_link_vec = std::vector<TInt>();
+  m_node_vec = std::vector<TInt>();
   m_buffer_length = 0;
   m_p = 0;
   m_buffer = NULL;
+  m_own_buffer = false;
   m_path_ID = -1;
 }
 
@@ -18,7 +25,7 @@ MNM_Path::~MNM_Path()
 {
   m_link_vec.clear();
   m_node_vec.clear();
-  if (m_buffer != NULL) free(m_buffer);
+  if (m_buffer != NULL && m_own_buffer) free(m_buffer);
 }
 
 
@@ -60,12 +67,22 @@ std::string MNM_Path::buffer_to_string()
   return _s;
 }
 
+size_t MNM_Path::get_link_hash()
+{
+  size_t _hash = m_link_vec.size();
+  for (TInt _link_ID : m_link_vec){
+    _hash ^= std::hash<int>()(_link_ID()) + 0x9e3779b9 + (_hash << 6) + (_hash >> 2);
+  }
+  return _hash;
+}
+
 int MNM_Path::allocate_buffer(TInt length){
   if ((m_buffer_length > 0) || (m_buffer != NULL)){
     throw std::runtime_error("Error: MNM_Path::allocate_buffer, double allocation.");
   }
   m_buffer_length = length;
   m_buffer = static_cast<TFlt*>(std::malloc(sizeof(TFlt) * length));
+  m_own_buffer = true;
   for (int i =0; i < length; ++i){
     m_buffer[i] = 0.0;
   }
@@ -79,6 +96,8 @@ int MNM_Path::allocate_buffer(TInt length){
 MNM_Pathset::MNM_Pathset()
 {
   m_path_vec = std::vector<MNM_Path*>();
+  m_hash_index = std::unordered_multimap<size_t, int>();
+  m_num_hashed = 0;
 }
 
 MNM_Pathset::~MNM_Pathset()
@@ -91,8 +110,12 @@ MNM_Pathset::~MNM_Pathset()
 
 bool MNM_Pathset::is_in(MNM_Path* path)
 {
-  for (MNM_Path *tmp_path : m_path_vec){
-    if (*tmp_path == *path) return true;
+  for (; m_num_hashed < m_path_vec.size(); ++m_num_hashed){
+    m_hash_index.insert({m_path_vec[m_num_hashed] -> get_link_hash(), int(m_num_hashed)});
+  }
+  auto _range = m_hash_index.equal_range(path -> get_link_hash());
+  for (auto _it = _range.first; _it != _range.second; ++_it){
+    if (*m_path_vec[_it -> second] == *path) return true;
   }
   return false;
 }
@@ -131,6 +154,250 @@ int MNM_Pathset::normalize_p()
   return 0;
 }
 
+/**************************************************************************
+                            Path Table
+**************************************************************************/
+MNM_Path_Table::MNM_Path_Table()
+  : std::unordered_map<TInt, std::unordered_map<TInt, MNM_Pathset*>*>()
+{
+  m_num_path = 0;
+  m_origin_node_ID = std::vector<TInt>();
+  m_dest_node_ID = std::vector<TInt>();
+  m_origin_index = std::unordered_map<TInt, int>();
+  m_dest_index = std::unordered_map<TInt, int>();
+  m_od_offset = std::vector<int>();
+  m_path = std::vector<MNM_Path*>();
+  m_link_offset = std::vector<int>();
+  m_link = std::vector<TInt>();
+  m_buffer_length = 0;
+  m_buffer = std::vector<TFlt>();
+  m_path_index = std::unordered_map<TInt, int>();
+}
+
+// the paths are deleted with their pathsets, their buffers go with m_buffer
+MNM_Path_Table::~MNM_Path_Table()
+{
+  m_path.clear();
+  m_buffer.clear();
+}
+
+int MNM_Path_Table::compact(TInt buffer_length)
+{
+  // origins and destinations in ID order, so the layout does not depend on the hashing
+  m_origin_node_ID.clear();
+  m_dest_node_ID.clear();
+  for (auto _it : *this){
+    m_origin_node_ID.push_back(_it.first);
+    for (auto _it_it : *(_it.second)){
+      m_dest_node_ID.push_back(_it_it.first);
+    }
+  }
+  std::sort(m_origin_node_ID.begin(), m_origin_node_ID.end());
+  std::sort(m_dest_node_ID.begin(), m_dest_node_ID.end());
+  m_dest_node_ID.erase(std::unique(m_dest_node_ID.begin(), m_dest_node_ID.end()), m_dest_node_ID.end());
+  m_origin_index.clear();
+  m_dest_index.clear();
+  for (size_t i = 0; i < m_origin_node_ID.size(); ++i){
+    m_origin_index.insert(std::pair<TInt, int>(m_origin_node_ID[i], int(i)));
+  }
+  for (size_t i = 0; i < m_dest_node_ID.size(); ++i){
+    m_dest_index.insert(std::pair<TInt, int>(m_dest_node_ID[i], int(i)));
+  }
+
+  const size_t _num_dest = m_dest_node_ID.size();
+  std::vector<MNM_Pathset*> _pathset = std::vector<MNM_Pathset*>(m_origin_node_ID.size() * _num_dest, NULL);
+  for (auto _it : *this){
+    for (auto _it_it : *(_it.second)){
+      _pathset[m_origin_index[_it.first] * _num_dest + m_dest_index[_it_it.first]] = _it_it.second;
+    }
+  }
+
+  m_od_offset.assign(_pathset.size() + 1, 0);
+  m_path.clear();
+  size_t _num_link = 0;
+  for (size_t k = 0; k < _pathset.size(); ++k){
+    if (_pathset[k] != NULL){
+      for (MNM_Path *_path : _pathset[k] -> m_path_vec){
+        m_path.push_back(_path);
+        _num_link += _path -> m_link_vec.size();
+      }
+    }
+    m_od_offset[k + 1] = int(m_path.size());
+  }
+  m_num_path = int(m_path.size());
+
+  m_link_offset.assign(1, 0);
+  m_link_offset.reserve(m_num_path + 1);
+  m_link.clear();
+  m_link.reserve(_num_link);
+  m_path_index.clear();
+  for (int i = 0; i < m_num_path; ++i){
+    m_link.insert(m_link.end(), m_path[i] -> m_link_vec.begin(), m_path[i] -> m_link_vec.end());
+    m_link_offset.push_back(int(m_link.size()));
+    if (m_path[i] -> m_path_ID >= 0){
+      m_path_index[m_path[i] -> m_path_ID] = i;
+    }
+  }
+
+  if (buffer_length < 0){
+    buffer_length = 0;
+    for (MNM_Path *_path : m_path){
+      if (_path -> m_buffer_length > buffer_length) buffer_length = _path -> m_buffer_length;
+    }
+  }
+  // the old rows are still valid while they are copied, m_buffer may hold some of them
+  std::vector<TFlt> _buffer = std::vector<TFlt>(size_t(m_num_path) * buffer_length, TFlt(0));
+  MNM_Path *_path;
+  for (int i = 0; i < m_num_path; ++i){
+    _path = m_path[i];
+    if (_path -> m_buffer != NULL){
+      std::copy(_path -> m_buffer, _path -> m_buffer + std::min(_path -> m_buffer_length(), buffer_length()), 
+                _buffer.begin() + size_t(i) * buffer_length);
+      if (_path -> m_own_buffer) free(_path -> m_buffer);
+    }
+    _path -> m_buffer = buffer_length > 0 ? _buffer.data() + size_t(i) * buffer_length : NULL;
+    _path -> m_buffer_length = buffer_length;
+    _path -> m_own_buffer = false;
+  }
+  m_buffer.swap(_buffer);
+  m_buffer_length = buffer_length;
+  return 0;
+}
+
+int MNM_Path_Table::get_od_index(TInt origin_node_ID, TInt dest_node_ID)
+{
+  auto _o_it = m_origin_index.find(origin_node_ID);
+  auto _d_it = m_dest_index.find(dest_node_ID);
+  if (_o_it == m_origin_index.end() || _d_it == m_dest_index.end()) return -1;
+  return _o_it -> second * int(m_dest_node_ID.size()) + _d_it -> second;
+}
+
+int MNM_Path_Table::get_path_index(TInt path_ID)
+{
+  auto _it = m_path_index.find(path_ID);
+  if (_it == m_path_index.end()) return -1;
+  return _it -> second;
+}
+
+int MNM_Path_Table::get_node_vec(int path_index, PNEGraph &graph, std::vector<TInt> &node_vec)
+{
+  node_vec.clear();
+  if (m_link_offset[path_index] == m_link_offset[path_index + 1]) return 0;
+  node_vec.push_back(graph -> GetEI(m_link[m_link_offset[path_index]]).GetSrcNId());
+  for (int j = m_link_offset[path_index]; j < m_link_offset[path_index + 1]; ++j){
+    node_vec.push_back(graph -> GetEI(m_link[j]).GetDstNId());
+  }
+  return 0;
+}
+
+int MNM_Path_Table::copy_buffer_to_p(TInt col)
+{
+  IAssert(col >= 0 && col < m_buffer_length);
+  for (int i = 0; i < m_num_path; ++i){
+    m_path[i] -> m_p = m_buffer[size_t(i) * m_buffer_length + col];
+  }
+  return 0;
+}
+
+int MNM_Path_Table::copy_p_to_buffer(TInt col)
+{
+  IAssert(col >= 0 && col < m_buffer_length);
+  for (int i = 0; i < m_num_path; ++i){
+    m_buffer[size_t(i) * m_buffer_length + col] = m_path[i] -> m_p;
+  }
+  return 0;
+}
+
+// same as MNM_Pathset::normalize_p on every OD range
+int MNM_Path_Table::normalize_p()
+{
+  TFlt _tot_p;
+  for (size_t k = 0; k + 1 < m_od_offset.size(); ++k){
+    if (m_od_offset[k] == m_od_offset[k + 1]) continue;
+    _tot_p = TFlt(0);
+    for (int i = m_od_offset[k]; i < m_od_offset[k + 1]; ++i){
+      if (m_path[i] -> m_p < 0){
+        printf("Negative probability, impossible!\n");
+        exit(-1);
+      }
+      _tot_p += m_path[i] -> m_p;
+    }
+    for (int i = m_od_offset[k]; i < m_od_offset[k + 1]; ++i){
+      if (_tot_p == TFlt(0)){
+        m_path[i] -> m_p = TFlt(1) / TFlt(m_od_offset[k + 1] - m_od_offset[k]);
+      }
+      else{
+        m_path[i] -> m_p = (m_path[i] -> m_p) / _tot_p;
+      }
+    }
+  }
+  return 0;
+}
+
+/**************************************************************************
+                        Path travel time trie
+**************************************************************************/
+MNM_Path_TT_Trie::MNM_Path_TT_Trie(std::vector<MNM_Path*> &path_vec, std::unordered_map<TInt, TInt> &link_index)
+{
+  m_parent = std::vector<int>(1, -1);
+  m_link = std::vector<int>(1, -1);
+  m_path_node = std::vector<int>();
+  std::vector<std::unordered_map<int, int>> _children = std::vector<std::unordered_map<int, int>>(1);
+  int _node, _link;
+  for (MNM_Path *_path : path_vec){
+    _node = 0;
+    for (TInt _link_ID : _path -> m_link_vec){
+      auto _index_it = link_index.find(_link_ID);
+      if (_index_it == link_index.end()){
+        throw std::runtime_error("Error, MNM_Path_TT_Trie::MNM_Path_TT_Trie, link not in tt matrix");
+      }
+      _link = _index_it -> second;
+      auto _child_it = _children[_node].find(_link);
+      if (_child_it == _children[_node].end()){
+        m_parent.push_back(_node);
+        m_link.push_back(_link);
+        _children.push_back(std::unordered_map<int, int>());
+        _children[_node].insert(std::pair<int, int>(_link, int(m_parent.size()) - 1));
+        _node = int(m_parent.size()) - 1;
+      }
+      else{
+        _node = _child_it -> second;
+      }
+    }
+    m_path_node.push_back(_node);
+  }
+}
+
+
+MNM_Path_TT_Trie::~MNM_Path_TT_Trie()
+{
+  m_parent.clear();
+  m_link.clear();
+  m_path_node.clear();
+}
+
+
+int MNM_Path_TT_Trie::get_path_tt(double *tt, int num_interval, double *depart_time, int num_depart, double *result)
+{
+  int _num_path = m_path_node.size();
+  int _num_node = m_parent.size();
+  #pragma omp parallel for schedule(static)
+  for (int d = 0; d < num_depart; ++d){
+    // same clock as MNM_Due::get_tt, each link is entered at the arrival time of its parent
+    std::vector<double> _arrival(_num_node);
+    int _query_time;
+    _arrival[0] = depart_time[d];
+    for (int n = 1; n < _num_node; ++n){
+      _query_time = std::min(std::max(int(_arrival[m_parent[n]]), 0), num_interval - 1);
+      _arrival[n] = _arrival[m_parent[n]] + tt[m_link[n] * num_interval + _query_time];
+    }
+    for (int i = 0; i < _num_path; ++i){
+      result[i * num_depart + d] = _arrival[m_path_node[i]] - depart_time[d];
+    }
+  }
+  return 0;
+}
+
 
 namespace MNM{
 
@@ -160,7 +427,30 @@ MNM_Path *extract_path(TInt origin_ID, TInt dest_ID, std::unordered_map<TInt, TI
 }
 
 
-Path_Table *build_shortest_pathset(PNEGraph &graph, MNM_OD_Factory *od_factory, MNM_Link_Factory *link_factory){
+MNM_Path *extract_path(int origin_index, int dest_index, const int *pred, const MNM_Graph_CSR *csr)
+{
+  int _current_node = origin_index;
+  int _current_link;
+  MNM_Path *_path = new MNM_Path();
+  while(_current_node != dest_index){
+    _current_link = pred[_current_node];
+    if (_current_link == -1){
+      delete _path;
+      return NULL;
+    }
+    _path -> m_node_vec.push_back(csr -> m_node_ID[_current_node]);
+    _path -> m_link_vec.push_back(csr -> m_link_ID[_current_link]);
+    _current_node = csr -> m_link_to[_current_link];
+  }
+  _path -> m_node_vec.push_back(csr -> m_node_ID[_current_node]);
+  return _path;
+}
+
+// empty path sets for all OD pairs, pathset_vec[d * num_origin + o] in the iteration order of the factory
+static Path_Table *build_empty_path_table(MNM_OD_Factory *od_factory, const MNM_Graph_CSR *csr,
+                                          std::vector<int> &origin_index, std::vector<int> &dest_index,
+                                          std::vector<MNM_Pathset*> &pathset_vec)
+{
   Path_Table *_path_table = new Path_Table();
   for (auto _o_it = od_factory -> m_origin_map.begin(); _o_it != od_factory -> m_origin_map.end(); _o_it++){
     std::unordered_map<TInt, MNM_Pathset*> *_new_map = new std::unordered_map<TInt, MNM_Pathset*>();
@@ -170,27 +460,86 @@ Path_Table *build_shortest_pathset(PNEGraph &graph, MNM_OD_Factory *od_factory,
       _new_map -> insert(std::pair<TInt, MNM_Pathset*>(_d_it -> second -> m_dest_node -> m_node_ID, _pathset));
     }
   }
-  TInt _dest_node_ID, _origin_node_ID;
+  origin_index.clear();
+  dest_index.clear();
+  pathset_vec.clear();
+  for (auto _o_it = od_factory -> m_origin_map.begin(); _o_it != od_factory -> m_origin_map.end(); _o_it++){
+    origin_index.push_back(csr -> m_node_index.find(_o_it -> second -> m_origin_node -> m_node_ID) -> second);
+  }
+  for (auto _d_it = od_factory -> m_destination_map.begin(); _d_it != od_factory -> m_destination_map.end(); _d_it++){
+    dest_index.push_back(csr -> m_node_index.find(_d_it -> second -> m_dest_node -> m_node_ID) -> second);
+    for (auto _o_it = od_factory -> m_origin_map.begin(); _o_it != od_factory -> m_origin_map.end(); _o_it++){
+      pathset_vec.push_back(_path_table -> find(_o_it -> second -> m_origin_node -> m_node_ID) -> second 
+                              -> find(_d_it -> second -> m_dest_node -> m_node_ID) -> second);
+    }
+  }
+  return _path_table;
+}
+
+static std::vector<double> get_free_cost(MNM_Link_Factory *link_factory, MNM_Graph_CSR *csr)
+{
   std::unordered_map<TInt, TFlt> _free_cost_map =  std::unordered_map<TInt, TFlt>();
-  std::unordered_map<TInt, TInt> _free_shortest_path_tree;
-  MNM_Path *_path;
   for (auto _link_it = link_factory -> m_link_map.begin(); _link_it!= link_factory -> m_link_map.end(); _link_it++){
     _free_cost_map.insert(std::pair<TInt, TFlt>(_link_it -> first, _link_it -> second -> get_link_tt()));
   }
-  for (auto _d_it = od_factory -> m_destination_map.begin(); _d_it != od_factory -> m_destination_map.end(); _d_it++){
-    _dest_node_ID = _d_it -> second -> m_dest_node -> m_node_ID;
-    MNM_Shortest_Path::all_to_one_FIFO(_dest_node_ID, graph, _free_cost_map, _free_shortest_path_tree);
-    for (auto _o_it = od_factory -> m_origin_map.begin(); _o_it != od_factory -> m_origin_map.end(); _o_it++){
-      _origin_node_ID = _o_it -> second -> m_origin_node -> m_node_ID;
-      _path = MNM::extract_path(_origin_node_ID, _dest_node_ID, _free_shortest_path_tree, graph);
-      if (_path != NULL){
-        // printf("Adding to path table\n");
-        // std::cout << _path -> node_vec_to_string();
-        // std::cout << _path -> link_vec_to_string();
-        _path_table -> find(_origin_node_ID) -> second -> find(_dest_node_ID) -> second -> m_path_vec.push_back(_path);
+  std::vector<double> _cost = std::vector<double>(csr -> m_num_link);
+  csr -> build_cost_array(_free_cost_map, _cost.data());
+  return _cost;
+}
+
+// one shortest path per OD pair on cost, the hierarchy is customized and the destinations are scanned once,
+// then every origin task only fills the path sets of its own origin, so the table does not depend on
+// the number of threads
+static int add_cch_paths(MNM_CCH *cch, const double *cost, std::vector<int> &origin_index, 
+                         std::vector<int> &dest_index, std::vector<MNM_Pathset*> &pathset_vec)
+{
+  const MNM_Graph_CSR *_csr = cch -> m_csr;
+  int _num_origin = int(origin_index.size());
+  int _num_dest = int(dest_index.size());
+  cch -> customize(cost);
+  cch -> set_targets(dest_index);
+
+  #pragma omp parallel
+  {
+    // per thread scratch
+    std::vector<double> _dist = std::vector<double>(_num_dest);
+    std::vector<std::vector<int>> _path_link = std::vector<std::vector<int>>();
+    MNM_Path *_path;
+    MNM_Pathset *_pathset;
+    #pragma omp for schedule(dynamic)
+    for (int o = 0; o < _num_origin; ++o){
+      cch -> get_paths_from(origin_index[o], _dist.data(), _path_link);
+      for (int d = 0; d < _num_dest; ++d){
+        if (_dist[d] == std::numeric_limits<double>::max()) continue;
+        _path = new MNM_Path();
+        _path -> m_node_vec.push_back(_csr -> m_node_ID[origin_index[o]]);
+        for (int _link : _path_link[d]){
+          _path -> m_link_vec.push_back(_csr -> m_link_ID[_link]);
+          _path -> m_node_vec.push_back(_csr -> m_node_ID[_csr -> m_link_to[_link]]);
+        }
+        _pathset = pathset_vec[d * _num_origin + o];
+        if (_pathset -> is_in(_path)){
+          delete _path;
+        }
+        else{
+          _pathset -> m_path_vec.push_back(_path);
+        }
       }
     }
   }
+  return 0;
+}
+
+Path_Table *build_shortest_pathset(PNEGraph &graph, MNM_OD_Factory *od_factory, MNM_Link_Factory *link_factory){
+  MNM_Graph_CSR *_csr = new MNM_Graph_CSR(graph);
+  std::vector<int> _origin_index, _dest_index;
+  std::vector<MNM_Pathset*> _pathset_vec;
+  Path_Table *_path_table = build_empty_path_table(od_factory, _csr, _origin_index, _dest_index, _pathset_vec);
+  std::vector<double> _free_cost = get_free_cost(link_factory, _csr);
+  MNM_CCH *_cch = new MNM_CCH(_csr);
+  add_cch_paths(_cch, _free_cost.data(), _origin_index, _dest_index, _pathset_vec);
+  delete _cch;
+  delete _csr;
   return _path_table;
 }
 
@@ -201,94 +550,73 @@ Path_Table *build_pathset(PNEGraph &graph, MNM_OD_Factory *od_factory, MNM_Link_
   size_t MaxIter = 10;
   TFlt Mid_Scale = 3;
   TFlt Heavy_Scale = 6;
-  // printf("11\n");
   /* initialize data structure */
-  Path_Table *_path_table = new Path_Table();
-  for (auto _o_it = od_factory -> m_origin_map.begin(); _o_it != od_factory -> m_origin_map.end(); _o_it++){
-    std::unordered_map<TInt, MNM_Pathset*> *_new_map = new std::unordered_map<TInt, MNM_Pathset*>();
-    _path_table -> insert(std::pair<TInt, std::unordered_map<TInt, MNM_Pathset*>*>(_o_it -> second -> m_origin_node -> m_node_ID, _new_map));
-    for (auto _d_it = od_factory -> m_destination_map.begin(); _d_it != od_factory -> m_destination_map.end(); _d_it++){
-      MNM_Pathset *_pathset = new MNM_Pathset();
-      _new_map -> insert(std::pair<TInt, MNM_Pathset*>(_d_it -> second -> m_dest_node -> m_node_ID, _pathset));
-    }
-  }
-
-  // printf("111\n");
-  std::unordered_map<TInt, TInt> _mid_shortest_path_tree = std::unordered_map<TInt, TInt>();
-  std::unordered_map<TInt, TInt> _heavy_shortest_path_tree = std::unordered_map<TInt, TInt>();
-  std::unordered_map<TInt, TFlt> _heavy_cost_map = std::unordered_map<TInt, TFlt>();
-  std::unordered_map<TInt, TFlt> _mid_cost_map = std::unordered_map<TInt, TFlt>();
-
-  TInt _dest_node_ID, _origin_node_ID;
-  std::unordered_map<TInt, TFlt> _free_cost_map =  std::unordered_map<TInt, TFlt>();
-  std::unordered_map<TInt, TInt> _free_shortest_path_tree;
-  MNM_Path *_path;
-  for (auto _link_it = link_factory -> m_link_map.begin(); _link_it!= link_factory -> m_link_map.end(); _link_it++){
-    _free_cost_map.insert(std::pair<TInt, TFlt>(_link_it -> first, _link_it -> second -> get_link_tt()));
-  }
-  // printf("1111\n");
-  for (auto _d_it = od_factory -> m_destination_map.begin(); _d_it != od_factory -> m_destination_map.end(); _d_it++){
-    _dest_node_ID = _d_it -> second -> m_dest_node -> m_node_ID;
-    MNM_Shortest_Path::all_to_one_FIFO(_dest_node_ID, graph, _free_cost_map, _free_shortest_path_tree);
-    for (auto _o_it = od_factory -> m_origin_map.begin(); _o_it != od_factory -> m_origin_map.end(); _o_it++){
-      _origin_node_ID = _o_it -> second -> m_origin_node -> m_node_ID;
-      _path = MNM::extract_path(_origin_node_ID, _dest_node_ID, _free_shortest_path_tree, graph);
-      if (_path != NULL){
-        _path_table -> find(_origin_node_ID) -> second -> find(_dest_node_ID) -> second -> m_path_vec.push_back(_path);
-      }
-    }
-  }
-  // printf("22\n");
-  _mid_cost_map.insert(_free_cost_map.begin(), _free_cost_map.end());
-  _heavy_cost_map.insert(_free_cost_map.begin(), _free_cost_map.end());
-
-  MNM_Dlink *_link;
+  MNM_Graph_CSR *_csr = new MNM_Graph_CSR(graph);
+  std::vector<int> _origin_index, _dest_index;
+  std::vector<MNM_Pathset*> _pathset_vec;
+  Path_Table *_path_table = build_empty_path_table(od_factory, _csr, _origin_index, _dest_index, _pathset_vec);
+  std::vector<double> _free_cost = get_free_cost(link_factory, _csr);
+  std::vector<double> _mid_cost = _free_cost;
+  std::vector<double> _heavy_cost = _free_cost;
+  // the contraction order does not depend on the cost, every round only re-customizes it
+  MNM_CCH *_cch = new MNM_CCH(_csr);
+  add_cch_paths(_cch, _free_cost.data(), _origin_index, _dest_index, _pathset_vec);
+
+  int _link;
+  // the penalty does not add up, so only the paths found in the last round need to be visited
+  std::vector<size_t> _num_penalized = std::vector<size_t>(_pathset_vec.size(), 0);
   size_t _CurIter = 0;
   while (_CurIter < MaxIter){
     printf("Current interval %d\n", (int) _CurIter);
-    for (auto _d_it = od_factory -> m_destination_map.begin(); _d_it != od_factory -> m_destination_map.end(); _d_it++){
-      _dest_node_ID = _d_it -> second -> m_dest_node -> m_node_ID;
-      MNM_Shortest_Path::all_to_one_FIFO(_dest_node_ID, graph, _free_cost_map, _free_shortest_path_tree);
-      for (auto _o_it = od_factory -> m_origin_map.begin(); _o_it != od_factory -> m_origin_map.end(); _o_it++){
-        _origin_node_ID = _o_it -> second -> m_origin_node -> m_node_ID;
-        for (auto &_path : _path_table -> find(_origin_node_ID) -> second -> find(_dest_node_ID) -> second -> m_path_vec){
-          for (auto &_link_ID : _path -> m_link_vec){
-            _link = link_factory -> get_link(_link_ID);
-            _mid_cost_map.find(_link -> m_link_ID) -> second = _link -> get_link_tt() * Mid_Scale;
-            _heavy_cost_map.find(_link -> m_link_ID) -> second = _link -> get_link_tt() * Heavy_Scale;
-          }
-        }
-      }
-    }
-    MNM_Path *_path_mid, *_path_heavy;
-    for (auto _d_it = od_factory -> m_destination_map.begin(); _d_it != od_factory -> m_destination_map.end(); _d_it++){
-      _dest_node_ID = _d_it -> second -> m_dest_node -> m_node_ID;
-      MNM_Shortest_Path::all_to_one_FIFO(_dest_node_ID, graph, _mid_cost_map, _mid_shortest_path_tree);
-      MNM_Shortest_Path::all_to_one_FIFO(_dest_node_ID, graph, _heavy_cost_map, _heavy_shortest_path_tree);
-      for (auto _o_it = od_factory -> m_origin_map.begin(); _o_it != od_factory -> m_origin_map.end(); _o_it++){
-        _origin_node_ID = _o_it -> second -> m_origin_node -> m_node_ID;
-        _path_mid = MNM::extract_path(_origin_node_ID, _dest_node_ID, _mid_shortest_path_tree, graph);
-        _path_heavy = MNM::extract_path(_origin_node_ID, _dest_node_ID, _heavy_shortest_path_tree, graph);
-        if (_path_mid != NULL){
-          if (! _path_table -> find(_origin_node_ID) -> second -> find(_dest_node_ID) -> second -> is_in(_path_mid)){
-            _path_table -> find(_origin_node_ID) -> second -> find(_dest_node_ID) -> second -> m_path_vec.push_back(_path_mid);
-          }
-        }
-        if (_path_heavy != NULL){
-          if (! _path_table -> find(_origin_node_ID) -> second -> find(_dest_node_ID) -> second -> is_in(_path_heavy)){
-            _path_table -> find(_origin_node_ID) -> second -> find(_dest_node_ID) -> second -> m_path_vec.push_back(_path_heavy);
-          }
+    // penalize every link used by a path found so far
+    for (size_t k = 0; k < _pathset_vec.size(); ++k){
+      std::vector<MNM_Path*> &_path_vec = _pathset_vec[k] -> m_path_vec;
+      for (size_t i = _num_penalized[k]; i < _path_vec.size(); ++i){
+        for (TInt _link_ID : _path_vec[i] -> m_link_vec){
+          _link = _csr -> m_link_index.find(_link_ID) -> second;
+          _mid_cost[_link] = _free_cost[_link] * Mid_Scale;
+          _heavy_cost[_link] = _free_cost[_link] * Heavy_Scale;
         }
       }
+      _num_penalized[k] = _path_vec.size();
     }
+    add_cch_paths(_cch, _mid_cost.data(), _origin_index, _dest_index, _pathset_vec);
+    add_cch_paths(_cch, _heavy_cost.data(), _origin_index, _dest_index, _pathset_vec);
     _CurIter += 1;
   }
+  delete _cch;
+  delete _csr;
   return _path_table;
 }
 
+Path_Table *build_pathset_ksp(PNEGraph &graph, MNM_OD_Factory *od_factory, MNM_Link_Factory *link_factory, 
+                              TInt num_path)
+{
+  MNM_Graph_CSR *_csr = new MNM_Graph_CSR(graph);
+  std::vector<int> _origin_index, _dest_index;
+  std::vector<MNM_Pathset*> _pathset_vec;
+  Path_Table *_path_table = build_empty_path_table(od_factory, _csr, _origin_index, _dest_index, _pathset_vec);
+  std::vector<double> _cost = get_free_cost(link_factory, _csr);
+  int _num_origin = int(_origin_index.size());
+  int _num_dest = int(_dest_index.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int d = 0; d < _num_dest; ++d){
+    MNM_KSP_Tree *_ksp_tree = new MNM_KSP_Tree(_csr -> m_node_ID[_dest_index[d]], _csr);
+    _ksp_tree -> initialize();
+    _ksp_tree -> update_tree(_cost.data());
+    for (int o = 0; o < _num_origin; ++o){
+      _ksp_tree -> get_ksp(_csr -> m_node_ID[_origin_index[o]], num_path, _pathset_vec[d * _num_origin + o]);
+    }
+    delete _ksp_tree;
+  }
+  delete _csr;
+  return _path_table;
+}
 
-int save_path_table(Path_Table *path_table, MNM_OD_Factory *od_factory, bool w_buffer)
+int save_path_table(Path_Table *path_table, MNM_OD_Factory *od_factory, bool w_buffer, bool w_binary)
 {
+  std::vector<MNM_Path*> _path_vec;
   std::string _file_name = "path_table";
   std::ofstream _path_buffer_file;
   if (w_buffer){
@@ -321,6 +649,7 @@ int save_path_table(Path_Table *path_table, MNM_OD_Factory *od_factory, bool w_b
         if (w_buffer){
           _path_buffer_file << _path -> buffer_to_string();
         }
+        _path_vec.push_back(_path);
       }
     }
   }
@@ -328,6 +657,70 @@ int save_path_table(Path_Table *path_table, MNM_OD_Factory *od_factory, bool w_b
   if (w_buffer){
     _path_buffer_file.close();
   }
+  if (w_binary){
+    save_path_table_binary(_file_name + ".bin", _path_vec, w_buffer ? 8 : 0);
+  }
+  return 0;
+}
+
+int save_path_table_binary(std::string file_name, std::vector<MNM_Path*> &path_vec, int value_size)
+{
+  if (value_size != 0 && value_size != 4 && value_size != 8){
+    printf("MNM::save_path_table_binary, value size %d not supported\n", value_size);
+    exit(-1);
+  }
+  MNM_Path_Table_Bin_Header _header;
+  memcpy(_header.m_magic, MNM_PATH_TABLE_BIN_MAGIC, 8);
+  _header.m_num_path = int32_t(path_vec.size());
+  _header.m_buffer_length = 0;
+  _header.m_value_size = value_size;
+  std::vector<int32_t> _link_offset = std::vector<int32_t>(1, 0);
+  std::vector<int32_t> _link, _node;
+  for (MNM_Path *_path : path_vec){
+    for (TInt _link_ID : _path -> m_link_vec) _link.push_back(_link_ID());
+    for (TInt _node_ID : _path -> m_node_vec) _node.push_back(_node_ID());
+    if (_path -> m_node_vec.size() != _path -> m_link_vec.size() + 1){
+      printf("MNM::save_path_table_binary, path %d has %d links and %d nodes\n", _path -> m_path_ID(), 
+             int(_path -> m_link_vec.size()), int(_path -> m_node_vec.size()));
+      exit(-1);
+    }
+    _link_offset.push_back(int32_t(_link.size()));
+    if (_path -> m_buffer_length > _header.m_buffer_length) _header.m_buffer_length = _path -> m_buffer_length();
+  }
+  _header.m_num_link = int32_t(_link.size());
+  if (value_size == 0) _header.m_buffer_length = 0;
+
+  std::ofstream _file;
+  _file.open(file_name, std::ofstream::out | std::ofstream::binary);
+  if (!_file.is_open()){
+    printf("MNM::save_path_table_binary, can not open %s\n", file_name.c_str());
+    exit(-1);
+  }
+  _file.write((const char*) &_header, sizeof(_header));
+  _file.write((const char*) _link_offset.data(), _link_offset.size() * sizeof(int32_t));
+  _file.write((const char*) _link.data(), _link.size() * sizeof(int32_t));
+  _file.write((const char*) _node.data(), _node.size() * sizeof(int32_t));
+  size_t _size = sizeof(_header) + (_link_offset.size() + _link.size() + _node.size()) * sizeof(int32_t);
+  const char _pad[8] = {0};
+  _file.write(_pad, (8 - _size % 8) % 8);
+  if (_header.m_buffer_length > 0){
+    // shorter buffers are padded with 0 as in MNM_Path_Table::compact
+    std::vector<float> _row_f = std::vector<float>(_header.m_buffer_length);
+    std::vector<double> _row_d = std::vector<double>(_header.m_buffer_length);
+    for (MNM_Path *_path : path_vec){
+      for (int j = 0; j < _header.m_buffer_length; ++j){
+        _row_d[j] = (j < _path -> m_buffer_length) ? _path -> m_buffer[j]() : 0.;
+        _row_f[j] = float(_row_d[j]);
+      }
+      if (value_size == 4){
+        _file.write((const char*) _row_f.data(), _row_f.size() * sizeof(float));
+      }
+      else{
+        _file.write((const char*) _row_d.data(), _row_d.size() * sizeof(double));
+      }
+    }
+  }
+  _file.close();
   return 0;
 }
 
@@ -387,20 +780,27 @@ int print_path_table(Path_Table *path_table, MNM_OD_Factory *od_factory, bool w_
 //   return 0;
 // }
 
+// the buffers are the rows of one matrix of the compacted table
 int allocate_path_table_buffer(Path_Table *path_table, TInt num)
 {
   for(auto _it : *path_table){
     for (auto _it_it : *(_it.second)){
       for (MNM_Path* _path : _it_it.second -> m_path_vec){
-        _path -> allocate_buffer(num);
+        if ((_path -> m_buffer_length > 0) || (_path -> m_buffer != NULL)){
+          throw std::runtime_error("Error: MNM::allocate_path_table_buffer, double allocation.");
+        }
       }
     }
-  }  
+  }
+  path_table -> compact(num);
   return 0;
 }
 
 int normalize_path_table_p(Path_Table *path_table)
 {
+  if (path_table -> is_compact()){
+    return path_table -> normalize_p();
+  }
   for(auto _it : *path_table){
     for (auto _it_it : *(_it.second)){
       _it_it.second -> normalize_p();
@@ -411,6 +811,9 @@ int normalize_path_table_p(Path_Table *path_table)
 
 int copy_p_to_buffer(Path_Table *path_table, TInt col)
 {
+  if (path_table -> is_compact()){
+    return path_table -> copy_p_to_buffer(col);
+  }
   for(auto _it : *path_table){
     for (auto _it_it : *(_it.second)){
       for (MNM_Path* _path : _it_it.second -> m_path_vec){
@@ -426,6 +829,9 @@ int copy_buffer_to_p(Path_Table *path_table, TInt col)
   // printf("Entering MNM::copy_buffer_to_p\n");
   // printf("path table is %p\n", path_table);
   IAssert(col >= 0); 
+  if (path_table -> is_compact()){
+    return path_table -> copy_buffer_to_p(col);
+  }
   for(auto _it : *path_table){
     for (auto _it_it : *(_it.second)){
       for (MNM_Path* _path : _it_it.second -> m_path_vec){
@@ -440,6 +846,12 @@ int copy_buffer_to_p(Path_Table *path_table, TInt col)
 
 int get_ID_path_mapping(std::unordered_map<TInt, MNM_Path*> &dict, Path_Table *path_table)
 {
+  if (path_table -> is_compact()){
+    for (MNM_Path *_path : path_table -> m_path){
+      dict[_path -> m_path_ID] = _path;
+    }
+    return 0;
+  }
   for(auto _it : *path_table){
     for (auto _it_it : *(_it.second)){
       for (MNM_Path* _path : _it_it.second -> m_path_vec){
@@ -464,5 +876,31 @@ MNM_Pathset* get_pathset(Path_Table *path_table, TInt origin_node_ID, TInt dest_
   return iterer -> second;
 }
 
+bool has_path_table_buffer(Path_Table *path_table)
+{
+  for (auto _it : *path_table){
+    for (auto _it_it : *(_it.second)){
+      for (MNM_Path* _path : _it_it.second -> m_path_vec){
+        if (_path -> m_buffer == NULL || _path -> m_buffer_length <= 0) return false;
+      }
+    }
+  }
+  return true;
+}
+
+int delete_path_table(Path_Table *path_table)
+{
+  for (auto _it : *path_table){
+    for (auto _it_it : *(_it.second)){
+      delete _it_it.second;
+    }
+    _it.second -> clear();
+    delete _it.second;
+  }
+  path_table -> clear();
+  delete path_table;
+  return 0;
+}
+
 }//end namespace MNM
 
@@ -11,6 +11,7 @@
 #include <unordered_map>
 #include <fstream>
 #include <string>
+#include <cstdint>
 
 class MNM_Path
 {
@@ -20,13 +21,17 @@ public:
   std::string node_vec_to_string();
   std::string link_vec_to_string();
   std::string buffer_to_string();
-  std::deque<TInt> m_link_vec;
-  std::deque<TInt> m_node_vec;
+  std::vector<TInt> m_link_vec;
+  std::vector<TInt> m_node_vec;
   TInt m_path_ID;
   TFlt m_p;
   TFlt *m_buffer;
   TInt m_buffer_length;
+  // false when m_buffer is a row of the buffer matrix of a compacted path table
+  bool m_own_buffer;
   int allocate_buffer(TInt length);
+  // hash of the link sequence, equal paths have equal hashes
+  size_t get_link_hash();
   inline bool operator==(const MNM_Path& rhs)
   {if (m_link_vec.size() != rhs.m_link_vec.size()) return false; 
   for (size_t i=0; i<rhs.m_link_vec.size(); ++i){if (rhs.m_link_vec[i] != m_link_vec[i]) return false;} return true;}
@@ -47,15 +52,110 @@ public:
   ~MNM_Pathset();
   std::vector<MNM_Path*> m_path_vec;
   int normalize_p();
+  // O(1) on average, paths pushed to m_path_vec since the last call are hashed first
   bool is_in(MNM_Path* path);
+  // link hash -> position in m_path_vec of the first m_num_hashed paths
+  std::unordered_multimap<size_t, int> m_hash_index;
+  size_t m_num_hashed;
 };
 
-typedef std::unordered_map<TInt, std::unordered_map<TInt, MNM_Pathset*>*> Path_Table;
+/**************************************************************************
+                            Path Table
+**************************************************************************/
+// origin node ID -> dest node ID -> pathset, the pathsets are owned by whoever owns the table.
+// compact() adds a columnar copy for the loops over all paths: the paths in OD order with dense
+// OD -> path range offsets, one CSR array of their link IDs and one paths x intervals buffer
+// matrix, the m_buffer of every path becomes its row in the matrix.
+// compact() has to be called again after paths are added to the pathsets
+class MNM_Path_Table : public std::unordered_map<TInt, std::unordered_map<TInt, MNM_Pathset*>*>
+{
+public:
+  MNM_Path_Table();
+  ~MNM_Path_Table();
+  // buffer_length -1 keeps the longest buffer of the paths, the buffer values are kept
+  int compact(TInt buffer_length = -1);
+  bool is_compact(){return m_od_offset.size() > 0;};
+  // -1 if the OD pair is not in the table
+  int get_od_index(TInt origin_node_ID, TInt dest_node_ID);
+  // -1 if no path has this ID
+  int get_path_index(TInt path_ID);
+  // the node sequence of a path from its links
+  int get_node_vec(int path_index, PNEGraph &graph, std::vector<TInt> &node_vec);
+  int copy_buffer_to_p(TInt col);
+  int copy_p_to_buffer(TInt col);
+  int normalize_p();
+
+  int m_num_path;
+  // od index = origin index * number of destinations + dest index
+  std::vector<TInt> m_origin_node_ID;
+  std::vector<TInt> m_dest_node_ID;
+  std::unordered_map<TInt, int> m_origin_index;
+  std::unordered_map<TInt, int> m_dest_index;
+  // the paths of od index k are m_path[m_od_offset[k] .. m_od_offset[k+1])
+  std::vector<int> m_od_offset;
+  std::vector<MNM_Path*> m_path;
+  // links of path i are m_link[m_link_offset[i] .. m_link_offset[i+1])
+  std::vector<int> m_link_offset;
+  std::vector<TInt> m_link;
+  // path i has buffer m_buffer[i * m_buffer_length .. (i+1) * m_buffer_length)
+  TInt m_buffer_length;
+  std::vector<TFlt> m_buffer;
+  std::unordered_map<TInt, int> m_path_index;
+};
+
+typedef MNM_Path_Table Path_Table;
+
+/**************************************************************************
+                        Path travel time trie
+**************************************************************************/
+// evaluates the travel time of many paths on a link x interval tt matrix at once,
+// paths sharing a prefix of links share the evaluation of that prefix
+class MNM_Path_TT_Trie
+{
+public:
+  MNM_Path_TT_Trie(std::vector<MNM_Path*> &path_vec, std::unordered_map<TInt, TInt> &link_index);
+  ~MNM_Path_TT_Trie();
+  // tt: num_link x num_interval (row major, in intervals), result: num_path x num_depart
+  int get_path_tt(double *tt, int num_interval, double *depart_time, int num_depart, double *result);
+  // trie nodes are stored parent first, node 0 is the root
+  std::vector<int> m_parent;
+  std::vector<int> m_link;
+  std::vector<int> m_path_node;
+};
+
+/**************************************************************************
+                        Binary path table
+**************************************************************************/
+// the header, int32 link offsets (num_path + 1), int32 link IDs, int32 node IDs (the nodes of
+// path i start at link_offset[i] + i, one more than its links), zero padding to 8 bytes and the
+// num_path x buffer_length buffer matrix in float32 or float64, all in native byte order.
+// the paths are stored in path ID order, the text path_table line order
+#define MNM_PATH_TABLE_BIN_MAGIC "MNMPTB01"
+
+struct MNM_Path_Table_Bin_Header
+{
+  char m_magic[8];
+  int32_t m_num_path;
+  int32_t m_num_link;
+  int32_t m_buffer_length;
+  // bytes per buffer value, 4 or 8, 0 without buffer
+  int32_t m_value_size;
+};
+
+class MNM_Graph_CSR;
 
 namespace MNM {
   MNM_Path *extract_path(TInt origin_ID, TInt dest_ID, std::map<TInt, TInt> &output_map, PNEGraph &graph);
+  // follows a pred array of the CSR kernels, NULL if the destination is not reachable
+  MNM_Path *extract_path(int origin_index, int dest_index, const int *pred, const MNM_Graph_CSR *csr);
   Path_Table *build_pathset(PNEGraph &graph, MNM_OD_Factory *od_factory, MNM_Link_Factory *link_factory);
-  int save_path_table(Path_Table *path_table, MNM_OD_Factory *m_od_factory, bool w_buffer= false);
+  // the num_path shortest loopless free flow paths of every OD pair (Eppstein), instead of the penalty rounds
+  Path_Table *build_pathset_ksp(PNEGraph &graph, MNM_OD_Factory *od_factory, MNM_Link_Factory *link_factory, 
+                                TInt num_path);
+  // w_binary also writes path_table.bin with the paths in the same order
+  int save_path_table(Path_Table *path_table, MNM_OD_Factory *m_od_factory, bool w_buffer= false, bool w_binary = false);
+  // value_size 4 stores the buffers as float32, 0 leaves them out
+  int save_path_table_binary(std::string file_name, std::vector<MNM_Path*> &path_vec, int value_size = 8);
   int print_path_table(Path_Table *path_table, MNM_OD_Factory *m_od_factory, bool w_buffer= false);
   Path_Table *build_shortest_pathset(PNEGraph &graph, MNM_OD_Factory *od_factory, MNM_Link_Factory *link_factory);
   // int save_path_table_w_buffer(Path_Table *path_table, MNM_OD_Factory *od_factory);
@@ -65,6 +165,10 @@ namespace MNM {
   int copy_buffer_to_p(Path_Table *path_table, TInt col);
   int get_ID_path_mapping(std::unordered_map<TInt, MNM_Path*>& map, Path_Table *path_table);
   MNM_Pathset* get_pathset(Path_Table *path_table, TInt origin_node_ID, TInt dest_node_ID);
+  // true if every path has a buffer
+  bool has_path_table_buffer(Path_Table *path_table);
+  // the pathsets, their paths and the table
+  int delete_path_table(Path_Table *path_table);
 }
 
 
@@ -64,14 +64,10 @@ int MNM_Realtime_Dta::init_running()
     m_link_tt_difference.insert(std::pair<TInt, TFlt>(_link_it.GetId(), 0));
   }
 
-  for(auto _it : *m_path_table){
-    for (auto _it_it : *(_it.second)){
-      for (MNM_Path* _path : _it_it.second -> m_path_vec){
-        memset(_path -> m_buffer, 0x0, sizeof(TFlt) * 4);
-        _path -> m_p = 0;
-      }
-    }
-  } 
+  std::fill(m_path_table -> m_buffer.begin(), m_path_table -> m_buffer.end(), TFlt(0));
+  for (MNM_Path* _path : m_path_table -> m_path){
+    _path -> m_p = 0;
+  }
 
   MNM::normalize_path_table_p(m_path_table);
   return 0;
@@ -193,13 +189,9 @@ int MNM_Realtime_Dta::get_estimation_gradient(MNM_Dta_Screenshot* screenshot,
     // printf("For link ID %d, the tt difference is %.4f\n", (int)_link_ID, (float)m_link_tt_difference.find(_link_ID)->second);
   }
 
-  for(auto _it : *path_table){
-    for (auto _it_it : *(_it.second)){
-      for (MNM_Path* _path : _it_it.second -> m_path_vec){
-        _path -> m_buffer[_grad_position] = 0;
-      }
-    }
-  } 
+  for (int i = 0; i < path_table -> m_num_path; ++i){
+    path_table -> m_buffer[i * path_table -> m_buffer_length + _grad_position] = 0;
+  }
 
   TFlt _tmp_tt;
   TFlt _demand;
@@ -315,13 +307,9 @@ int MNM_Realtime_Dta::get_optimization_gradient(MNM_Dta_Screenshot* screenshot,
     _cur_inter ++;
   }
 
-  for(auto _it : *path_table){
-    for (auto _it_it : *(_it.second)){
-      for (MNM_Path* _path : _it_it.second -> m_path_vec){
-        _path -> m_buffer[_grad_position] = 0;
-      }
-    }
-  } 
+  for (int i = 0; i < path_table -> m_num_path; ++i){
+    path_table -> m_buffer[i * path_table -> m_buffer_length + _grad_position] = 0;
+  }
 
   TFlt _tmp_tt;
   TFlt _demand;
@@ -755,14 +743,12 @@ MNM_Dta_Screenshot *make_screenshot(std::string file_folder, MNM_ConfReader* con
       _new_veh = _new_veh_factory -> make_veh(_veh -> m_start_time, _veh -> m_type);
       copy_veh(_veh, _new_veh, _shot);
       _new_dlink -> m_finished_array.push_back(_new_veh);
-      _shot -> m_routing -> add_veh_path(_new_veh, old_routing -> m_tracker.find(_veh) -> second);
     }
 
     for (MNM_Veh* _veh : _dlink -> m_incoming_array){
       _new_veh = _new_veh_factory -> make_veh(_veh -> m_start_time, _veh -> m_type);
       copy_veh(_veh, _new_veh, _shot);
       _new_dlink -> m_incoming_array.push_back(_new_veh);
-      _shot -> m_routing -> add_veh_path(_new_veh, old_routing -> m_tracker.find(_veh) -> second);
     }
 
     if (MNM_Dlink_Ctm *_ctm = dynamic_cast<MNM_Dlink_Ctm *>(_dlink)){
@@ -775,7 +761,6 @@ MNM_Dta_Screenshot *make_screenshot(std::string file_folder, MNM_ConfReader* con
           _new_veh = _new_veh_factory -> make_veh(_veh -> m_start_time, _veh -> m_type);
           copy_veh(_veh, _new_veh, _shot);
           _new_cell -> m_veh_queue.push_back(_new_veh);
-          _shot -> m_routing -> add_veh_path(_new_veh, old_routing -> m_tracker.find(_veh) -> second);
         }
       }
     }
@@ -786,7 +771,6 @@ MNM_Dta_Screenshot *make_screenshot(std::string file_folder, MNM_ConfReader* con
         _new_veh = _new_veh_factory -> make_veh(_veh -> m_start_time, _veh -> m_type);
         copy_veh(_veh, _new_veh, _shot);
         _new_pq -> m_veh_queue.insert(std::pair<MNM_Veh*, TInt>(_new_veh, _veh_it->second));
-        _shot -> m_routing -> add_veh_path(_new_veh, old_routing -> m_tracker.find(_veh) -> second);
       }
     }
   }
@@ -814,24 +798,22 @@ MNM_Dta_Screenshot *make_empty_screenshot(std::string file_folder, MNM_ConfReade
 int update_path_p(Path_Table *path_table, TInt col, TFlt step_size)
 {
   TFlt Possible_Large = 10000;
-  for(auto _it : *path_table){
-    for (auto _it_it : *(_it.second)){
-      for (MNM_Path* _path : _it_it.second -> m_path_vec){
-        // printf("Before m_p is %lf\n", _path -> m_p);
-        if (_path -> m_buffer[col] > 0){
-          _path -> m_p /= (1 + step_size);
-        }
-        else {
-          _path -> m_p *= (1 + step_size);
-        }
-        // _path -> m_p -= step_size * _path -> buffer[col];
-        // printf("Now m_p is %lf\n", _path -> m_p);
-        _path -> m_p = MNM_Ults::max(_path -> m_p, -Possible_Large);
-        _path -> m_p = MNM_Ults::min(_path -> m_p, Possible_Large);
-      }
-      _it_it.second -> normalize_p();
-    }
-  } 
+  MNM_Path *_path;
+  for (int i = 0; i < path_table -> m_num_path; ++i){
+    _path = path_table -> m_path[i];
+    // printf("Before m_p is %lf\n", _path -> m_p);
+    if (path_table -> m_buffer[i * path_table -> m_buffer_length + col] > 0){
+      _path -> m_p /= (1 + step_size);
+    }
+    else {
+      _path -> m_p *= (1 + step_size);
+    }
+    // _path -> m_p -= step_size * _path -> buffer[col];
+    // printf("Now m_p is %lf\n", _path -> m_p);
+    _path -> m_p = MNM_Ults::max(_path -> m_p, -Possible_Large);
+    _path -> m_p = MNM_Ults::min(_path -> m_p, Possible_Large);
+  }
+  path_table -> normalize_p();
   return 0; 
 }
 
@@ -98,5 +98,7 @@ void static inline copy_veh(MNM_Veh* _veh, MNM_Veh *_new_veh, MNM_Dta_Screenshot
   _new_veh -> m_next_link = _shot -> m_link_factory -> get_link(_veh -> m_next_link -> m_link_ID);
   _new_veh -> set_destination(_shot -> m_od_factory -> get_destination(_veh -> get_destination() -> m_Dest_ID));
   _new_veh -> set_origin(_shot -> m_od_factory -> get_origin(_veh -> get_origin() -> m_Origin_ID));
+  _new_veh -> m_path = _veh -> m_path;
+  _new_veh -> m_path_cursor = _veh -> m_path_cursor;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "record_writer.h"
+
+#include <algorithm>
+
+MNM_Record_Writer::MNM_Record_Writer(std::string file_name, const std::vector<TInt> &column_ID, bool binary,
+                                     int chunk_rows)
+{
+  m_binary = binary;
+  m_num_column = int(column_ID.size());
+  m_chunk_rows = std::max(chunk_rows, 1);
+  m_front = 0;
+  m_num_rows = 0;
+  m_pending = false;
+  m_pending_rows = 0;
+  m_done = false;
+
+  m_file.open(file_name, m_binary ? std::ofstream::out | std::ofstream::binary : std::ofstream::out);
+  if (!m_file.is_open()){
+    printf("MNM_Record_Writer, error happens when open %s\n", file_name.c_str());
+    exit(-1);
+  }
+  if (m_binary){
+    int32_t _num_column = m_num_column;
+    std::vector<int32_t> _ID(m_num_column);
+    for (int i = 0; i < m_num_column; ++i){
+      _ID[i] = column_ID[i];
+    }
+    m_file.write(MNM_RECORD_BIN_MAGIC, 8);
+    m_file.write((const char*) &_num_column, sizeof(int32_t));
+    m_file.write((const char*) _ID.data(), sizeof(int32_t) * m_num_column);
+    m_column_buffer.resize(size_t(m_num_column) * m_chunk_rows);
+  }
+  else{
+    std::string _str;
+    for (int i = 0; i < m_num_column; ++i){
+      _str += std::to_string(column_ID[i]) + " ";
+    }
+    if (!_str.empty()) _str.pop_back();
+    _str += "\n";
+    m_file << _str;
+  }
+  m_buffer[0].resize(size_t(m_num_column) * m_chunk_rows);
+  m_buffer[1].resize(size_t(m_num_column) * m_chunk_rows);
+  m_thread = std::thread(&MNM_Record_Writer::run, this);
+}
+
+MNM_Record_Writer::~MNM_Record_Writer()
+{
+  close();
+}
+
+double *MNM_Record_Writer::new_row()
+{
+  if (m_num_rows == m_chunk_rows){
+    hand_over();
+  }
+  return m_buffer[m_front].data() + size_t(m_num_rows++) * m_num_column;
+}
+
+int MNM_Record_Writer::hand_over()
+{
+  std::unique_lock<std::mutex> _lock(m_mutex);
+  m_cond.wait(_lock, [this]{ return !m_pending; });
+  m_pending = true;
+  m_pending_rows = m_num_rows;
+  m_front = 1 - m_front;
+  m_num_rows = 0;
+  m_cond.notify_all();
+  return 0;
+}
+
+int MNM_Record_Writer::close()
+{
+  if (!m_thread.joinable()) return 0;
+  if (m_num_rows > 0){
+    hand_over();
+  }
+  {
+    std::lock_guard<std::mutex> _lock(m_mutex);
+    m_done = true;
+  }
+  m_cond.notify_all();
+  m_thread.join();
+  m_file.close();
+  return 0;
+}
+
+int MNM_Record_Writer::run()
+{
+  std::unique_lock<std::mutex> _lock(m_mutex);
+  while (true){
+    m_cond.wait(_lock, [this]{ return m_pending || m_done; });
+    if (m_pending){
+      const double *_buffer = m_buffer[1 - m_front].data();
+      int _num_rows = m_pending_rows;
+      _lock.unlock();
+      write_chunk(_buffer, _num_rows);
+      _lock.lock();
+      m_pending = false;
+      m_cond.notify_all();
+    }
+    else{
+      break;
+    }
+  }
+  return 0;
+}
+
+int MNM_Record_Writer::write_chunk(const double *buffer, int num_rows)
+{
+  if (m_binary){
+    // rows to columns
+    for (int j = 0; j < m_num_column; ++j){
+      float *_column = m_column_buffer.data() + size_t(j) * num_rows;
+      for (int i = 0; i < num_rows; ++i){
+        _column[i] = float(buffer[size_t(i) * m_num_column + j]);
+      }
+    }
+    int32_t _num_rows = num_rows;
+    m_file.write((const char*) &_num_rows, sizeof(int32_t));
+    m_file.write((const char*) m_column_buffer.data(), sizeof(float) * size_t(m_num_column) * num_rows);
+  }
+  else{
+    for (int i = 0; i < num_rows; ++i){
+      m_line.clear();
+      for (int j = 0; j < m_num_column; ++j){
+        m_line += std::to_string(buffer[size_t(i) * m_num_column + j]) + " ";
+      }
+      if (!m_line.empty()) m_line.pop_back();
+      m_line += "\n";
+      m_file << m_line;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef RECORD_WRITER_H
+#define RECORD_WRITER_H
+
+#include "Snap.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+
+
+/*------------------------------------------------------------
+                  Per link time series writer
+-------------------------------------------------------------*/
+// The simulation fills one row per tick in the front buffer, a full buffer is swapped with the back
+// buffer and written by a background thread, so formatting and disk IO are off the loading loop.
+// The simulation only waits when the writer is a whole buffer behind.
+// text: the column IDs and then one line per row, as the old MNM_output_* files.
+// binary: MNM_RECORD_BIN_MAGIC, int32 number of columns, int32 column IDs, then chunks of an int32
+// number of rows followed by the float32 values column by column, so every column of a chunk is
+// one contiguous time series.
+#define MNM_RECORD_BIN_MAGIC "MNMREC01"
+
+class MNM_Record_Writer
+{
+public:
+  MNM_Record_Writer(std::string file_name, const std::vector<TInt> &column_ID, bool binary = false,
+                    int chunk_rows = 256);
+  ~MNM_Record_Writer();
+  // the next row to fill, one value per column, valid until the next call
+  double *new_row();
+  // writes the rows left and stops the thread
+  int close();
+  bool is_open(){ return m_file.is_open(); };
+private:
+  int hand_over();
+  int write_chunk(const double *buffer, int num_rows);
+  int run();
+
+  std::ofstream m_file;
+  bool m_binary;
+  int m_num_column;
+  int m_chunk_rows;
+  std::vector<double> m_buffer[2];
+  // m_buffer[m_front] is filled by the simulation, m_num_rows rows so far
+  int m_front;
+  int m_num_rows;
+  // the back buffer has m_pending_rows rows not written yet
+  bool m_pending;
+  int m_pending_rows;
+  bool m_done;
+  std::vector<float> m_column_buffer;
+  std::string m_line;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::thread m_thread;
+};
+
+
+
+#endif
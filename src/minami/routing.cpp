@@ -101,53 +101,158 @@ MNM_Routing_Adaptive::MNM_Routing_Adaptive(std::string file_folder, PNEGraph &gr
   m_statistics = statistics;
   m_self_config = new MNM_ConfReader(file_folder + "/config.conf", "ADAPTIVE");
   m_routing_freq = m_self_config -> get_int("route_frq");
-  m_table = new Routing_Table();
+  m_csr = NULL;
+  m_sp_epsilon = TFlt(double(m_self_config -> m_configFile -> Value("ADAPTIVE", "sp_epsilon", 0.)));
+  m_sp_rebuild_ratio = TFlt(double(m_self_config -> m_configFile -> Value("ADAPTIVE", "sp_rebuild_ratio", 0.2)));
+  m_drop_idle_tree = int(m_self_config -> m_configFile -> Value("ADAPTIVE", "drop_idle_tree", 0.)) == 1;
+  m_refresh = 0;
+  m_refresh_rebuild = true;
 }
 
 MNM_Routing_Adaptive::~MNM_Routing_Adaptive()
 {
-  for (auto _it = m_od_factory -> m_destination_map.begin(); _it != m_od_factory -> m_destination_map.end(); _it++){
-    m_table -> find(_it -> second) -> second -> clear();
-    delete m_table -> find(_it -> second) -> second;
-  }
-  m_table -> clear();
-  delete m_table;
   delete m_self_config;
+  if (m_csr != NULL) delete m_csr;
 }
 
 int MNM_Routing_Adaptive::init_routing(Path_Table *path_table)
 {
-  std::unordered_map<TInt, TInt> *_shortest_path_tree;
+  if (m_csr == NULL){
+    m_csr = new MNM_Graph_CSR(m_graph);
+    m_cost = std::vector<double>(m_csr -> m_num_link);
+    m_new_cost = std::vector<double>(m_csr -> m_num_link);
+    m_old_cost = std::vector<double>(m_csr -> m_num_link);
+    m_link_vec = std::vector<MNM_Dlink*>(m_csr -> m_num_link);
+    for (int e = 0; e < m_csr -> m_num_link; ++e){
+      m_link_vec[e] = m_link_factory -> get_link(m_csr -> m_link_ID[e]);
+    }
+  }
+  m_dest_vec.clear();
+  m_dest_node_index.clear();
   for (auto _it = m_od_factory -> m_destination_map.begin(); _it != m_od_factory -> m_destination_map.end(); _it++){
-    _shortest_path_tree = new std::unordered_map<TInt, TInt>();
-    m_table -> insert(std::pair<MNM_Destination*, std::unordered_map<TInt, TInt>*>(_it -> second, _shortest_path_tree));
-    // for (auto _node_it = m_node_factory -> m_node_map.begin(); _node_it != m_node_factory -> m_node_map.end(); _node_it++){
-    //   _shortest_path_tree -> insert(std::pair<TInt, TInt>(_node_it -> first, -1));
-    // }
+    _it -> second -> m_dest_index = TInt(m_dest_vec.size());
+    m_dest_vec.push_back(_it -> second);
+    m_dest_node_index.push_back(m_csr -> get_node_index(_it -> second -> m_dest_node -> m_node_ID));
   }
+  m_dist = std::vector<std::vector<double>>(m_dest_vec.size());
+  m_pred = std::vector<std::vector<int>>(m_dest_vec.size());
+  m_tree_stamp = std::vector<int>(m_dest_vec.size(), -1);
+  m_dest_used = std::vector<char>(m_dest_vec.size(), 0);
+  m_dest_needed = std::vector<char>(m_dest_vec.size(), 0);
+  m_needed_dest.clear();
+  m_refresh = 0;
+  m_refresh_rebuild = true;
+  return 0;
+}
+
+int MNM_Routing_Adaptive::build_tree(int d)
+{
+  if (m_tree_stamp[d] == m_refresh) return 0;
+  if (m_pred[d].empty()){
+    m_dist[d] = std::vector<double>(m_csr -> m_num_node);
+    m_pred[d] = std::vector<int>(m_csr -> m_num_node, -1);
+  }
+  // a tree from the previous refresh can be repaired from the links changed since then
+  if (m_tree_stamp[d] == m_refresh - 1 && !m_refresh_rebuild){
+    MNM_Shortest_Path::repair_all_to_one_Dijkstra(m_dest_node_index[d], m_csr, m_old_cost.data(), m_cost.data(), 
+                                                  m_changed_link.data(), (int) m_changed_link.size(), 
+                                                  m_dist[d].data(), m_pred[d].data());
+  }
+  else{
+    MNM_Shortest_Path::all_to_one_Dijkstra(m_dest_node_index[d], m_csr, m_cost.data(), m_dist[d].data(), m_pred[d].data());
+  }
+  m_tree_stamp[d] = m_refresh;
   return 0;
 }
 
 
 int MNM_Routing_Adaptive::update_routing(TInt timestamp)
 {
-  MNM_Destination *_dest;
-  TInt _dest_node_ID;
-  std::unordered_map<TInt, TInt> *_shortest_path_tree;
   if ((timestamp) % m_routing_freq  == 0 || timestamp == 0) {
     // printf("Calculating the shortest path trees!\n");
-    for (auto _it = m_od_factory -> m_destination_map.begin(); _it != m_od_factory -> m_destination_map.end(); _it++){
-    // #pragma omp task firstprivate(_it)
-      // {
-        _dest = _it -> second;
-        _dest_node_ID = _dest -> m_dest_node -> m_node_ID;
-        // printf("Destination ID: %d\n", (int) _dest_node_ID);
-        _shortest_path_tree = m_table -> find(_dest) -> second;
-        // MNM_Shortest_Path::all_to_one_FIFO(_dest_node_ID, m_graph, m_statistics -> m_record_interval_tt, *_shortest_path_tree);
-        MNM_Shortest_Path::all_to_one_Dijkstra(_dest_node_ID, m_graph, m_statistics -> m_record_interval_tt, *_shortest_path_tree);
-      // } 
+    if (timestamp == 0 || m_stat_link_index.empty()){
+      m_stat_link_index = std::vector<int>(m_csr -> m_num_link);
+      for (int e = 0; e < m_csr -> m_num_link; ++e){
+        m_stat_link_index[e] = m_statistics -> get_link_index(m_csr -> m_link_ID[e]);
+      }
+    }
+    const double *_tt = m_statistics -> m_record_interval_tt.empty() ? NULL : m_statistics -> m_record_interval_tt.data();
+    for (int e = 0; e < m_csr -> m_num_link; ++e){
+      m_new_cost[e] = (_tt == NULL || m_stat_link_index[e] < 0) ? 0. : _tt[m_stat_link_index[e]];
+    }
+    int _num_dest = (int) m_dest_vec.size();
+    bool _rebuild = timestamp == 0;
+    if (!_rebuild){
+      m_changed_link.clear();
+      for (int e = 0; e < m_csr -> m_num_link; ++e){
+        if (std::abs(m_new_cost[e] - m_cost[e]) > m_sp_epsilon){
+          m_changed_link.push_back(e);
+        }
+      }
+      _rebuild = m_changed_link.size() > m_sp_rebuild_ratio * m_csr -> m_num_link;
+    }
+    if (_rebuild){
+      m_cost = m_new_cost;
+      // the trees do not depend on the heap, so just keep the fastest one for this graph
+      if (timestamp == 0) MNM_Shortest_Path::tune_Dijkstra(m_csr, m_cost.data());
+    }
+    else{
+      // links below epsilon keep the cost their trees were built with
+      for (int _link : m_changed_link){
+        m_old_cost[_link] = m_cost[_link];
+        m_cost[_link] = m_new_cost[_link];
+      }
     }
+    m_refresh += 1;
+    m_refresh_rebuild = _rebuild;
+    for (int d = 0; d < _num_dest; ++d){
+      if (m_drop_idle_tree && !m_dest_used[d] && !m_pred[d].empty()){
+        std::vector<double>().swap(m_dist[d]);
+        std::vector<int>().swap(m_pred[d]);
+        m_tree_stamp[d] = -1;
+      }
+      m_dest_used[d] = 0;
+    }
+  }
+
+  /* find the destinations adaptive vehicles need in this tick */
+  MNM_Destination *_veh_dest;
+  int _d;
+  for (auto _origin_it = m_od_factory->m_origin_map.begin(); _origin_it != m_od_factory->m_origin_map.end(); _origin_it++){
+    for (MNM_Veh *_veh : _origin_it -> second -> m_origin_node -> m_in_veh_queue){
+      if (_veh -> m_type != MNM_TYPE_ADAPTIVE) continue;
+      _d = _veh -> get_destination() -> m_dest_index;
+      m_dest_used[_d] = 1;
+      if (m_tree_stamp[_d] != m_refresh && !m_dest_needed[_d]){
+        m_dest_needed[_d] = 1;
+        m_needed_dest.push_back(_d);
+      }
+    }
+  }
+  for (int e = 0; e < m_csr -> m_num_link; ++e){
+    for (MNM_Veh *_veh : m_link_vec[e] -> m_finished_array){
+      if (_veh -> m_type != MNM_TYPE_ADAPTIVE) continue;
+      _veh_dest = _veh -> get_destination();
+      _d = _veh_dest -> m_dest_index;
+      if (m_dest_node_index[_d] == m_csr -> m_link_to[e]) continue;
+      m_dest_used[_d] = 1;
+      if (m_tree_stamp[_d] != m_refresh && !m_dest_needed[_d]){
+        m_dest_needed[_d] = 1;
+        m_needed_dest.push_back(_d);
+      }
+    }
+  }
+  // each destination writes only its own tree,
+  // the OpenMP threads are kept alive by the runtime between routing intervals
+  int _num_needed = (int) m_needed_dest.size();
+  #pragma omp parallel for schedule(dynamic)
+  for (int k = 0; k < _num_needed; ++k){
+    build_tree(m_needed_dest[k]);
+  }
+  for (int _needed : m_needed_dest){
+    m_dest_needed[_needed] = 0;
   }
+  m_needed_dest.clear();
 
 
   /* route the vehicle in Origin nodes */
@@ -157,34 +262,31 @@ int MNM_Routing_Adaptive::update_routing(TInt timestamp)
   TInt _node_ID, _next_link_ID;
   MNM_Dlink *_next_link;
   MNM_Veh *_veh;
+  int _node_index, _next_link_index;
   for (auto _origin_it = m_od_factory->m_origin_map.begin(); _origin_it != m_od_factory->m_origin_map.end(); _origin_it++){
     _origin = _origin_it -> second;
     _origin_node = _origin -> m_origin_node;
-    _node_ID = _origin_node -> m_node_ID;
+    if (_origin_node -> m_in_veh_queue.empty()) continue;
+    _node_index = m_csr -> get_node_index(_origin_node -> m_node_ID);
     for (auto _veh_it = _origin_node -> m_in_veh_queue.begin(); _veh_it!=_origin_node -> m_in_veh_queue.end(); _veh_it++){
       _veh = *_veh_it;
       if (_veh -> m_type == MNM_TYPE_ADAPTIVE){
-        _next_link_ID = m_table -> find(_veh -> get_destination()) -> second -> find(_node_ID) -> second;
-        if (_next_link_ID < 0){
+        _next_link_index = m_pred[_veh -> get_destination() -> m_dest_index][_node_index];
+        if (_next_link_index < 0){
           printf("Something wrong in routing, wrong next link 1\n");
-          // printf("%d\n", _veh -> get_destination() -> m_Dest_ID);
-          // _shortest_path_tree = m_table -> find(_veh -> get_destination()) -> second;
-          // printf("%d\n", _shortest_path_tree -> size());
-          // for (auto it : (*_shortest_path_tree)) printf("%d, %d\n", it.first, it.second);
           exit(-1);
         }
-        // printf("From origin, The next link ID will be %d\n", _next_link_ID());
-        _next_link = m_link_factory -> get_link(_next_link_ID);
-        _veh -> set_next_link(_next_link);
-        // printf("The next link now it's %d\n", _veh -> get_next_link() -> m_link_ID());
+        _veh -> set_next_link(m_link_vec[_next_link_index]);
       }
     }
   }  
 
-  MNM_Destination *_veh_dest;
   MNM_Dlink *_link;
-  for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it ++){
-    _link = _link_it -> second;
+  const int *_dest_pred;
+  for (int e = 0; e < m_csr -> m_num_link; ++e){
+    _link = m_link_vec[e];
+    if (_link -> m_finished_array.empty()) continue;
+    _node_index = m_csr -> m_link_to[e];
     _node_ID = _link -> m_to_node -> m_node_ID;
     for (auto _veh_it = _link -> m_finished_array.begin(); _veh_it!=_link -> m_finished_array.end(); _veh_it++){
       _veh = *_veh_it;
@@ -193,23 +295,14 @@ int MNM_Routing_Adaptive::update_routing(TInt timestamp)
           printf("Wrong current link!\n");
           exit(-1);
         }
-        // if (_link != _veh -> get_next_link()){
-        //   printf("Wrong node allocation!\n");
-        //   printf("The next link should be %d, but now it's %d, current link is %d\n",_link -> m_link_ID(), 
-        //                 _veh -> get_next_link() -> m_link_ID(), _veh -> get_current_link() -> m_link_ID());
-        //   _next_link_ID = m_table -> find(_veh -> get_destination()) -> second -> find(_node_ID) -> second;
-        //   _node_ID = m_table -> find(_veh -> get_destination()) -> second -> find(1) -> second;
-        //   printf("The next link ID will be %d\n", _next_link_ID());
-        //   printf("From origin, The next link ID will be %d\n", _node_ID());
-        //   exit(-1);
-        // }
         _veh_dest = _veh -> get_destination();
         if (_veh_dest -> m_dest_node -> m_node_ID == _node_ID){
           _veh -> set_next_link(NULL);
         }
         else{
-          _next_link_ID = m_table -> find(_veh -> get_destination()) -> second -> find(_node_ID) -> second;
-          if (_next_link_ID == -1){
+          _dest_pred = m_pred[_veh_dest -> m_dest_index].data();
+          _next_link_index = _dest_pred[_node_index];
+          if (_next_link_index < 0){
             printf("Something wrong in routing, wrong next link 2\n");
             printf("The node is %d, the vehicle should head to %d\n", (int)_node_ID, (int)_veh_dest -> m_dest_node -> m_node_ID);
             // exit(-1);
@@ -217,36 +310,27 @@ int MNM_Routing_Adaptive::update_routing(TInt timestamp)
             if (_node_I.GetOutDeg() > 0){
               printf("Assign randomly!\n");
               _next_link_ID = _node_I.GetOutEId(MNM_Ults::mod(rand(), _node_I.GetOutDeg()));
+              _next_link_index = m_csr -> get_link_index(_next_link_ID);
             }
             else
             {
               printf("Can't do anything!\n");
             }
           }
-          _next_link = m_link_factory -> get_link(_next_link_ID);
+          _next_link = _next_link_index < 0 ? NULL : m_link_vec[_next_link_index];
           if (_next_link != NULL) {
-            // printf("Checking future\n");
-            TInt _next_node_ID = _next_link -> m_to_node -> m_node_ID;
-            if (_next_node_ID != _veh -> get_destination() -> m_dest_node -> m_node_ID){
-              // printf("Destination node is %d\n", _veh -> get_destination() -> m_dest_node -> m_node_ID());
-              if (m_table -> find(_veh -> get_destination()) == m_table -> end()){
-                printf("Cant'f find Destination\n");
-              }
-              if (m_table -> find(_veh -> get_destination()) -> second -> find(_next_node_ID) == m_table -> find(_veh -> get_destination()) -> second -> end()){
-                printf("can't find _next_node_ID\n");
-              }
-              if (m_table -> find(_veh -> get_destination()) -> second -> find(_next_node_ID) -> second == -1){
-                printf("Something wrong for the future node!\n");
-                exit(-1);
-              }
-              // printf("Pass checking\n");
+            // the next node has to lead to the destination as well
+            int _next_node_index = m_csr -> m_link_to[_next_link_index];
+            if (_next_node_index != m_dest_node_index[_veh_dest -> m_dest_index] && _dest_pred[_next_node_index] < 0){
+              printf("Something wrong for the future node!\n");
+              exit(-1);
             }
           }
           _veh -> set_next_link(_next_link);
         } //end if else
       } //end if veh->m_type
     } //end for veh_it
-  } //end for link_it
+  } //end for link
 
   // printf("Finished Routing\n");
   return 0;
@@ -263,7 +347,11 @@ MNM_Routing_Fixed::MNM_Routing_Fixed(PNEGraph &graph,
               MNM_Link_Factory *link_factory, TInt routing_frq, TInt buffer_len)
  : MNM_Routing::MNM_Routing(graph, od_factory, node_factory, link_factory)
 {
-  m_tracker = std::unordered_map<MNM_Veh*, std::deque<TInt>*>();
+  m_path_table = NULL;
+  m_alias_table = NULL;
+  m_alias_col = -1;
+  m_cur_alias_table = NULL;
+  m_seed = 0;
   if ((routing_frq == -1) || (buffer_len == -1)){
     m_buffer_as_p = false;
     m_routing_freq = -1;
@@ -279,12 +367,7 @@ MNM_Routing_Fixed::MNM_Routing_Fixed(PNEGraph &graph,
 
 MNM_Routing_Fixed::~MNM_Routing_Fixed()
 {
-  for (auto _map_it : m_tracker){
-    _map_it.second -> clear();
-    delete _map_it.second;
-  }
-  m_tracker.clear();
-
+  clear_alias_table();
   if ((m_path_table != NULL) && (m_path_table -> size() > 0)){
     // printf("Address of m_path_table is %p\n", (void *)m_path_table);
     // printf("%d\n", m_path_table -> size());
@@ -315,14 +398,13 @@ int MNM_Routing_Fixed::init_routing(Path_Table *path_table)
 }
 
 
+// the vehicles registered from now on choose by the buffer column of this interval
 int MNM_Routing_Fixed::change_choice_portion(TInt routing_interval)
 {
-  // printf("Entering MNM_Routing_Fixed::change_choice_portion\n");
-  // printf("Current routing interval %d\n", routing_interval);
-  MNM::copy_buffer_to_p(m_path_table, routing_interval);
-  // printf("Finish copying\n");
-  MNM::normalize_path_table_p(m_path_table);
-  // printf("Exiting MNM_Routing_Fixed::change_choice_portion\n");
+  if (m_alias_col != routing_interval){
+    m_alias_col = routing_interval;
+    m_cur_alias_table = NULL;
+  }
   return 0;
 }
 
@@ -355,14 +437,13 @@ int MNM_Routing_Fixed::update_routing(TInt timestamp)
       _veh = *_veh_it;
       // printf("1.2\n");
       if (_veh -> m_type == MNM_TYPE_STATIC){
-        if (m_tracker.find(_veh) == m_tracker.end()){
+        if (_veh -> m_path == NULL){
           // printf("Registering!\n");
           register_veh(_veh);
           // printf("1.3\n");
-          _next_link_ID = m_tracker.find(_veh) -> second -> front();
+          _next_link_ID = _veh -> pop_path_link();
           _next_link = m_link_factory -> get_link(_next_link_ID);
           _veh -> set_next_link(_next_link);
-          m_tracker.find(_veh) -> second -> pop_front();
         }
       }
     }
@@ -383,21 +464,20 @@ int MNM_Routing_Fixed::update_routing(TInt timestamp)
         _veh_dest = _veh -> get_destination();
         // printf("2.2\n");
         if (_veh_dest -> m_dest_node -> m_node_ID == _node_ID){
-          if (m_tracker.find(_veh) -> second -> size() != 0){
+          if (_veh -> has_path_link()){
             printf("Something wrong in fixed routing!\n");
             exit(-1);
           }
           _veh -> set_next_link(NULL);
-          // m_tracker.erase(m_tracker.find(_veh));
         }
         else{
           // printf("2.3\n");
-          if (m_tracker.find(_veh) == m_tracker.end()){
+          if (_veh -> m_path == NULL){
             printf("Vehicle not registered in link, impossible!\n");
             exit(-1);
           }
           if (_veh -> get_current_link() == _veh -> get_next_link()){
-            _next_link_ID = m_tracker.find(_veh) -> second -> front();
+            _next_link_ID = _veh -> pop_path_link();
             if (_next_link_ID == -1){
               printf("Something wrong in routing, wrong next link 2\n");
               printf("The node is %d, the vehicle should head to %d\n", (int)_node_ID, (int)_veh_dest -> m_dest_node -> m_node_ID);
@@ -405,7 +485,6 @@ int MNM_Routing_Fixed::update_routing(TInt timestamp)
             }
             _next_link = m_link_factory -> get_link(_next_link_ID);
             _veh -> set_next_link(_next_link);
-            m_tracker.find(_veh) -> second -> pop_front();
           }
         } //end if-else
       } //end if veh->m_type
@@ -418,52 +497,130 @@ int MNM_Routing_Fixed::update_routing(TInt timestamp)
 
 int MNM_Routing_Fixed::register_veh(MNM_Veh* veh)
 {
-  TFlt _r = MNM_Ults::rand_flt();
   // printf("%d\n", veh -> get_origin() -> m_origin_node  -> m_node_ID);
   // printf("%d\n", veh -> get_destination() -> m_dest_node  -> m_node_ID);
-  MNM_Pathset *_pathset = m_path_table -> find(veh -> get_origin() -> m_origin_node  -> m_node_ID) -> second
-                        -> find(veh -> get_destination() -> m_dest_node  -> m_node_ID) -> second;
-  MNM_Path *_route_path = NULL;
-  // printf("1\n");
-  for (MNM_Path *_path : _pathset -> m_path_vec){
-    // printf("2\n");
-    if (_path -> m_p >= _r) {
-      _route_path = _path;
-      break;
-    }
-    else{
-      _r -= _path -> m_p;
+  int _od_index = m_path_table -> get_od_index(veh -> get_origin() -> m_origin_node  -> m_node_ID,
+                                               veh -> get_destination() -> m_dest_node  -> m_node_ID);
+  int _route_path = -1;
+  if (_od_index >= 0 && m_path_table -> m_od_offset[_od_index] < m_path_table -> m_od_offset[_od_index + 1]){
+    if (m_cur_alias_table == NULL){
+      if (m_alias_table == NULL) m_alias_table = new MNM_Alias_Table();
+      m_cur_alias_table = build_alias_table(m_alias_col, m_alias_table);
     }
+    int _begin = m_path_table -> m_od_offset[_od_index];
+    int _num_path = m_path_table -> m_od_offset[_od_index + 1] - _begin;
+    MNM_Rng &_rng = m_origin_rng[_od_index / m_path_table -> m_dest_node_ID.size()];
+    // one draw picks the slot and the coin of the slot
+    double _x = _rng.rand_flt() * _num_path;
+    int _j = std::min(int(_x), _num_path - 1);
+    int _slot = _begin + _j;
+    _route_path = (_x - _j < m_cur_alias_table -> m_prob[_slot]) ? _slot : m_cur_alias_table -> m_alias[_slot];
   }
-  // printf("3\n");
-  if (_route_path == NULL){
+  if (_route_path < 0){
     printf("Wrong prabability!\n");
     exit(-1);
   }
-  std::deque<TInt> *_link_queue = new std::deque<TInt>();
-  std::copy(_route_path -> m_link_vec.begin(), _route_path -> m_link_vec.end(), std::back_inserter(*_link_queue));
-  // printf("old link q is %d, New link queuq is %d\n", _route_path -> m_link_vec.size(), _link_queue -> size());
-  m_tracker.insert(std::pair<MNM_Veh*, std::deque<TInt>*>(veh, _link_queue));
-  veh -> m_path = _route_path;
+  veh -> set_path(m_path_table -> m_path[_route_path]);
   return 0;
 }
 
-int MNM_Routing_Fixed::set_path_table(Path_Table *path_table)
+// Vose's method on every OD range, an OD with zero total portion is uniform as in normalize_p,
+// the vectors of table are reused
+MNM_Alias_Table *MNM_Routing_Fixed::build_alias_table(TInt col, MNM_Alias_Table *table)
 {
-  m_path_table = path_table;
-  return 0;
+  MNM_Alias_Table *_table = table;
+  int _num_path = m_path_table -> m_num_path;
+  _table -> m_prob.assign(_num_path, 1.0);
+  _table -> m_alias.resize(_num_path);
+  std::vector<double> _scaled(_num_path);
+  std::vector<int> _small, _large;
+  int _begin, _end, _s, _l;
+  double _tot;
+  for (size_t k = 0; k + 1 < m_path_table -> m_od_offset.size(); ++k){
+    _begin = m_path_table -> m_od_offset[k];
+    _end = m_path_table -> m_od_offset[k + 1];
+    if (_begin == _end) continue;
+    _tot = 0;
+    for (int i = _begin; i < _end; ++i){
+      _table -> m_alias[i] = i;
+      _scaled[i] = (col < 0) ? m_path_table -> m_path[i] -> m_p() : m_path_table -> m_path[i] -> m_buffer[col]();
+      if (_scaled[i] < 0){
+        printf("Negative probability, impossible!\n");
+        exit(-1);
+      }
+      _tot += _scaled[i];
+    }
+    if (_tot <= 0) continue;
+    _small.clear();
+    _large.clear();
+    for (int i = _begin; i < _end; ++i){
+      _scaled[i] *= (_end - _begin) / _tot;
+      if (_scaled[i] < 1.0){
+        _small.push_back(i);
+      }
+      else{
+        _large.push_back(i);
+      }
+    }
+    while (!_small.empty() && !_large.empty()){
+      _s = _small.back();
+      _small.pop_back();
+      _l = _large.back();
+      _table -> m_prob[_s] = _scaled[_s];
+      _table -> m_alias[_s] = _l;
+      _scaled[_l] -= 1.0 - _scaled[_s];
+      if (_scaled[_l] < 1.0){
+        _large.pop_back();
+        _small.push_back(_l);
+      }
+    }
+    // the rest are 1 up to round off
+  }
+  return _table;
 }
 
-int MNM_Routing_Fixed::add_veh_path(MNM_Veh* veh, std::deque<TInt> *link_que)
+int MNM_Routing_Fixed::clear_alias_table()
 {
-  std::deque<TInt> *_new_link_que = new std::deque<TInt>();
-  std::copy(link_que->begin(), link_que->end(), std::back_inserter(*_new_link_que));
-  m_tracker.insert(std::pair<MNM_Veh*, std::deque<TInt>*>(veh, _new_link_que));
+  if (m_alias_table != NULL){
+    delete m_alias_table;
+    m_alias_table = NULL;
+  }
+  m_cur_alias_table = NULL;
   return 0;
 }
 
+int MNM_Routing_Fixed::set_seed(TInt seed)
+{
+  m_seed = seed;
+  m_origin_rng.clear();
+  if (m_path_table != NULL){
+    for (size_t i = 0; i < m_path_table -> m_origin_node_ID.size(); ++i){
+      m_origin_rng.push_back(MNM_Rng(uint64_t(m_seed()) * 1000003ULL + uint64_t(m_path_table -> m_origin_node_ID[i]())));
+    }
+  }
+  return 0;
+}
 
+// the routes are kept on the vehicles, which are gone with the vehicle factory,
+// the buffer may be changed before the next run
+int MNM_Routing_Fixed::reset()
+{
+  clear_alias_table();
+  m_alias_col = -1;
+  set_seed(m_seed);
+  return 0;
+}
 
+int MNM_Routing_Fixed::set_path_table(Path_Table *path_table)
+{
+  m_path_table = path_table;
+  if (!m_path_table -> is_compact()){
+    m_path_table -> compact();
+  }
+  clear_alias_table();
+  set_seed(m_seed);
+  return 0;
+}
 
 /**************************************************************************
                           Hybrid (Adaptive+Fixed) routing
@@ -497,6 +654,13 @@ int MNM_Routing_Hybrid::update_routing(TInt timestamp)
   return 0;
 }
 
+int MNM_Routing_Hybrid::reset()
+{
+  m_routing_adaptive -> reset();
+  m_routing_fixed -> reset();
+  return 0;
+}
+
 
 
 
@@ -520,6 +684,8 @@ MNM_Routing_Biclass_Hybrid::~MNM_Routing_Biclass_Hybrid()
   // printf("m_routing_adaptive\n");
   delete m_routing_fixed_car;
   // printf("m_routing_fixed_car\n");
+  // the path table is shared with the car routing and deleted there
+  m_routing_fixed_truck -> m_path_table = NULL;
   delete m_routing_fixed_truck;
   // printf("m_routing_fixed_truck\n");
 }
@@ -546,6 +712,14 @@ int MNM_Routing_Biclass_Hybrid::update_routing(TInt timestamp)
   return 0;
 }
 
+int MNM_Routing_Biclass_Hybrid::reset()
+{
+  m_routing_adaptive -> reset();
+  m_routing_fixed_car -> reset();
+  m_routing_fixed_truck -> reset();
+  return 0;
+}
+
 /**************************************************************************
                           Bi-class fixed routing
 **************************************************************************/
@@ -565,9 +739,7 @@ MNM_Routing_Biclass_Fixed::~MNM_Routing_Biclass_Fixed()
 
 int MNM_Routing_Biclass_Fixed::change_choice_portion(TInt routing_interval)
 {
-  MNM::copy_buffer_to_p(m_path_table, routing_interval + m_veh_class*m_buffer_length);
-  MNM::normalize_path_table_p(m_path_table);
-  return 0;
+  return MNM_Routing_Fixed::change_choice_portion(routing_interval + m_veh_class*m_buffer_length);
 }
 
 int MNM_Routing_Biclass_Fixed::update_routing(TInt timestamp)
@@ -602,13 +774,12 @@ int MNM_Routing_Biclass_Fixed::update_routing(TInt timestamp)
       if ((_veh -> m_type == MNM_TYPE_STATIC) && (_veh -> m_class == m_veh_class)) {
       // Here is the difference from single-class fixed routing
 
-        if (m_tracker.find(_veh) == m_tracker.end()){
+        if (_veh -> m_path == NULL){
           // printf("Registering!\n");
           register_veh(_veh);
-          _next_link_ID = m_tracker.find(_veh) -> second -> front();
+          _next_link_ID = _veh -> pop_path_link();
           _next_link = m_link_factory -> get_link(_next_link_ID);
           _veh -> set_next_link(_next_link);
-          m_tracker.find(_veh) -> second -> pop_front();
         }
       }
     }
@@ -629,19 +800,19 @@ int MNM_Routing_Biclass_Fixed::update_routing(TInt timestamp)
 
         _veh_dest = _veh -> get_destination();
         if (_veh_dest -> m_dest_node -> m_node_ID == _node_ID){
-          if (m_tracker.find(_veh) -> second -> size() != 0){
+          if (_veh -> has_path_link()){
             printf("Something wrong in fixed routing!\n");
             exit(-1);
           }
           _veh -> set_next_link(NULL);
         }
         else{
-          if (m_tracker.find(_veh) == m_tracker.end()){
+          if (_veh -> m_path == NULL){
             printf("Vehicle not registered in link, impossible!\n");
             exit(-1);
           }
           if (_veh -> get_current_link() == _veh -> get_next_link()){
-            _next_link_ID = m_tracker.find(_veh) -> second -> front();
+            _next_link_ID = _veh -> pop_path_link();
             if (_next_link_ID == -1){
               printf("Something wrong in routing, wrong next link 2\n");
               printf("The node is %d, the vehicle should head to %d\n", (int)_node_ID, (int)_veh_dest -> m_dest_node -> m_node_ID);
@@ -649,7 +820,6 @@ int MNM_Routing_Biclass_Fixed::update_routing(TInt timestamp)
             }
             _next_link = m_link_factory -> get_link(_next_link_ID);
             _veh -> set_next_link(_next_link);
-            m_tracker.find(_veh) -> second -> pop_front();
           }
         } //end if-else
       } //end if veh->m_type
@@ -10,8 +10,7 @@
 #include "pre_routing.h"
 
 #include <unordered_map>
-
-typedef std::unordered_map<MNM_Destination*, std::unordered_map<TInt, TInt>*> Routing_Table; 
+#include <vector>
 
 class MNM_Routing
 {
@@ -21,6 +20,8 @@ public:
   virtual ~MNM_Routing();
   int virtual init_routing(Path_Table *path_table=NULL){return 0;};
   int virtual update_routing(TInt timestamp){return 0;};
+  // forget all routed vehicles, called by MNM_Dta::reset
+  int virtual reset(){return 0;};
   PNEGraph m_graph;
   MNM_OD_Factory *m_od_factory;
   MNM_Link_Factory *m_link_factory;
@@ -49,15 +50,51 @@ public:
   ~MNM_Routing_Adaptive();
   int virtual init_routing(Path_Table *path_table=NULL) override;
   int virtual update_routing(TInt timestamp) override;  
+  // make sure the tree of destination row d is up to date with the last refresh
+  int build_tree(int d);
 // private:
   MNM_Statistics* m_statistics;
-  Routing_Table *m_table;
   TInt m_routing_freq;
   MNM_ConfReader *m_self_config;
+  // built once in init_routing, the trees are computed on arrays
+  MNM_Graph_CSR *m_csr;
+  std::vector<double> m_cost;
+  // one tree per destination, m_pred[d] is also the next link table: the link index to take
+  // at node i towards destination d = MNM_Destination::m_dest_index is m_pred[d][i]
+  std::vector<MNM_Destination*> m_dest_vec;
+  std::vector<int> m_dest_node_index;
+  std::vector<std::vector<double>> m_dist;
+  std::vector<std::vector<int>> m_pred;
+  // trees are only built when a vehicle needs them after a refresh, m_tree_stamp[d] is the
+  // refresh a tree was built for. With drop_idle_tree = 1 in [ADAPTIVE] the trees of the
+  // destinations nobody headed to during a whole refresh period are freed
+  int m_refresh;
+  bool m_refresh_rebuild;
+  bool m_drop_idle_tree;
+  std::vector<int> m_tree_stamp;
+  std::vector<char> m_dest_used;
+  std::vector<char> m_dest_needed;
+  std::vector<int> m_needed_dest;
+  std::vector<MNM_Dlink*> m_link_vec;
+  // between refreshes the trees are repaired from the links whose tt moved more than m_sp_epsilon,
+  // all trees are rebuilt when more than m_sp_rebuild_ratio of the links moved, optional in [ADAPTIVE]
+  TFlt m_sp_epsilon;
+  TFlt m_sp_rebuild_ratio;
+  std::vector<double> m_new_cost;
+  std::vector<double> m_old_cost;
+  std::vector<int> m_changed_link;
+  // position of CSR link e in the statistics arrays, the new costs are read from the record tt through it
+  std::vector<int> m_stat_link_index;
 };
 
 
 
+struct MNM_Alias_Table
+{
+  std::vector<double> m_prob;
+  std::vector<int> m_alias;
+};
+
 class MNM_Routing_Fixed : public MNM_Routing
 {
 public:
@@ -68,17 +105,34 @@ public:
   ~MNM_Routing_Fixed();
   int virtual init_routing(Path_Table *path_table=NULL) override;
   int virtual update_routing(TInt timestamp) override;
+  int virtual reset() override;
 // private:
   int set_path_table(Path_Table *path_table);
+  // reseeds the random streams of all origins
+  int set_seed(TInt seed);
+  // the vehicle follows its m_path from then on
   int register_veh(MNM_Veh* veh);
-  int add_veh_path(MNM_Veh* veh, std::deque<TInt> *link_que);
   int change_choice_portion(TInt interval);
+  // the alias tables are built from the current buffer / m_p on first use
+  int clear_alias_table();
   Path_Table *m_path_table;
-  std::unordered_map<MNM_Veh*, std::deque<TInt>*> m_tracker;
   bool m_buffer_as_p;
   TInt m_routing_freq;
   TInt m_buffer_length;
   // TInt m_cur_routing_interval;
+
+  // Walker alias table of the choice portions of buffer column m_alias_col (-1 for m_p),
+  // entry i belongs to path i of the path table and its alias is a path of the same OD.
+  // Only the table of the current column is kept, m_cur_alias_table is NULL until it is
+  // rebuilt in m_alias_table for a new column
+  MNM_Alias_Table *m_alias_table;
+  TInt m_alias_col;
+  MNM_Alias_Table *m_cur_alias_table;
+  // one random stream per origin index of the path table
+  TInt m_seed;
+  std::vector<MNM_Rng> m_origin_rng;
+private:
+  MNM_Alias_Table *build_alias_table(TInt col, MNM_Alias_Table *table);
 };
 
 
@@ -92,6 +146,7 @@ public:
   ~MNM_Routing_Hybrid();
   int virtual init_routing(Path_Table *path_table=NULL) override;
   int virtual update_routing(TInt timestamp) override;
+  int virtual reset() override;
 
   MNM_Routing_Adaptive* m_routing_adaptive;
   MNM_Routing_Fixed* m_routing_fixed;
@@ -126,6 +181,7 @@ public:
   ~MNM_Routing_Biclass_Hybrid();
   int virtual init_routing(Path_Table *path_table=NULL) override;
   int virtual update_routing(TInt timestamp) override;
+  int virtual reset() override;
 
   MNM_Routing_Adaptive* m_routing_adaptive;
   MNM_Routing_Biclass_Fixed* m_routing_fixed_car;
@@ -146,6 +202,7 @@ public:
   ~MNM_Routing_Predetermined();
   int virtual init_routing(Path_Table *path_table=NULL);
   int virtual update_routing(TInt timestamp);
+  int virtual reset();
   // MNM_Pre_Routing* virtual get_routing_table(){return m_pre_routing;};
   // private:
   // int set_path_table(Path_Table *path_table);
@@ -154,7 +211,6 @@ public:
   TInt m_total_assign_inter;
   Path_Table *m_path_table;
   MNM_Pre_Routing *m_pre_routing;
-  std::unordered_map<MNM_Veh*, std::deque<TInt>*> m_tracker;
 
 };
 
@@ -1,165 +1,893 @@
 #include "shortest_path.h"
 #include "limits.h"
 
-#include "radix_heap.h"
-
 #include <math.h>
 
 #include <queue>
+#include <functional>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <sys/mman.h>
+#include <unistd.h>
 
 int MNM_Shortest_Path::one_to_one(TInt origin_node_ID, TInt dest_node_ID, 
                       PNEGraph graph, std::unordered_map<TInt, TFlt>& cost_map,
                       std::vector<TInt> &output_array)
 {
+  return one_to_one(origin_node_ID, dest_node_ID, MNM_Graph_CSR::get_snapshot(graph), cost_map, output_array);
+}
+
+int MNM_Shortest_Path::one_to_one(TInt origin_node_ID, TInt dest_node_ID, 
+                      const MNM_Graph_CSR *csr, const std::unordered_map<TInt, TFlt>& cost_map,
+                      std::vector<TInt> &output_array)
+{
+  std::vector<double> _cost = std::vector<double>(csr -> m_num_link);
+  std::vector<int> _path_link = std::vector<int>();
+  csr -> build_cost_array(cost_map, _cost.data());
+  output_array.clear();
+  if (one_to_one_Dijkstra(csr -> get_node_index(origin_node_ID), csr -> get_node_index(dest_node_ID), 
+                          csr, _cost.data(), _path_link) < 0){
+    return -1;
+  }
+  for (int _link : _path_link){
+    output_array.push_back(csr -> m_link_ID[_link]);
+  }
   return 0;
 }
 
 
-int MNM_Shortest_Path::all_to_one_Dijkstra(TInt destination_ID, 
-                        PNEGraph graph, std::unordered_map<TInt, TFlt> &cost_map,
-                        std::unordered_map<TInt, TInt> &output_map)
+/*------------------------------------------------------------
+                  CSR snapshot of the graph
+-------------------------------------------------------------*/
+MNM_Graph_CSR::MNM_Graph_CSR(PNEGraph graph)
+{
+  m_num_node = graph -> GetNodes();
+  m_num_link = graph -> GetEdges();
+  m_node_ID = std::vector<int>(m_num_node);
+  m_link_ID = std::vector<int>(m_num_link);
+  m_node_index = std::unordered_map<TInt, int>();
+  m_link_index = std::unordered_map<TInt, int>();
+  m_link_from = std::vector<int>(m_num_link);
+  m_link_to = std::vector<int>(m_num_link);
+  m_in_offset = std::vector<int>(m_num_node + 1, 0);
+  m_in_link = std::vector<int>(m_num_link);
+  m_in_tail = std::vector<int>(m_num_link);
+  m_out_offset = std::vector<int>(m_num_node + 1, 0);
+  m_out_link = std::vector<int>(m_num_link);
+  m_sp_heap = MNM_TYPE_HEAP_BINARY;
+
+  int _idx = 0;
+  for (auto _node_it = graph -> BegNI(); _node_it < graph -> EndNI(); _node_it++){
+    m_node_ID[_idx] = _node_it.GetId();
+    m_node_index.insert({_node_it.GetId(), _idx});
+    _idx++;
+  }
+  _idx = 0;
+  for (auto _edge_it = graph -> BegEI(); _edge_it < graph -> EndEI(); _edge_it++){
+    m_link_ID[_idx] = _edge_it.GetId();
+    m_link_index.insert({_edge_it.GetId(), _idx});
+    m_link_from[_idx] = m_node_index.find(_edge_it.GetSrcNId()) -> second;
+    m_link_to[_idx] = m_node_index.find(_edge_it.GetDstNId()) -> second;
+    m_in_offset[m_link_to[_idx] + 1] += 1;
+    m_out_offset[m_link_from[_idx] + 1] += 1;
+    _idx++;
+  }
+  for (int i = 0; i < m_num_node; ++i){
+    m_in_offset[i + 1] += m_in_offset[i];
+    m_out_offset[i + 1] += m_out_offset[i];
+  }
+  std::vector<int> _fill = std::vector<int>(m_in_offset.begin(), m_in_offset.end() - 1);
+  std::vector<int> _out_fill = std::vector<int>(m_out_offset.begin(), m_out_offset.end() - 1);
+  for (int e = 0; e < m_num_link; ++e){
+    int _pos = _fill[m_link_to[e]]++;
+    m_in_link[_pos] = e;
+    m_in_tail[_pos] = m_link_from[e];
+    m_out_link[_out_fill[m_link_from[e]]++] = e;
+  }
+}
+
+MNM_Graph_CSR::~MNM_Graph_CSR()
+{
+  m_node_index.clear();
+  m_link_index.clear();
+}
+
+int MNM_Graph_CSR::get_node_index(TInt node_ID) const
 {
-  std::priority_queue<MNM_Cost*, std::vector<MNM_Cost*>, LessThanByCost> m_Q \
-  = std::priority_queue<MNM_Cost*, std::vector<MNM_Cost*>, LessThanByCost>();
-  MNM_Cost *dest_cost = new MNM_Cost(destination_ID, TFlt(0));
-  m_Q.push(dest_cost);
+  auto _it = m_node_index.find(node_ID);
+  if (_it == m_node_index.end()){
+    printf("MNM_Graph_CSR::get_node_index, node %d not in graph\n", (int)node_ID);
+    exit(-1);
+  }
+  return _it -> second;
+}
+
+int MNM_Graph_CSR::get_link_index(TInt link_ID) const
+{
+  auto _it = m_link_index.find(link_ID);
+  if (_it == m_link_index.end()){
+    printf("MNM_Graph_CSR::get_link_index, link %d not in graph\n", (int)link_ID);
+    exit(-1);
+  }
+  return _it -> second;
+}
+
+int MNM_Graph_CSR::build_cost_array(const std::unordered_map<TInt, TFlt>& cost_map, double *cost) const
+{
+  for (int e = 0; e < m_num_link; ++e){
+    auto _it = cost_map.find(m_link_ID[e]);
+    cost[e] = _it == cost_map.end() ? 0. : _it -> second();
+  }
+  return 0;
+}
+
+namespace {
+struct MNM_Graph_CSR_Snapshot
+{
+  // holding the graph keeps its address from being reused by another graph
+  PNEGraph m_graph;
+  int m_num_node = -1;
+  int m_num_link = -1;
+  std::unique_ptr<MNM_Graph_CSR> m_csr;
+};
+
+MNM_Graph_CSR_Snapshot& thread_snapshot()
+{
+  static thread_local MNM_Graph_CSR_Snapshot _snapshot;
+  return _snapshot;
+}
+}
+
+const MNM_Graph_CSR *MNM_Graph_CSR::get_snapshot(PNEGraph graph)
+{
+  MNM_Graph_CSR_Snapshot &_snapshot = thread_snapshot();
+  if (_snapshot.m_csr == nullptr || _snapshot.m_graph() != graph() 
+      || _snapshot.m_num_node != graph -> GetNodes() || _snapshot.m_num_link != graph -> GetEdges()){
+    _snapshot.m_csr.reset(new MNM_Graph_CSR(graph));
+    _snapshot.m_graph = graph;
+    _snapshot.m_num_node = graph -> GetNodes();
+    _snapshot.m_num_link = graph -> GetEdges();
+  }
+  return _snapshot.m_csr.get();
+}
 
-  std::unordered_map<TInt, TFlt> dist_to_dest = std::unordered_map<TInt, TFlt>();
+int MNM_Graph_CSR::clear_snapshot()
+{
+  MNM_Graph_CSR_Snapshot &_snapshot = thread_snapshot();
+  _snapshot.m_csr.reset();
+  _snapshot.m_graph = PNEGraph();
+  return 0;
+}
 
-  for (auto _node_it = graph->BegNI(); _node_it < graph->EndNI(); _node_it++){
-    TInt _node_id = _node_it.GetId();
-    if (_node_id != destination_ID){
-      dist_to_dest.insert({_node_id, TFlt(std::numeric_limits<double>::max())});
-      output_map.insert({_node_id, -1});  // If the destination is not accessible the output remains -1
+int MNM_SP_Workspace::reserve(int num_node)
+{
+  m_binary_heap.clear();
+  m_radix_heap.clear();
+  m_dary_heap.clear();
+  m_heap_pos.assign(num_node, -1);
+  m_queue.resize(num_node);
+  m_in_Q.assign(num_node, 0);
+  return 0;
+}
+
+MNM_SP_Workspace* MNM_SP_Workspace::get_thread_workspace()
+{
+  static thread_local MNM_SP_Workspace _workspace;
+  return &_workspace;
+}
+
+int MNM_SP_Workspace::start_query(int num_node)
+{
+  if (int(m_fwd_stamp.size()) < num_node){
+    m_fwd_dist.resize(num_node);
+    m_bwd_dist.resize(num_node);
+    m_fwd_pred.resize(num_node);
+    m_bwd_pred.resize(num_node);
+    m_fwd_stamp.resize(num_node, 0);
+    m_bwd_stamp.resize(num_node, 0);
+  }
+  m_stamp++;
+  if (m_stamp == 0){
+    std::fill(m_fwd_stamp.begin(), m_fwd_stamp.end(), 0);
+    std::fill(m_bwd_stamp.begin(), m_bwd_stamp.end(), 0);
+    m_stamp = 1;
+  }
+  m_binary_heap.clear();
+  m_bwd_heap.clear();
+  return 0;
+}
+
+/*------------------------------------------------------------
+                  array kernels on the CSR snapshot
+-------------------------------------------------------------*/
+// relax all links entering node, a tie on a positive cost link moves pred to the lower link index
+#define MNM_SP_RELAX_IN_LINKS(_node, _node_dist, _on_improve)                 \
+  for (int k = _in_offset[_node]; k < _in_offset[_node + 1]; ++k){            \
+    int _tail = _in_tail[k];                                                  \
+    int _link = _in_link[k];                                                  \
+    double _alt = _node_dist + cost[_link];                                   \
+    if (_alt < dist[_tail]){                                                  \
+      dist[_tail] = _alt;                                                     \
+      pred[_tail] = _link;                                                    \
+      _on_improve;                                                            \
+    }                                                                         \
+    else if (_alt == dist[_tail] && cost[_link] > 0 && _link < pred[_tail]){  \
+      pred[_tail] = _link;                                                    \
+    }                                                                         \
+  }
+
+// binary heap with lazy deletion on a reused vector
+static int Dijkstra_binary(int dest_index, const MNM_Graph_CSR *csr, const double *cost,
+                           double *dist, int *pred, MNM_SP_Workspace *workspace)
+{
+  const int *_in_offset = csr -> m_in_offset.data();
+  const int *_in_link = csr -> m_in_link.data();
+  const int *_in_tail = csr -> m_in_tail.data();
+  typedef std::pair<double, int> _Entry;
+  std::vector<_Entry> &_Q = workspace -> m_binary_heap;
+  std::greater<_Entry> _cmp;
+  _Q.push_back(std::make_pair(0., dest_index));
+  while (!_Q.empty()){
+    std::pop_heap(_Q.begin(), _Q.end(), _cmp);
+    double _tmp_dist = _Q.back().first;
+    int _node = _Q.back().second;
+    _Q.pop_back();
+    if (_tmp_dist > dist[_node]) continue;
+    MNM_SP_RELAX_IN_LINKS(_node, _tmp_dist, 
+      {_Q.push_back(std::make_pair(_alt, _tail)); std::push_heap(_Q.begin(), _Q.end(), _cmp);})
+  }
+  return 0;
+}
+
+// monotone radix heap, valid since the link costs are non-negative
+static int Dijkstra_radix(int dest_index, const MNM_Graph_CSR *csr, const double *cost,
+                          double *dist, int *pred, MNM_SP_Workspace *workspace)
+{
+  const int *_in_offset = csr -> m_in_offset.data();
+  const int *_in_link = csr -> m_in_link.data();
+  const int *_in_tail = csr -> m_in_tail.data();
+  radix_heap::pair_radix_heap<double, int> &_Q = workspace -> m_radix_heap;
+  _Q.push(0., dest_index);
+  while (!_Q.empty()){
+    double _tmp_dist = _Q.top_key();
+    int _node = _Q.top_value();
+    _Q.pop();
+    if (_tmp_dist > dist[_node]) continue;
+    MNM_SP_RELAX_IN_LINKS(_node, _tmp_dist, _Q.push(_alt, _tail))
+  }
+  return 0;
+}
+
+// indexed 4-ary heap keyed on dist with decrease-key, each node is in the heap at most once
+static int Dijkstra_dary(int dest_index, const MNM_Graph_CSR *csr, const double *cost,
+                         double *dist, int *pred, MNM_SP_Workspace *workspace)
+{
+  const int *_in_offset = csr -> m_in_offset.data();
+  const int *_in_link = csr -> m_in_link.data();
+  const int *_in_tail = csr -> m_in_tail.data();
+  std::vector<int> &_Q = workspace -> m_dary_heap;
+  int *_pos = workspace -> m_heap_pos.data();
+
+  auto _sift_up = [&](int pos, int node){
+    double _key = dist[node];
+    while (pos > 0){
+      int _parent = (pos - 1) >> 2;
+      if (dist[_Q[_parent]] <= _key) break;
+      _Q[pos] = _Q[_parent];
+      _pos[_Q[pos]] = pos;
+      pos = _parent;
+    }
+    _Q[pos] = node;
+    _pos[node] = pos;
+  };
+  auto _sift_down = [&](int pos, int node){
+    double _key = dist[node];
+    int _size = (int)_Q.size();
+    while (true){
+      int _child = (pos << 2) + 1;
+      if (_child >= _size) break;
+      int _last = std::min(_child + 4, _size);
+      int _min_child = _child;
+      for (int c = _child + 1; c < _last; ++c){
+        if (dist[_Q[c]] < dist[_Q[_min_child]]) _min_child = c;
+      }
+      if (dist[_Q[_min_child]] >= _key) break;
+      _Q[pos] = _Q[_min_child];
+      _pos[_Q[pos]] = pos;
+      pos = _min_child;
     }
+    _Q[pos] = node;
+    _pos[node] = pos;
+  };
+
+  _Q.push_back(dest_index);
+  _pos[dest_index] = 0;
+  while (!_Q.empty()){
+    int _node = _Q[0];
+    _pos[_node] = -1;
+    int _back = _Q.back();
+    _Q.pop_back();
+    if (!_Q.empty()) _sift_down(0, _back);
+    double _tmp_dist = dist[_node];
+    MNM_SP_RELAX_IN_LINKS(_node, _tmp_dist, 
+      {if (_pos[_tail] < 0) {_Q.push_back(_tail); _sift_up((int)_Q.size() - 1, _tail);} 
+       else _sift_up(_pos[_tail], _tail);})
   }
-  dist_to_dest[destination_ID] = TFlt(0);
+  return 0;
+}
 
-  // Initializaiton above. Dijkstra with binary min-heap (std::prioitiry_queue) below:
+int MNM_Shortest_Path::all_to_one_Dijkstra(int dest_index, const MNM_Graph_CSR *csr, const double *cost,
+                                           double *dist, int *pred)
+{
+  return all_to_one_Dijkstra(dest_index, csr, cost, dist, pred, 
+                             MNM_SP_Workspace::get_thread_workspace(), csr -> m_sp_heap);
+}
 
-  // NOTE: Since C++ std::priority_queue does not have decrease_key() function, 
-  // we insert [pointer to new MNM_cost object] to the min-heap every time when
-  // the dist_to_dest[] changes for some node. So there could be duplicated elements
-  // in the min-heap for the same nodes with different distance values. But the duplication
-  // doesn't affect the correctness of algorithm. (visited label for eliminating the 
-  // duplication is also tested, but slower than not using it, kind of weird.)
-  while (m_Q.size() != 0){
-    MNM_Cost *_min_cost = m_Q.top();
-    m_Q.pop();
-    TInt _node_id = _min_cost->m_ID;
-    auto _node_it = graph->GetNI(_node_id);
-    TFlt _tmp_dist = dist_to_dest[_node_id]; 
-      for (int e = 0; e < _node_it.GetInDeg(); e++){
-        TInt _in_node_id = _node_it.GetInNId(e);
-        TInt _in_link_id = graph->GetEI(_in_node_id, _node_id).GetId();
-        TFlt _alt = _tmp_dist + cost_map[_in_link_id];
-        if (_alt < dist_to_dest[_in_node_id]){
-          dist_to_dest[_in_node_id] = _alt;
-          m_Q.push(new MNM_Cost(_in_node_id, _alt));
-          output_map[_in_node_id] = _in_link_id;
+int MNM_Shortest_Path::all_to_one_Dijkstra(int dest_index, const MNM_Graph_CSR *csr, const double *cost,
+                                           double *dist, int *pred, MNM_SP_Workspace *workspace, SP_heap_type heap)
+{
+  for (int i = 0; i < csr -> m_num_node; ++i){
+    dist[i] = std::numeric_limits<double>::max();
+    pred[i] = -1;
+  }
+  dist[dest_index] = 0.;
+  workspace -> reserve(csr -> m_num_node);
+  switch (heap){
+    case MNM_TYPE_HEAP_BINARY:
+      return Dijkstra_binary(dest_index, csr, cost, dist, pred, workspace);
+    case MNM_TYPE_HEAP_RADIX:
+      return Dijkstra_radix(dest_index, csr, cost, dist, pred, workspace);
+    case MNM_TYPE_HEAP_DARY:
+      return Dijkstra_dary(dest_index, csr, cost, dist, pred, workspace);
+  }
+  printf("MNM_Shortest_Path::all_to_one_Dijkstra, unknown heap type\n");
+  exit(-1);
+}
+
+int MNM_Shortest_Path::tune_Dijkstra(MNM_Graph_CSR *csr, const double *cost, int num_tree)
+{
+  if (csr -> m_num_node == 0) return 0;
+  std::vector<double> _dist = std::vector<double>(csr -> m_num_node);
+  std::vector<int> _pred = std::vector<int>(csr -> m_num_node);
+  MNM_SP_Workspace *_workspace = MNM_SP_Workspace::get_thread_workspace();
+  SP_heap_type _heap_list[3] = {MNM_TYPE_HEAP_BINARY, MNM_TYPE_HEAP_RADIX, MNM_TYPE_HEAP_DARY};
+  int _num_tree = std::max(1, std::min(num_tree, csr -> m_num_node));
+  int _step = std::max(1, csr -> m_num_node / _num_tree);
+
+  // warm up the workspace so the timing does not include its first allocation
+  for (SP_heap_type _heap : _heap_list){
+    all_to_one_Dijkstra(0, csr, cost, _dist.data(), _pred.data(), _workspace, _heap);
+  }
+  double _best_time = std::numeric_limits<double>::max();
+  for (SP_heap_type _heap : _heap_list){
+    auto _start = std::chrono::steady_clock::now();
+    for (int i = 0; i < _num_tree; ++i){
+      all_to_one_Dijkstra((i * _step) % csr -> m_num_node, csr, cost, _dist.data(), _pred.data(), _workspace, _heap);
+    }
+    double _time = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+    if (_time < _best_time){
+      _best_time = _time;
+      csr -> m_sp_heap = _heap;
+    }
+  }
+  return 0;
+}
+
+int MNM_Shortest_Path::repair_all_to_one_Dijkstra(int dest_index, const MNM_Graph_CSR *csr, 
+                                                  const double *old_cost, const double *cost,
+                                                  const int *changed_link, int num_changed,
+                                                  double *dist, int *pred)
+{
+  const int *_in_offset = csr -> m_in_offset.data();
+  const int *_in_link = csr -> m_in_link.data();
+  const int *_in_tail = csr -> m_in_tail.data();
+  const int *_out_offset = csr -> m_out_offset.data();
+  const int *_out_link = csr -> m_out_link.data();
+  const int *_link_from = csr -> m_link_from.data();
+  const int *_link_to = csr -> m_link_to.data();
+  const double _inf = std::numeric_limits<double>::max();
+
+  MNM_SP_Workspace *_workspace = MNM_SP_Workspace::get_thread_workspace();
+  _workspace -> reserve(csr -> m_num_node);
+  typedef std::pair<double, int> _Entry;
+  std::vector<_Entry> &_Q = _workspace -> m_binary_heap;
+  std::greater<_Entry> _cmp;
+  char *_affected = _workspace -> m_in_Q.data();
+  int *_affected_list = _workspace -> m_queue.data();
+  int _num_affected = 0;
+
+  // 1. a tree link got more expensive: every node whose tree path uses it loses its label
+  for (int c = 0; c < num_changed; ++c){
+    int _link = changed_link[c];
+    int _tail = _link_from[_link];
+    if (cost[_link] <= old_cost[_link] || pred[_tail] != _link || _affected[_tail]) continue;
+    int _first = _num_affected;
+    _affected[_tail] = 1;
+    _affected_list[_num_affected++] = _tail;
+    // the subtree of _tail, children are the tails of in-links that are their tree link
+    for (int a = _first; a < _num_affected; ++a){
+      int _node = _affected_list[a];
+      for (int k = _in_offset[_node]; k < _in_offset[_node + 1]; ++k){
+        int _child = _in_tail[k];
+        if (pred[_child] == _in_link[k] && !_affected[_child]){
+          _affected[_child] = 1;
+          _affected_list[_num_affected++] = _child;
         }
       }
-    delete _min_cost;
+    }
+  }
+  for (int a = 0; a < _num_affected; ++a){
+    dist[_affected_list[a]] = _inf;
+    pred[_affected_list[a]] = -1;
+  }
+  // affected nodes restart from their best unaffected downstream neighbour
+  for (int a = 0; a < _num_affected; ++a){
+    int _node = _affected_list[a];
+    for (int k = _out_offset[_node]; k < _out_offset[_node + 1]; ++k){
+      int _link = _out_link[k];
+      int _head = _link_to[_link];
+      if (_affected[_head] || dist[_head] == _inf) continue;
+      double _alt = dist[_head] + cost[_link];
+      if (_alt < dist[_node] || (_alt == dist[_node] && cost[_link] > 0 && _link < pred[_node])){
+        dist[_node] = _alt;
+        pred[_node] = _link;
+      }
+    }
+    if (dist[_node] < _inf){
+      _Q.push_back(std::make_pair(dist[_node], _node));
+      std::push_heap(_Q.begin(), _Q.end(), _cmp);
+    }
+  }
+  for (int a = 0; a < _num_affected; ++a){
+    _affected[_affected_list[a]] = 0;
+  }
+
+  // 2. a link got cheaper: its tail may improve
+  for (int c = 0; c < num_changed; ++c){
+    int _link = changed_link[c];
+    if (cost[_link] >= old_cost[_link]) continue;
+    int _tail = _link_from[_link];
+    int _head = _link_to[_link];
+    if (dist[_head] == _inf) continue;
+    double _alt = dist[_head] + cost[_link];
+    if (_alt < dist[_tail]){
+      dist[_tail] = _alt;
+      pred[_tail] = _link;
+      _Q.push_back(std::make_pair(_alt, _tail));
+      std::push_heap(_Q.begin(), _Q.end(), _cmp);
+    }
   }
 
+  // 3. propagate the new labels upstream as in the full Dijkstra
+  while (!_Q.empty()){
+    std::pop_heap(_Q.begin(), _Q.end(), _cmp);
+    double _tmp_dist = _Q.back().first;
+    int _node = _Q.back().second;
+    _Q.pop_back();
+    if (_tmp_dist > dist[_node]) continue;
+    MNM_SP_RELAX_IN_LINKS(_node, _tmp_dist, 
+      {_Q.push_back(std::make_pair(_alt, _tail)); std::push_heap(_Q.begin(), _Q.end(), _cmp);})
+  }
   return 0;
 }
 
-int MNM_Shortest_Path::all_to_one_Dijkstra(TInt destination_ID, 
-                        PNEGraph graph, 
-                        std::unordered_map<TInt, TFlt> &dist_to_dest,
-                        std::unordered_map<TInt, TFlt> &cost_map,
-                        std::unordered_map<TInt, TInt> &output_map)
+#undef MNM_SP_RELAX_IN_LINKS
+
+int MNM_Shortest_Path::all_to_one_FIFO(int dest_index, const MNM_Graph_CSR *csr, const double *cost,
+                                       double *dist, int *pred)
 {
-  std::priority_queue<MNM_Cost*, std::vector<MNM_Cost*>, LessThanByCost> m_Q \
-  = std::priority_queue<MNM_Cost*, std::vector<MNM_Cost*>, LessThanByCost>();
-  MNM_Cost *dest_cost = new MNM_Cost(destination_ID, TFlt(0));
-  m_Q.push(dest_cost);
+  const int *_in_offset = csr -> m_in_offset.data();
+  const int *_in_link = csr -> m_in_link.data();
+  const int *_in_tail = csr -> m_in_tail.data();
+  for (int i = 0; i < csr -> m_num_node; ++i){
+    dist[i] = std::numeric_limits<double>::max();
+    pred[i] = -1;
+  }
+  dist[dest_index] = 0.;
 
-  // std::unordered_map<TInt, TFlt> dist_to_dest = std::unordered_map<TInt, TFlt>();
-  dist_to_dest.clear();
-  for (auto _node_it = graph->BegNI(); _node_it < graph->EndNI(); _node_it++){
-    TInt _node_id = _node_it.GetId();
-    if (_node_id != destination_ID){
-      dist_to_dest.insert({_node_id, TFlt(std::numeric_limits<double>::max())});
-      output_map.insert({_node_id, -1});  // If the destination is not accessible the output remains -1
+  // a node is queued at most once at a time, so a ring buffer of num_node is enough
+  MNM_SP_Workspace *_workspace = MNM_SP_Workspace::get_thread_workspace();
+  _workspace -> reserve(csr -> m_num_node);
+  int *_Q = _workspace -> m_queue.data();
+  char *_in_Q = _workspace -> m_in_Q.data();
+  int _num_node = csr -> m_num_node;
+  int _head = 0, _size = 0;
+  _Q[0] = dest_index;
+  _size = 1;
+  _in_Q[dest_index] = 1;
+  while (_size > 0){
+    int _node = _Q[_head];
+    _head = _head + 1 == _num_node ? 0 : _head + 1;
+    _size--;
+    _in_Q[_node] = 0;
+    double _tmp_dist = dist[_node];
+    for (int k = _in_offset[_node]; k < _in_offset[_node + 1]; ++k){
+      int _tail = _in_tail[k];
+      double _alt = _tmp_dist + cost[_in_link[k]];
+      if (_alt < dist[_tail]){
+        dist[_tail] = _alt;
+        pred[_tail] = _in_link[k];
+        if (!_in_Q[_tail]){
+          int _end = _head + _size;
+          _Q[_end >= _num_node ? _end - _num_node : _end] = _tail;
+          _size++;
+          _in_Q[_tail] = 1;
+        }
+      }
     }
   }
-  dist_to_dest[destination_ID] = TFlt(0);
+  return 0;
+}
 
-  // Initializaiton above. Dijkstra with binary min-heap (std::prioitiry_queue) below:
+/*------------------------------------------------------------
+                  one to one on the CSR snapshot
+-------------------------------------------------------------*/
+typedef std::pair<double, int> MNM_SP_Entry;
 
-  // NOTE: Since C++ std::priority_queue does not have decrease_key() function, 
-  // we insert [pointer to new MNM_cost object] to the min-heap every time when
-  // the dist_to_dest[] changes for some node. So there could be duplicated elements
-  // in the min-heap for the same nodes with different distance values. But the duplication
-  // doesn't affect the correctness of algorithm. (visited label for eliminating the 
-  // duplication is also tested, but slower than not using it, kind of weird.)
-  while (m_Q.size() != 0){
-    MNM_Cost *_min_cost = m_Q.top();
-    m_Q.pop();
-    TInt _node_id = _min_cost->m_ID;
-    auto _node_it = graph->GetNI(_node_id);
-    TFlt _tmp_dist = dist_to_dest[_node_id]; 
-      for (int e = 0; e < _node_it.GetInDeg(); e++){
-        TInt _in_node_id = _node_it.GetInNId(e);
-        TInt _in_link_id = graph->GetEI(_in_node_id, _node_id).GetId();
-        TFlt _alt = _tmp_dist + cost_map[_in_link_id];
-        if (_alt < dist_to_dest[_in_node_id]){
-          dist_to_dest[_in_node_id] = _alt;
-          m_Q.push(new MNM_Cost(_in_node_id, _alt));
-          output_map[_in_node_id] = _in_link_id;
+// drop the stale entries on top of a lazy heap
+static inline void clean_heap_top(std::vector<MNM_SP_Entry> &Q, const double *dist)
+{
+  std::greater<MNM_SP_Entry> _cmp;
+  while (!Q.empty() && Q.front().first > dist[Q.front().second]){
+    std::pop_heap(Q.begin(), Q.end(), _cmp);
+    Q.pop_back();
+  }
+}
+
+int MNM_Shortest_Path::one_to_one_Dijkstra(int origin_index, int dest_index, const MNM_Graph_CSR *csr, 
+                                           const double *cost, std::vector<int> &path_link, 
+                                           MNM_SP_Workspace *workspace)
+{
+  path_link.clear();
+  if (origin_index == dest_index) return 0;
+  if (workspace == NULL) workspace = MNM_SP_Workspace::get_thread_workspace();
+  workspace -> start_query(csr -> m_num_node);
+  const unsigned int _stamp = workspace -> m_stamp;
+  const double _inf = std::numeric_limits<double>::max();
+  double *_fwd_dist = workspace -> m_fwd_dist.data();
+  double *_bwd_dist = workspace -> m_bwd_dist.data();
+  int *_fwd_pred = workspace -> m_fwd_pred.data();
+  int *_bwd_pred = workspace -> m_bwd_pred.data();
+  unsigned int *_fwd_stamp = workspace -> m_fwd_stamp.data();
+  unsigned int *_bwd_stamp = workspace -> m_bwd_stamp.data();
+  std::vector<MNM_SP_Entry> &_fwd_Q = workspace -> m_binary_heap;
+  std::vector<MNM_SP_Entry> &_bwd_Q = workspace -> m_bwd_heap;
+  std::greater<MNM_SP_Entry> _cmp;
+
+  _fwd_dist[origin_index] = 0.;
+  _fwd_pred[origin_index] = -1;
+  _fwd_stamp[origin_index] = _stamp;
+  _fwd_Q.push_back(std::make_pair(0., origin_index));
+  _bwd_dist[dest_index] = 0.;
+  _bwd_pred[dest_index] = -1;
+  _bwd_stamp[dest_index] = _stamp;
+  _bwd_Q.push_back(std::make_pair(0., dest_index));
+
+  // best origin -> dest distance seen so far, through _meet_link
+  double _best = _inf;
+  int _meet_link = -1;
+  while (true){
+    clean_heap_top(_fwd_Q, _fwd_dist);
+    clean_heap_top(_bwd_Q, _bwd_dist);
+    if (_fwd_Q.empty() || _bwd_Q.empty()) break;
+    if (_fwd_Q.front().first + _bwd_Q.front().first >= _best) break;
+    if (_fwd_Q.front().first <= _bwd_Q.front().first){
+      std::pop_heap(_fwd_Q.begin(), _fwd_Q.end(), _cmp);
+      double _tmp_dist = _fwd_Q.back().first;
+      int _node = _fwd_Q.back().second;
+      _fwd_Q.pop_back();
+      for (int k = csr -> m_out_offset[_node]; k < csr -> m_out_offset[_node + 1]; ++k){
+        int _link = csr -> m_out_link[k];
+        int _head = csr -> m_link_to[_link];
+        double _alt = _tmp_dist + cost[_link];
+        if (_fwd_stamp[_head] != _stamp || _alt < _fwd_dist[_head]){
+          _fwd_stamp[_head] = _stamp;
+          _fwd_dist[_head] = _alt;
+          _fwd_pred[_head] = _link;
+          _fwd_Q.push_back(std::make_pair(_alt, _head));
+          std::push_heap(_fwd_Q.begin(), _fwd_Q.end(), _cmp);
+        }
+        if (_bwd_stamp[_head] == _stamp && _alt + _bwd_dist[_head] < _best){
+          _best = _alt + _bwd_dist[_head];
+          _meet_link = _link;
+        }
+      }
+    }
+    else{
+      std::pop_heap(_bwd_Q.begin(), _bwd_Q.end(), _cmp);
+      double _tmp_dist = _bwd_Q.back().first;
+      int _node = _bwd_Q.back().second;
+      _bwd_Q.pop_back();
+      for (int k = csr -> m_in_offset[_node]; k < csr -> m_in_offset[_node + 1]; ++k){
+        int _link = csr -> m_in_link[k];
+        int _tail = csr -> m_in_tail[k];
+        double _alt = _tmp_dist + cost[_link];
+        if (_bwd_stamp[_tail] != _stamp || _alt < _bwd_dist[_tail]){
+          _bwd_stamp[_tail] = _stamp;
+          _bwd_dist[_tail] = _alt;
+          _bwd_pred[_tail] = _link;
+          _bwd_Q.push_back(std::make_pair(_alt, _tail));
+          std::push_heap(_bwd_Q.begin(), _bwd_Q.end(), _cmp);
+        }
+        if (_fwd_stamp[_tail] == _stamp && _alt + _fwd_dist[_tail] < _best){
+          _best = _alt + _fwd_dist[_tail];
+          _meet_link = _link;
         }
       }
-    delete _min_cost;
+    }
   }
+  if (_meet_link < 0) return -1;
 
+  for (int _node = csr -> m_link_from[_meet_link]; _node != origin_index; 
+       _node = csr -> m_link_from[_fwd_pred[_node]]){
+    path_link.push_back(_fwd_pred[_node]);
+  }
+  std::reverse(path_link.begin(), path_link.end());
+  path_link.push_back(_meet_link);
+  for (int _node = csr -> m_link_to[_meet_link]; _node != dest_index; 
+       _node = csr -> m_link_to[_bwd_pred[_node]]){
+    path_link.push_back(_bwd_pred[_node]);
+  }
   return 0;
 }
 
-int MNM_Shortest_Path::all_to_one_Dijkstra(TInt destination_ID, 
-                        PNEGraph graph, std::unordered_map<TInt, TFlt*> &cost_map,
-                        std::unordered_map<TInt, TFlt*> &dist_to_dest,
-                        std::unordered_map<TInt, TInt*> &output_map,
-                        TInt cost_position, TInt dist_position, TInt output_position)
+int MNM_Shortest_Path::one_to_one_ALT(int origin_index, int dest_index, const MNM_Graph_CSR *csr, 
+                                      const double *cost, MNM_SP_Landmark *landmark, 
+                                      std::vector<int> &path_link, MNM_SP_Workspace *workspace)
+{
+  path_link.clear();
+  if (origin_index == dest_index) return 0;
+  if (workspace == NULL) workspace = MNM_SP_Workspace::get_thread_workspace();
+  workspace -> start_query(csr -> m_num_node);
+  const unsigned int _stamp = workspace -> m_stamp;
+  double *_dist = workspace -> m_fwd_dist.data();
+  int *_pred = workspace -> m_fwd_pred.data();
+  unsigned int *_dist_stamp = workspace -> m_fwd_stamp.data();
+  // the lower bound of every reached node is computed once and kept in the backward labels
+  double *_bound = workspace -> m_bwd_dist.data();
+  unsigned int *_bound_stamp = workspace -> m_bwd_stamp.data();
+  std::vector<MNM_SP_Entry> &_Q = workspace -> m_binary_heap;
+  std::greater<MNM_SP_Entry> _cmp;
+
+  _dist[origin_index] = 0.;
+  _pred[origin_index] = -1;
+  _dist_stamp[origin_index] = _stamp;
+  _bound[origin_index] = landmark -> lower_bound(origin_index, dest_index);
+  _bound_stamp[origin_index] = _stamp;
+  _Q.push_back(std::make_pair(_bound[origin_index], origin_index));
+  bool _found = false;
+  while (!_Q.empty()){
+    std::pop_heap(_Q.begin(), _Q.end(), _cmp);
+    double _key = _Q.back().first;
+    int _node = _Q.back().second;
+    _Q.pop_back();
+    if (_key > _dist[_node] + _bound[_node]) continue;
+    if (_node == dest_index){
+      _found = true;
+      break;
+    }
+    for (int k = csr -> m_out_offset[_node]; k < csr -> m_out_offset[_node + 1]; ++k){
+      int _link = csr -> m_out_link[k];
+      int _head = csr -> m_link_to[_link];
+      double _alt = _dist[_node] + cost[_link];
+      if (_dist_stamp[_head] != _stamp || _alt < _dist[_head]){
+        if (_bound_stamp[_head] != _stamp){
+          _bound[_head] = landmark -> lower_bound(_head, dest_index);
+          _bound_stamp[_head] = _stamp;
+        }
+        _dist_stamp[_head] = _stamp;
+        _dist[_head] = _alt;
+        _pred[_head] = _link;
+        _Q.push_back(std::make_pair(_alt + _bound[_head], _head));
+        std::push_heap(_Q.begin(), _Q.end(), _cmp);
+      }
+    }
+  }
+  if (!_found) return -1;
+  for (int _node = dest_index; _node != origin_index; _node = csr -> m_link_from[_pred[_node]]){
+    path_link.push_back(_pred[_node]);
+  }
+  std::reverse(path_link.begin(), path_link.end());
+  return 0;
+}
+
+/*------------------------------------------------------------
+                  ALT landmarks
+-------------------------------------------------------------*/
+MNM_SP_Landmark::MNM_SP_Landmark(const MNM_Graph_CSR *csr, int num_landmark)
 {
-  std::priority_queue<MNM_Cost*, std::vector<MNM_Cost*>, LessThanByCost> m_Q \
-  = std::priority_queue<MNM_Cost*, std::vector<MNM_Cost*>, LessThanByCost>();
-  MNM_Cost *dest_cost = new MNM_Cost(destination_ID, TFlt(0));
-  m_Q.push(dest_cost);
+  m_csr = csr;
+  m_max_landmark = std::max(1, std::min(num_landmark, csr -> m_num_node));
+  m_num_landmark = m_max_landmark;
+  m_landmark = std::vector<int>();
+  m_from_landmark = std::vector<double>();
+  m_to_landmark = std::vector<double>();
+}
 
-  // std::unordered_map<TInt, TFlt> dist_to_dest = std::unordered_map<TInt, TFlt>();
+MNM_SP_Landmark::~MNM_SP_Landmark()
+{
+  ;
+}
 
-  for (auto _node_it = graph->BegNI(); _node_it < graph->EndNI(); _node_it++){
-    TInt _node_id = _node_it.GetId();
-    if (_node_id != destination_ID){
-      dist_to_dest[_node_id][dist_position] =  TFlt(std::numeric_limits<double>::max());
-      output_map[_node_id][output_position] = -1;  // If the destination is not accessible the output remains -1
+// distances from origin_index along the out links
+static int one_to_all_Dijkstra(int origin_index, const MNM_Graph_CSR *csr, const double *cost, double *dist,
+                               std::vector<MNM_SP_Entry> &Q)
+{
+  std::greater<MNM_SP_Entry> _cmp;
+  std::fill(dist, dist + csr -> m_num_node, std::numeric_limits<double>::max());
+  dist[origin_index] = 0.;
+  Q.clear();
+  Q.push_back(std::make_pair(0., origin_index));
+  while (!Q.empty()){
+    std::pop_heap(Q.begin(), Q.end(), _cmp);
+    double _tmp_dist = Q.back().first;
+    int _node = Q.back().second;
+    Q.pop_back();
+    if (_tmp_dist > dist[_node]) continue;
+    for (int k = csr -> m_out_offset[_node]; k < csr -> m_out_offset[_node + 1]; ++k){
+      int _head = csr -> m_link_to[csr -> m_out_link[k]];
+      double _alt = _tmp_dist + cost[csr -> m_out_link[k]];
+      if (_alt < dist[_head]){
+        dist[_head] = _alt;
+        Q.push_back(std::make_pair(_alt, _head));
+        std::push_heap(Q.begin(), Q.end(), _cmp);
+      }
     }
   }
-  dist_to_dest[destination_ID][dist_position] = TFlt(0);
+  return 0;
+}
 
-  // Initializaiton above. Dijkstra with binary min-heap (std::prioitiry_queue) below:
+int MNM_SP_Landmark::update(const double *cost)
+{
+  const int _num_node = m_csr -> m_num_node;
+  const double _inf = std::numeric_limits<double>::max();
+  std::vector<double> _from = std::vector<double>(_num_node);
+  std::vector<double> _to = std::vector<double>(_num_node);
+  std::vector<int> _pred = std::vector<int>(_num_node);
+  std::vector<MNM_SP_Entry> _Q = std::vector<MNM_SP_Entry>();
+  // sum of the finite round trip distances to the landmarks picked so far, -1 once picked,
+  // the nodes a landmark can not reach or be reached from stay candidates, so a graph that is
+  // not strongly connected still gets its landmarks
+  std::vector<double> _spread = std::vector<double>(_num_node, 0.);
+  m_num_landmark = m_max_landmark;
+  m_landmark.clear();
+  m_from_landmark.assign(size_t(_num_node) * m_num_landmark, _inf);
+  m_to_landmark.assign(size_t(_num_node) * m_num_landmark, _inf);
 
-  while (m_Q.size() != 0){
-    MNM_Cost *_min_cost = m_Q.top();
-    m_Q.pop();
-    TInt _node_id = _min_cost->m_ID;
-    auto _node_it = graph->GetNI(_node_id);
-    TFlt _tmp_dist = dist_to_dest[_node_id][dist_position]; 
-      for (int e = 0; e < _node_it.GetInDeg(); e++){
-        TInt _in_node_id = _node_it.GetInNId(e);
-        TInt _in_link_id = graph->GetEI(_in_node_id, _node_id).GetId();
-        TFlt _alt = _tmp_dist + cost_map[_in_link_id][cost_position];
-        if (_alt < dist_to_dest[_in_node_id][dist_position]){
-          dist_to_dest[_in_node_id][dist_position] = _alt;
-          m_Q.push(new MNM_Cost(_in_node_id, _alt));
-          output_map[_in_node_id][output_position] = _in_link_id;
-        }
+  // the first landmark is the node farthest from node 0, then the farthest from the landmarks
+  one_to_all_Dijkstra(0, m_csr, cost, _from.data(), _Q);
+  int _next = 0;
+  for (int i = 0; i < _num_node; ++i){
+    if (_from[i] < _inf && _from[i] > _from[_next]) _next = i;
+  }
+  for (int l = 0; l < m_num_landmark; ++l){
+    m_landmark.push_back(_next);
+    _spread[_next] = -1.;
+    one_to_all_Dijkstra(_next, m_csr, cost, _from.data(), _Q);
+    MNM_Shortest_Path::all_to_one_Dijkstra(_next, m_csr, cost, _to.data(), _pred.data());
+    for (int i = 0; i < _num_node; ++i){
+      m_from_landmark[size_t(i) * m_num_landmark + l] = _from[i];
+      m_to_landmark[size_t(i) * m_num_landmark + l] = _to[i];
+      if (_spread[i] < 0) continue;
+      if (_from[i] < _inf) _spread[i] += _from[i];
+      if (_to[i] < _inf) _spread[i] += _to[i];
+    }
+    _next = -1;
+    for (int i = 0; i < _num_node; ++i){
+      if (_spread[i] < 0) continue;
+      if (_next < 0 || _spread[i] > _spread[_next]) _next = i;
+    }
+    if (_next < 0) break;
+  }
+
+  // every node is a landmark, the rows are moved to the smaller stride before they are cut
+  int _num_landmark = int(m_landmark.size());
+  if (_num_landmark < m_num_landmark){
+    for (int i = 0; i < _num_node; ++i){
+      for (int l = 0; l < _num_landmark; ++l){
+        m_from_landmark[size_t(i) * _num_landmark + l] = m_from_landmark[size_t(i) * m_num_landmark + l];
+        m_to_landmark[size_t(i) * _num_landmark + l] = m_to_landmark[size_t(i) * m_num_landmark + l];
       }
-    delete _min_cost;
+    }
+    m_num_landmark = _num_landmark;
+    m_from_landmark.resize(size_t(_num_node) * m_num_landmark);
+    m_to_landmark.resize(size_t(_num_node) * m_num_landmark);
+  }
+  return 0;
+}
+
+double MNM_SP_Landmark::lower_bound(int node_index, int dest_index)
+{
+  // d(v, t) >= d(v, L) - d(t, L) and d(v, t) >= d(L, t) - d(L, v), only where both are finite
+  const double _inf = std::numeric_limits<double>::max();
+  const double *_to_v = m_to_landmark.data() + size_t(node_index) * m_num_landmark;
+  const double *_to_t = m_to_landmark.data() + size_t(dest_index) * m_num_landmark;
+  const double *_from_v = m_from_landmark.data() + size_t(node_index) * m_num_landmark;
+  const double *_from_t = m_from_landmark.data() + size_t(dest_index) * m_num_landmark;
+  double _bound = 0.;
+  for (int l = 0; l < m_num_landmark; ++l){
+    if (_to_v[l] < _inf && _to_t[l] < _inf) _bound = std::max(_bound, _to_v[l] - _to_t[l]);
+    if (_from_t[l] < _inf && _from_v[l] < _inf) _bound = std::max(_bound, _from_t[l] - _from_v[l]);
+  }
+  return _bound;
+}
+
+/*------------------------------------------------------------
+                  map based adapters
+-------------------------------------------------------------*/
+int MNM_Shortest_Path::all_to_one_Dijkstra(TInt destination_ID, 
+                        PNEGraph graph, std::unordered_map<TInt, TFlt> &cost_map,
+                        std::unordered_map<TInt, TInt> &output_map)
+{
+  std::unordered_map<TInt, TFlt> _dist_to_dest = std::unordered_map<TInt, TFlt>();
+  return all_to_one_Dijkstra(destination_ID, graph, _dist_to_dest, cost_map, output_map);
+}
+
+int MNM_Shortest_Path::all_to_one_Dijkstra(TInt destination_ID, 
+                        PNEGraph graph, 
+                        std::unordered_map<TInt, TFlt> &dist_to_dest,
+                        std::unordered_map<TInt, TFlt> &cost_map,
+                        std::unordered_map<TInt, TInt> &output_map)
+{
+  return all_to_one_Dijkstra(destination_ID, MNM_Graph_CSR::get_snapshot(graph), dist_to_dest, cost_map, output_map);
+}
+
+int MNM_Shortest_Path::all_to_one_Dijkstra(TInt destination_ID, 
+                        const MNM_Graph_CSR *csr, 
+                        std::unordered_map<TInt, TFlt> &dist_to_dest,
+                        const std::unordered_map<TInt, TFlt> &cost_map,
+                        std::unordered_map<TInt, TInt> &output_map)
+{
+  std::vector<double> _cost = std::vector<double>(csr -> m_num_link);
+  std::vector<double> _dist = std::vector<double>(csr -> m_num_node);
+  std::vector<int> _pred = std::vector<int>(csr -> m_num_node);
+  csr -> build_cost_array(cost_map, _cost.data());
+  int _dest_index = csr -> get_node_index(destination_ID);
+  all_to_one_Dijkstra(_dest_index, csr, _cost.data(), _dist.data(), _pred.data());
+
+  dist_to_dest.clear();
+  for (int i = 0; i < csr -> m_num_node; ++i){
+    dist_to_dest[csr -> m_node_ID[i]] = TFlt(_dist[i]);
+    // If the destination is not accessible the output remains -1
+    if (i != _dest_index){
+      output_map[csr -> m_node_ID[i]] = _pred[i] < 0 ? TInt(-1) : TInt(csr -> m_link_ID[_pred[i]]);
+    }
+  }
+  return 0;
+}
+
+int MNM_Shortest_Path::all_to_one_Dijkstra(TInt destination_ID, 
+                        PNEGraph graph, std::unordered_map<TInt, TFlt*> &cost_map,
+                        std::unordered_map<TInt, TFlt*> &dist_to_dest,
+                        std::unordered_map<TInt, TInt*> &output_map,
+                        TInt cost_position, TInt dist_position, TInt output_position)
+{
+  return all_to_one_Dijkstra(destination_ID, MNM_Graph_CSR::get_snapshot(graph), cost_map, dist_to_dest, output_map,
+                             cost_position, dist_position, output_position);
+}
+
+int MNM_Shortest_Path::all_to_one_Dijkstra(TInt destination_ID, 
+                        const MNM_Graph_CSR *csr, std::unordered_map<TInt, TFlt*> &cost_map,
+                        std::unordered_map<TInt, TFlt*> &dist_to_dest,
+                        std::unordered_map<TInt, TInt*> &output_map,
+                        TInt cost_position, TInt dist_position, TInt output_position)
+{
+  std::vector<double> _cost = std::vector<double>(csr -> m_num_link);
+  std::vector<double> _dist = std::vector<double>(csr -> m_num_node);
+  std::vector<int> _pred = std::vector<int>(csr -> m_num_node);
+  for (int e = 0; e < csr -> m_num_link; ++e){
+    _cost[e] = cost_map[csr -> m_link_ID[e]][cost_position]();
   }
+  int _dest_index = csr -> get_node_index(destination_ID);
+  all_to_one_Dijkstra(_dest_index, csr, _cost.data(), _dist.data(), _pred.data());
 
+  for (int i = 0; i < csr -> m_num_node; ++i){
+    dist_to_dest[csr -> m_node_ID[i]][dist_position] = TFlt(_dist[i]);
+    if (i != _dest_index){
+      output_map[csr -> m_node_ID[i]][output_position] = _pred[i] < 0 ? TInt(-1) : TInt(csr -> m_link_ID[_pred[i]]);
+    }
+  }
   return 0;
 }
 
@@ -240,70 +968,25 @@ int MNM_Shortest_Path::all_to_one_FIFO(TInt dest_node_ID,
                       PNEGraph graph, const std::unordered_map<TInt, TFlt>& cost_map,
                       std::unordered_map<TInt, TInt> &output_map)
 {
-  // if (output_map.size() != 0){
-  //   // printf("Output map already exist, clear!\n");
-  //   output_map.clear();
-  // }
-
-  // for (auto _map_it : cost_map){
-  //   printf("For link ID %d, it's cost is %.4f\n", _map_it.first(), _map_it.second());
-  // }
-
-  std::unordered_map<TInt, TFlt> _dist = std::unordered_map<TInt, TFlt>();
-  _dist.insert(std::pair<TInt, TFlt>(dest_node_ID, TFlt(0)));
-  
-  std::deque<TInt> m_Q = std::deque<TInt>();
-  std::unordered_map<TInt, bool> m_Q_support = std::unordered_map<TInt, bool>();
+  return all_to_one_FIFO(dest_node_ID, MNM_Graph_CSR::get_snapshot(graph), cost_map, output_map);
+}
 
-  m_Q.push_back(dest_node_ID);
-  m_Q_support.insert(std::pair<TInt, bool>(dest_node_ID, true));
+int MNM_Shortest_Path::all_to_one_FIFO(TInt dest_node_ID, 
+                      const MNM_Graph_CSR *csr, const std::unordered_map<TInt, TFlt>& cost_map,
+                      std::unordered_map<TInt, TInt> &output_map)
+{
+  std::vector<double> _cost = std::vector<double>(csr -> m_num_link);
+  std::vector<double> _dist = std::vector<double>(csr -> m_num_node);
+  std::vector<int> _pred = std::vector<int>(csr -> m_num_node);
+  csr -> build_cost_array(cost_map, _cost.data());
+  int _dest_index = csr -> get_node_index(dest_node_ID);
+  all_to_one_FIFO(_dest_index, csr, _cost.data(), _dist.data(), _pred.data());
 
-  TInt _node_ID;
-  for (auto _node_it = graph->BegNI(); _node_it < graph->EndNI(); _node_it++) {
-    // printf("node id %d with out-degree %d and in-degree %d\n",
-      // _node_it.GetId(), _node_it.GetOutDeg(), _node_it.GetInDeg());
-    _node_ID = _node_it.GetId();
-    if (_node_ID != dest_node_ID){
-      _dist.insert(std::pair<TInt, TFlt>(_node_ID, DBL_MAX));
-      if (output_map.find(_node_ID) != output_map.end()){
-        output_map.find(_node_ID) -> second = -1;
-      }
-      else{
-        output_map.insert(std::pair<TInt, TInt>(_node_ID, -1));
-      }
-      m_Q_support.insert(std::pair<TInt, bool>(_node_ID, false));
+  for (int i = 0; i < csr -> m_num_node; ++i){
+    if (i != _dest_index){
+      output_map[csr -> m_node_ID[i]] = _pred[i] < 0 ? TInt(-1) : TInt(csr -> m_link_ID[_pred[i]]);
     }
   }
-  TInt _in_node_ID, _tmp_ID, _in_link_ID;
-  TFlt _alt, _tmp_dist;
-  while (m_Q.size() != 0){
-    // printf("current m_Q size is %d\n", m_Q.size());
-    _tmp_ID = m_Q.front();
-    m_Q.pop_front();
-    m_Q_support.find(_tmp_ID) -> second = false;
-    auto _node_it = graph -> GetNI(_tmp_ID);
-    _tmp_dist = _dist.find(_tmp_ID) -> second;
-    for (int e = 0; e < _node_it.GetInDeg(); ++e){
-      _in_node_ID = _node_it.GetInNId(e);
-      // m_Q.push_back(m_Q_support.find(_in_node_ID) -> second);
-      _in_link_ID = graph -> GetEI(_in_node_ID, _tmp_ID).GetId();
-      _alt = _tmp_dist + cost_map.find(_in_link_ID) -> second;
-      // printf("Current alternative distance is %.4f\n", _alt());
-      if (_alt < _dist.find(_in_node_ID) -> second){
-        // m_Q.push_back(m_Q_support.find(_in_node_ID) -> second);
-        _dist.find(_in_node_ID) -> second = _alt;
-        output_map.find(_in_node_ID) -> second = _in_link_ID;
-        if (!m_Q_support.find(_in_node_ID) -> second){
-          m_Q.push_back(_in_node_ID);
-          m_Q_support.find(_in_node_ID) -> second = true;
-        }
-      }
-    }
-  }
-
-  m_Q.clear();
-  m_Q_support.clear();
-  _dist.clear();
   return 0;
 }
 
@@ -422,91 +1105,162 @@ bool MNM_Shortest_Path::is_FIFO(PNEGraph graph, std::unordered_map<TInt, TFlt*>&
                   TDSP  one destination tree
 -------------------------------------------------------------*/
 MNM_TDSP_Tree::MNM_TDSP_Tree(TInt dest_node_ID, PNEGraph graph, TInt max_interval)
+  : MNM_TDSP_Tree(dest_node_ID, new MNM_Graph_CSR(graph), max_interval)
+{
+  m_own_csr = true;
+}
+
+MNM_TDSP_Tree::MNM_TDSP_Tree(TInt dest_node_ID, MNM_Graph_CSR *csr, TInt max_interval)
 {
-  m_dist = std::unordered_map<TInt, TFlt*>();
-  m_tree = std::unordered_map<TInt, TInt*>();
+  m_dist = std::vector<float>();
+  m_tree = std::vector<int>();
   m_dest_node_ID = dest_node_ID;
-  m_graph = graph;
+  m_csr = csr;
+  m_own_csr = false;
+  m_dest_index = m_csr -> get_node_index(dest_node_ID);
   m_max_interval = max_interval;
+  m_cost = NULL;
+  m_cost_buffer = std::vector<float>();
+  m_relax = std::vector<float>();
+  m_last_cost = std::vector<double>();
+  m_last_dist = std::vector<double>();
 }
 
 MNM_TDSP_Tree::~MNM_TDSP_Tree()
 {
-  TInt _node_ID;
-  for (auto _node_it = m_graph->BegNI(); _node_it < m_graph->EndNI(); _node_it++) {
-    _node_ID = _node_it.GetId();
-    if (m_dist[_node_ID] != NULL) delete m_dist[_node_ID];
-    if (m_tree[_node_ID] != NULL) delete m_tree[_node_ID];    
-  }
   m_dist.clear();
   m_tree.clear();
+  if (m_own_csr) delete m_csr;
 }
 
 
 int MNM_TDSP_Tree::initialize()
 {
-  TInt _node_ID;
-  for (auto _node_it = m_graph->BegNI(); _node_it < m_graph->EndNI(); _node_it++) {
-    _node_ID = _node_it.GetId();
-    m_dist.insert({_node_ID, new TFlt [m_max_interval]});
-    m_tree.insert({_node_ID, new TInt [m_max_interval]});
-  }
+  size_t _size = size_t(m_max_interval) * m_csr -> m_num_node;
+  m_dist.assign(_size, std::numeric_limits<float>::infinity());
+  m_tree.assign(_size, -1);
+  m_relax.resize(m_csr -> m_num_link);
+  m_last_cost.resize(m_csr -> m_num_link);
+  m_last_dist.resize(m_csr -> m_num_node);
   return 0;
 }
 
-int MNM_TDSP_Tree::update_tree(std::unordered_map<TInt, TFlt*>& cost_map)
+int MNM_TDSP_Tree::build_cost_array(const MNM_Graph_CSR *csr, const std::unordered_map<TInt, TFlt*>& cost_map,
+                                    TInt max_interval, std::vector<float> &cost)
 {
-  // printf("Init in update tree\n");
-  // init tree and cost
-  TInt _node_ID;
-  for (auto _node_it = m_graph->BegNI(); _node_it < m_graph->EndNI(); _node_it++) {
-    for (int t=0; t<m_max_interval; ++t){
-      _node_ID = _node_it.GetId();
-      m_dist[_node_ID][t] = _node_ID == m_dest_node_ID ?
-                             TFlt(0) : 
-                             TFlt(std::numeric_limits<double>::max());
-      m_tree[_node_ID][t] = -1;
+  int _num_link = csr -> m_num_link;
+  cost.assign(size_t(max_interval) * _num_link, 0.0f);
+  for (int i = 0; i < _num_link; ++i){
+    auto _it = cost_map.find(csr -> m_link_ID[i]);
+    if (_it == cost_map.end()) continue;
+    for (int t = 0; t < max_interval; ++t){
+      cost[size_t(t) * _num_link + i] = float(_it -> second[t]);
     }
   }
+  return 0;
+}
+
+int MNM_TDSP_Tree::update_tree(std::unordered_map<TInt, TFlt*>& cost_map)
+{
+  build_cost_array(m_csr, cost_map, m_max_interval, m_cost_buffer);
+  return update_tree(m_cost_buffer.data());
+}
+
+int MNM_TDSP_Tree::update_tree(const float *cost)
+{
+  const int _num_node = m_csr -> m_num_node;
+  const int _num_link = m_csr -> m_num_link;
+  const int _last = int(m_max_interval) - 1;
+  const float _inf = std::numeric_limits<float>::infinity();
+  m_cost = cost;
+  std::fill(m_dist.begin(), m_dist.end(), _inf);
+  std::fill(m_tree.begin(), m_tree.end(), -1);
 
-  // printf("SP in last t\n");
   // run last time interval
-  MNM_Shortest_Path::all_to_one_Dijkstra(m_dest_node_ID, m_graph, cost_map, m_dist, m_tree,
-                                        m_max_interval-1, m_max_interval-1, m_max_interval-1);
-  // printf("Process M-2 to 0\n");
-  // main loop for t = M-2 down to 0
-  TFlt _temp_cost, _edge_cost;
-  TInt _src_node, _dst_node;
-  for (int t=m_max_interval-2; t > -1; t--){
-    // printf("%d\n", t);
-    for (auto _edge_it = m_graph->BegEI(); _edge_it < m_graph -> EndEI(); _edge_it++){
-      _dst_node = _edge_it.GetDstNId();
-      _src_node = _edge_it.GetSrcNId();
-      _edge_cost = cost_map[_edge_it.GetId()][t];
-      _temp_cost = _edge_cost + get_distance_to_destination(_dst_node, TFlt(t) + _edge_cost);
-      if (m_dist[_src_node][t] > _temp_cost){
-        // printf("At time %d, src %d to des %d\n", t, _src_node(), _edge_it.GetDstNId());
-        m_dist[_src_node][t] = _temp_cost;
-        m_tree[_src_node][t] = _edge_it.GetId();
+  const float *_cost_t = cost + size_t(_last) * _num_link;
+  for (int i = 0; i < _num_link; ++i){
+    m_last_cost[i] = double(_cost_t[i]);
+  }
+  float *_dist_t = m_dist.data() + size_t(_last) * _num_node;
+  MNM_Shortest_Path::all_to_one_Dijkstra(m_dest_index, m_csr, m_last_cost.data(), m_last_dist.data(),
+                                         m_tree.data() + size_t(_last) * _num_node);
+  for (int i = 0; i < _num_node; ++i){
+    _dist_t[i] = m_last_dist[i] == std::numeric_limits<double>::max() ? _inf : float(m_last_dist[i]);
+  }
+
+  // main loop for t = M-2 down to 0, every link reads a later interval so all links relax at once
+  const int *_link_to = m_csr -> m_link_to.data();
+  const int *_out_offset = m_csr -> m_out_offset.data();
+  const int *_out_link = m_csr -> m_out_link.data();
+  const float *_dist = m_dist.data();
+  float *_relax = m_relax.data();
+  int *_tree_t;
+  for (int t = _last - 1; t > -1; t--){
+    _cost_t = cost + size_t(t) * _num_link;
+    #pragma omp simd
+    for (int i = 0; i < _num_link; ++i){
+      float _arrival = float(t) + _cost_t[i];
+      int _tau = _arrival >= float(_last) ? _last : int(_arrival) + 1;
+      _relax[i] = _cost_t[i] + _dist[size_t(_tau) * _num_node + _link_to[i]];
+    }
+    _dist_t = m_dist.data() + size_t(t) * _num_node;
+    _tree_t = m_tree.data() + size_t(t) * _num_node;
+    _dist_t[m_dest_index] = 0.0f;
+    // out links are in link order, so ties keep the first link as the edge scan did
+    for (int v = 0; v < _num_node; ++v){
+      for (int p = _out_offset[v]; p < _out_offset[v + 1]; ++p){
+        if (_dist_t[v] > _relax[_out_link[p]]){
+          _dist_t[v] = _relax[_out_link[p]];
+          _tree_t[v] = _out_link[p];
+        }
       }
     }
   }
-  // printf("Finished update tree\n");
+  return 0;
+}
+
+int MNM_TDSP_Tree::get_next_link(int node_index, int interval)
+{
+  return m_tree[size_t(interval) * m_csr -> m_num_node + node_index];
+}
+
+int MNM_TDSP_Tree::get_tdsp(TInt src_node_ID, TInt time, MNM_Path* path)
+{
+  const int _num_link = m_csr -> m_num_link;
+  int _cur_node = m_csr -> get_node_index(src_node_ID);
+  int _cur_link, _tau;
+  TFlt _cur_time = TFlt(time);
+  while (_cur_node != m_dest_index){
+    path -> m_node_vec.push_back(m_csr -> m_node_ID[_cur_node]);
+    _tau = round_time(_cur_time);
+    _cur_link = get_next_link(_cur_node, _tau);
+    if (_cur_link < 0){
+      printf("MNM_TDSP_Tree::get_tdsp, node %d can not reach destination %d\n", 
+             m_csr -> m_node_ID[_cur_node], (int)m_dest_node_ID);
+      exit(-1);
+    }
+    path -> m_link_vec.push_back(m_csr -> m_link_ID[_cur_link]);
+    _cur_time += m_cost[size_t(_tau) * _num_link + _cur_link];
+    _cur_node = m_csr -> m_link_to[_cur_link];
+  }
+  path -> m_node_vec.push_back(m_dest_node_ID);
   return 0;
 }
 
 int MNM_TDSP_Tree::get_tdsp(TInt src_node_ID, TInt time, std::unordered_map<TInt, TFlt*>& cost_map, 
                             MNM_Path* path)
 {
-  TInt _cur_node_ID = src_node_ID;
-  TInt _cur_link_ID;
+  int _cur_node = m_csr -> get_node_index(src_node_ID);
+  int _cur_link, _tau;
   TFlt _cur_time = TFlt(time);
-  while (_cur_node_ID != m_dest_node_ID){
-    path -> m_node_vec.push_back(_cur_node_ID);
-    _cur_link_ID = m_tree[_cur_node_ID][round_time(_cur_time)];
-    path -> m_link_vec.push_back(_cur_link_ID);
-    _cur_time += cost_map[_cur_link_ID][round_time(_cur_time)];
-    _cur_node_ID = m_graph -> GetEI(_cur_link_ID).GetDstNId();
+  while (_cur_node != m_dest_index){
+    path -> m_node_vec.push_back(m_csr -> m_node_ID[_cur_node]);
+    _tau = round_time(_cur_time);
+    _cur_link = get_next_link(_cur_node, _tau);
+    IAssert(_cur_link >= 0);
+    path -> m_link_vec.push_back(m_csr -> m_link_ID[_cur_link]);
+    _cur_time += cost_map.find(m_csr -> m_link_ID[_cur_link]) -> second[_tau];
+    _cur_node = m_csr -> m_link_to[_cur_link];
   }
   path -> m_node_vec.push_back(m_dest_node_ID);  
   return 0;
@@ -515,17 +1269,13 @@ int MNM_TDSP_Tree::get_tdsp(TInt src_node_ID, TInt time, std::unordered_map<TInt
 
 TFlt MNM_TDSP_Tree::get_distance_to_destination(TInt node_ID, TFlt time_stamp)
 {
-  IAssert(m_dist.find(node_ID) != m_dist.end());
-  IAssert(m_dist[node_ID] != NULL);
   IAssert(time_stamp >= 0);
-  // printf("Current time stamp is %lf, %d\n", time_stamp, int(time_stamp)+ 1);
-
-  // if (time_stamp >= TFlt(m_max_interval - 1)){
-  //   // printf("Enter if\n");
-  //   return m_dist[node_ID][m_max_interval - 1];
-  // }
-  // return m_dist[node_ID][int(time_stamp)];
-  return m_dist[node_ID][round_time(time_stamp)];
+  float _dist = m_dist[size_t(round_time(time_stamp)) * m_csr -> m_num_node + m_csr -> get_node_index(node_ID)];
+  // unreachable nodes keep reporting the double max as before
+  if (_dist == std::numeric_limits<float>::infinity()){
+    return TFlt(std::numeric_limits<double>::max());
+  }
+  return TFlt(_dist);
 }
 
 
@@ -535,4 +1285,178 @@ int MNM_TDSP_Tree::round_time(TFlt time_stamp){
     return int(m_max_interval - 1);
   }
   return int(time_stamp) + 1;
-}
\ No newline at end of file
+}
+
+/*------------------------------------------------------------
+                  TDSP  memory bounded tree
+-------------------------------------------------------------*/
+MNM_TDSP_Tree_Compact::MNM_TDSP_Tree_Compact(TInt dest_node_ID, MNM_Graph_CSR *csr, TInt max_interval,
+                                             const std::string &pred_folder, const std::vector<TInt> &track_node_ID)
+  : MNM_TDSP_Tree(dest_node_ID, csr, max_interval)
+{
+  m_pred_folder = pred_folder;
+  if (m_pred_folder.empty()){
+    const char *_tmp_dir = getenv("TMPDIR");
+    m_pred_folder = (_tmp_dir != NULL && _tmp_dir[0] != '\0') ? _tmp_dir : "/tmp";
+  }
+  m_pred = NULL;
+  m_pred_size = 0;
+  m_window_size = 0;
+  m_window = std::vector<float>();
+  m_last_pred = std::vector<int>();
+  m_out_pos = std::vector<uint16_t>();
+  m_track_index = std::unordered_map<TInt, int>();
+  m_track_node = std::vector<int>();
+  m_track_dist = std::vector<float>();
+  for (TInt _node_ID : track_node_ID){
+    if (m_track_index.find(_node_ID) != m_track_index.end()) continue;
+    m_track_index.insert({_node_ID, int(m_track_node.size())});
+    m_track_node.push_back(m_csr -> get_node_index(_node_ID));
+  }
+}
+
+MNM_TDSP_Tree_Compact::~MNM_TDSP_Tree_Compact()
+{
+  if (m_pred != NULL) munmap(m_pred, m_pred_size);
+  m_track_index.clear();
+}
+
+int MNM_TDSP_Tree_Compact::initialize()
+{
+  const int _num_node = m_csr -> m_num_node;
+  const int _num_link = m_csr -> m_num_link;
+  m_out_pos.resize(_num_link);
+  for (int v = 0; v < _num_node; ++v){
+    if (m_csr -> m_out_offset[v + 1] - m_csr -> m_out_offset[v] >= MNM_TDSP_NO_PRED){
+      printf("MNM_TDSP_Tree_Compact::initialize, node %d has too many out links\n", m_csr -> m_node_ID[v]);
+      exit(-1);
+    }
+    for (int p = m_csr -> m_out_offset[v]; p < m_csr -> m_out_offset[v + 1]; ++p){
+      m_out_pos[m_csr -> m_out_link[p]] = uint16_t(p - m_csr -> m_out_offset[v]);
+    }
+  }
+  m_relax.resize(_num_link);
+  m_last_cost.resize(_num_link);
+  m_last_dist.resize(_num_node);
+  m_last_pred.resize(_num_node);
+  m_track_dist.assign(size_t(m_max_interval) * m_track_node.size(), std::numeric_limits<float>::infinity());
+
+  if (m_pred != NULL) return 0;
+  m_pred_size = size_t(m_max_interval) * _num_node * sizeof(uint16_t);
+  // the name is gone once the file is mapped, nothing is left behind if the run dies
+  std::string _pred_file = m_pred_folder + "/tdsp_pred_XXXXXX";
+  int _fd = mkstemp(&_pred_file[0]);
+  if (_fd < 0){
+    printf("MNM_TDSP_Tree_Compact::initialize, can not create a file in %s\n", m_pred_folder.c_str());
+    exit(-1);
+  }
+  if (ftruncate(_fd, m_pred_size) != 0){
+    printf("MNM_TDSP_Tree_Compact::initialize, can not resize %s\n", _pred_file.c_str());
+    unlink(_pred_file.c_str());
+    exit(-1);
+  }
+  void *_map = mmap(NULL, m_pred_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+  unlink(_pred_file.c_str());
+  close(_fd);
+  if (_map == MAP_FAILED){
+    printf("MNM_TDSP_Tree_Compact::initialize, can not map %s\n", _pred_file.c_str());
+    exit(-1);
+  }
+  m_pred = (uint16_t*) _map;
+  return 0;
+}
+
+int MNM_TDSP_Tree_Compact::update_tree(const float *cost)
+{
+  const int _num_node = m_csr -> m_num_node;
+  const int _num_link = m_csr -> m_num_link;
+  const int _num_track = int(m_track_node.size());
+  const int _last = int(m_max_interval) - 1;
+  const float _inf = std::numeric_limits<float>::infinity();
+  m_cost = cost;
+
+  // interval t reads t+1 .. t+1+floor(max cost) and the last interval, which sits in the extra slot
+  float _max_cost = 0.0f;
+  for (size_t i = 0; i < size_t(m_max_interval) * _num_link; ++i){
+    _max_cost = std::max(_max_cost, cost[i]);
+  }
+  // compared as float first, int() of a cost past the int range is undefined
+  m_window_size = _max_cost >= float(_last) ? _last : int(_max_cost) + 1;
+  m_window_size = std::max(1, m_window_size);
+  m_window.assign(size_t(m_window_size + 1) * _num_node, _inf);
+  const int _window_size = m_window_size;
+
+  // run last time interval
+  const float *_cost_t = cost + size_t(_last) * _num_link;
+  for (int i = 0; i < _num_link; ++i){
+    m_last_cost[i] = double(_cost_t[i]);
+  }
+  MNM_Shortest_Path::all_to_one_Dijkstra(m_dest_index, m_csr, m_last_cost.data(), m_last_dist.data(),
+                                         m_last_pred.data());
+  float *_dist_t = m_window.data() + size_t(_window_size) * _num_node;
+  uint16_t *_pred_t = m_pred + size_t(_last) * _num_node;
+  for (int i = 0; i < _num_node; ++i){
+    _dist_t[i] = m_last_dist[i] == std::numeric_limits<double>::max() ? _inf : float(m_last_dist[i]);
+    _pred_t[i] = m_last_pred[i] < 0 ? MNM_TDSP_NO_PRED : m_out_pos[m_last_pred[i]];
+  }
+  for (int k = 0; k < _num_track; ++k){
+    m_track_dist[size_t(_last) * _num_track + k] = _dist_t[m_track_node[k]];
+  }
+
+  // main loop for t = M-2 down to 0, the slot of t is only overwritten after all links are relaxed
+  const int *_link_to = m_csr -> m_link_to.data();
+  const int *_out_offset = m_csr -> m_out_offset.data();
+  const int *_out_link = m_csr -> m_out_link.data();
+  const float *_window = m_window.data();
+  float *_relax = m_relax.data();
+  for (int t = _last - 1; t > -1; t--){
+    _cost_t = cost + size_t(t) * _num_link;
+    #pragma omp simd
+    for (int i = 0; i < _num_link; ++i){
+      float _arrival = float(t) + _cost_t[i];
+      int _tau = _arrival >= float(_last) ? _last : int(_arrival) + 1;
+      int _slot = _tau == _last ? _window_size : _tau % _window_size;
+      _relax[i] = _cost_t[i] + _window[size_t(_slot) * _num_node + _link_to[i]];
+    }
+    _dist_t = m_window.data() + size_t(t % _window_size) * _num_node;
+    _pred_t = m_pred + size_t(t) * _num_node;
+    std::fill(_dist_t, _dist_t + _num_node, _inf);
+    std::fill(_pred_t, _pred_t + _num_node, MNM_TDSP_NO_PRED);
+    _dist_t[m_dest_index] = 0.0f;
+    for (int v = 0; v < _num_node; ++v){
+      for (int p = _out_offset[v]; p < _out_offset[v + 1]; ++p){
+        if (_dist_t[v] > _relax[_out_link[p]]){
+          _dist_t[v] = _relax[_out_link[p]];
+          _pred_t[v] = uint16_t(p - _out_offset[v]);
+        }
+      }
+    }
+    for (int k = 0; k < _num_track; ++k){
+      m_track_dist[size_t(t) * _num_track + k] = _dist_t[m_track_node[k]];
+    }
+  }
+  return 0;
+}
+
+TFlt MNM_TDSP_Tree_Compact::get_distance_to_destination(TInt node_ID, TFlt time_stamp)
+{
+  IAssert(time_stamp >= 0);
+  if (node_ID == m_dest_node_ID) return TFlt(0);
+  auto _it = m_track_index.find(node_ID);
+  if (_it == m_track_index.end()){
+    printf("MNM_TDSP_Tree_Compact::get_distance_to_destination, node %d is not tracked\n", (int)node_ID);
+    exit(-1);
+  }
+  float _dist = m_track_dist[size_t(round_time(time_stamp)) * m_track_node.size() + _it -> second];
+  if (_dist == std::numeric_limits<float>::infinity()){
+    return TFlt(std::numeric_limits<double>::max());
+  }
+  return TFlt(_dist);
+}
+
+int MNM_TDSP_Tree_Compact::get_next_link(int node_index, int interval)
+{
+  uint16_t _offset = m_pred[size_t(interval) * m_csr -> m_num_node + node_index];
+  if (_offset == MNM_TDSP_NO_PRED) return -1;
+  return m_csr -> m_out_link[m_csr -> m_out_offset[node_index] + _offset];
+}
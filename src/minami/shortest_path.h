@@ -4,21 +4,158 @@
 #include "Snap.h"
 #include "path.h"
 #include "ults.h"
+#include "enum.h"
+
+#include "radix_heap.h"
 
 #include <vector>
 #include <unordered_map>
 #include <deque>
 #include <algorithm>
+#include <string>
+#include <cstdint>
 
 class MNM_Link_Cost;
 class MNM_Path;
 
+/*------------------------------------------------------------
+                  CSR snapshot of the graph
+-------------------------------------------------------------*/
+// immutable reverse-CSR copy of a PNEGraph with dense node/link indices,
+// the links entering node i are m_in_link[m_in_offset[i] .. m_in_offset[i+1])
+class MNM_Graph_CSR
+{
+public:
+  MNM_Graph_CSR(PNEGraph graph);
+  ~MNM_Graph_CSR();
+  int get_node_index(TInt node_ID) const;
+  int get_link_index(TInt link_ID) const;
+  // cost[i] = cost_map[m_link_ID[i]], links missing in cost_map get 0
+  int build_cost_array(const std::unordered_map<TInt, TFlt>& cost_map, double *cost) const;
+  // snapshot of graph kept per thread for the PNEGraph adapters, rebuilt when another graph comes or
+  // the node/link counts of the graph change, a graph edited in place with the same counts needs
+  // clear_snapshot
+  static const MNM_Graph_CSR *get_snapshot(PNEGraph graph);
+  static int clear_snapshot();
+  int m_num_node;
+  int m_num_link;
+  std::vector<int> m_node_ID;
+  std::vector<int> m_link_ID;
+  std::unordered_map<TInt, int> m_node_index;
+  std::unordered_map<TInt, int> m_link_index;
+  std::vector<int> m_link_from;
+  std::vector<int> m_link_to;
+  std::vector<int> m_in_offset;
+  std::vector<int> m_in_link;
+  std::vector<int> m_in_tail;
+  // the links leaving node i are m_out_link[m_out_offset[i] .. m_out_offset[i+1])
+  std::vector<int> m_out_offset;
+  std::vector<int> m_out_link;
+  // heap used by the array Dijkstra, see MNM_Shortest_Path::tune_Dijkstra
+  SP_heap_type m_sp_heap;
+};
+
+// reusable buffers of the array kernels, nothing is allocated once they are warmed up on a graph
+class MNM_SP_Workspace
+{
+public:
+  MNM_SP_Workspace(){m_stamp = 0;};
+  ~MNM_SP_Workspace(){;};
+  int reserve(int num_node);
+  // one workspace per thread, lives as long as the thread
+  static MNM_SP_Workspace* get_thread_workspace();
+  std::vector<std::pair<double, int>> m_binary_heap;
+  radix_heap::pair_radix_heap<double, int> m_radix_heap;
+  std::vector<int> m_dary_heap;
+  std::vector<int> m_heap_pos;
+  std::vector<int> m_queue;
+  std::vector<char> m_in_Q;
+
+  // one to one queries only touch the nodes they reach, labels are valid where the stamp is m_stamp
+  int start_query(int num_node);
+  unsigned int m_stamp;
+  std::vector<double> m_fwd_dist;
+  std::vector<double> m_bwd_dist;
+  std::vector<int> m_fwd_pred;
+  std::vector<int> m_bwd_pred;
+  std::vector<unsigned int> m_fwd_stamp;
+  std::vector<unsigned int> m_bwd_stamp;
+  std::vector<std::pair<double, int>> m_bwd_heap;
+};
+
+// ALT lower bounds: distances from and to a few landmarks, computed once per cost snapshot
+// and shared by all one to one queries on it
+class MNM_SP_Landmark
+{
+public:
+  MNM_SP_Landmark(const MNM_Graph_CSR *csr, int num_landmark = 8);
+  ~MNM_SP_Landmark();
+  // picks the landmarks farthest from the ones already picked and computes their distances,
+  // fewer than m_max_landmark if the graph has fewer nodes to pick
+  int update(const double *cost);
+  // lower bound of the distance from node_index to dest_index
+  double lower_bound(int node_index, int dest_index);
+  const MNM_Graph_CSR *m_csr;
+  int m_max_landmark;
+  int m_num_landmark;
+  std::vector<int> m_landmark;
+  // m_from_landmark[i * num_landmark + l] = d(landmark l, i), m_to_landmark[i * num_landmark + l] = d(i, landmark l)
+  std::vector<double> m_from_landmark;
+  std::vector<double> m_to_landmark;
+};
+
 class MNM_Shortest_Path
 {
 public:
+  // array kernels on a CSR snapshot, cost is indexed by link index, dist and pred by node index,
+  // pred[i] is the index of the first link from node i towards dest, -1 if dest is not reachable
+  // ties on positive cost links go to the lower link index, so every heap gives the same tree
+  int static all_to_one_Dijkstra(int dest_index, const MNM_Graph_CSR *csr, const double *cost,
+                                 double *dist, int *pred);
+  int static all_to_one_Dijkstra(int dest_index, const MNM_Graph_CSR *csr, const double *cost,
+                                 double *dist, int *pred, MNM_SP_Workspace *workspace, SP_heap_type heap);
+  int static all_to_one_FIFO(int dest_index, const MNM_Graph_CSR *csr, const double *cost,
+                             double *dist, int *pred);
+  // repair a tree built by all_to_one_Dijkstra after the costs of changed_link moved from old_cost to cost,
+  // subtrees behind a more expensive tree link are relabelled, cheaper links are relaxed, then Dijkstra resumes
+  int static repair_all_to_one_Dijkstra(int dest_index, const MNM_Graph_CSR *csr, 
+                                        const double *old_cost, const double *cost,
+                                        const int *changed_link, int num_changed,
+                                        double *dist, int *pred);
+  // time every heap on num_tree destinations and keep the fastest in csr -> m_sp_heap
+  int static tune_Dijkstra(MNM_Graph_CSR *csr, const double *cost, int num_tree = 16);
+
+  // point to point on a CSR snapshot, path_link gets the link indices from origin to dest,
+  // returns -1 if dest can not be reached, workspace NULL uses the one of the calling thread
+  int static one_to_one_Dijkstra(int origin_index, int dest_index, const MNM_Graph_CSR *csr, const double *cost,
+                                 std::vector<int> &path_link, MNM_SP_Workspace *workspace = NULL);
+  // A* with the landmark lower bounds, landmark must be updated on the same cost
+  int static one_to_one_ALT(int origin_index, int dest_index, const MNM_Graph_CSR *csr, const double *cost,
+                            MNM_SP_Landmark *landmark, std::vector<int> &path_link, 
+                            MNM_SP_Workspace *workspace = NULL);
+  // output_array gets the link IDs from origin to dest, bidirectional Dijkstra
   int static one_to_one(TInt origin_node_ID, TInt dest_node_ID, 
                         PNEGraph graph, std::unordered_map<TInt, TFlt>& cost_map,
                         std::vector<TInt> &output_array);
+  int static one_to_one(TInt origin_node_ID, TInt dest_node_ID, 
+                        const MNM_Graph_CSR *csr, const std::unordered_map<TInt, TFlt>& cost_map,
+                        std::vector<TInt> &output_array);
+  // the PNEGraph adapters below run on MNM_Graph_CSR::get_snapshot, the overloads taking a csr
+  // only build the cost array
+  int static all_to_one_Dijkstra(TInt destination_ID, 
+                        const MNM_Graph_CSR *csr, 
+                        std::unordered_map<TInt, TFlt> &dist_to_dest,
+                        const std::unordered_map<TInt, TFlt> &cost_map,
+                        std::unordered_map<TInt, TInt> &output_map);
+  int static all_to_one_Dijkstra(TInt destination_ID, 
+                        const MNM_Graph_CSR *csr, std::unordered_map<TInt, TFlt*> &cost_map,
+                        std::unordered_map<TInt, TFlt*> &dist_to_dest,
+                        std::unordered_map<TInt, TInt*> &output_map,
+                        TInt cost_position, TInt dist_position, 
+                        TInt output_position);
+  int static all_to_one_FIFO(TInt dest_node_ID, 
+                        const MNM_Graph_CSR *csr, const std::unordered_map<TInt, TFlt>& cost_map,
+                        std::unordered_map<TInt, TInt> &output_map);
   int static all_to_one_Dijkstra(TInt dest_node_ID, 
                         PNEGraph graph, std::unordered_map<TInt, TFlt>& cost_map,
                         std::unordered_map<TInt, TInt> &output_map);
@@ -75,19 +212,73 @@ class MNM_TDSP_Tree
 {
 public:
   MNM_TDSP_Tree(TInt dest_node_ID, PNEGraph graph, TInt max_interval);
-  ~MNM_TDSP_Tree();
+  // shares a snapshot owned by the caller, e.g. one per DUE iteration for all destinations
+  MNM_TDSP_Tree(TInt dest_node_ID, MNM_Graph_CSR *csr, TInt max_interval);
+  virtual ~MNM_TDSP_Tree();
 
-  int initialize();
+  int virtual initialize();
+  // cost[t * m_num_link + i] is the cost of CSR link i entered in interval t
+  int static build_cost_array(const MNM_Graph_CSR *csr, const std::unordered_map<TInt, TFlt*>& cost_map,
+                              TInt max_interval, std::vector<float> &cost);
+  int virtual update_tree(const float *cost);
   int update_tree(std::unordered_map<TInt, TFlt*>& cost_map);
-  TFlt get_distance_to_destination(TInt node_ID, TFlt time_stamp);
+  TFlt virtual get_distance_to_destination(TInt node_ID, TFlt time_stamp);
+  // CSR link index taken from node_index in interval, -1 for none
+  int virtual get_next_link(int node_index, int interval);
+  // walks the tree with the costs of the last update_tree
+  int get_tdsp(TInt src_node_ID, TInt time, MNM_Path* path);
   int get_tdsp(TInt src_node_ID, TInt time, 
         std::unordered_map<TInt, TFlt*>& cost_map,MNM_Path* path);
   int round_time(TFlt time_stamp);
-  std::unordered_map<TInt, TFlt*> m_dist;
-  std::unordered_map<TInt, TInt*> m_tree;
+  // m_dist[t * num_node + i] and m_tree[t * num_node + i] (CSR link index, -1 for none)
+  std::vector<float> m_dist;
+  std::vector<int> m_tree;
   TInt m_dest_node_ID;
-  PNEGraph m_graph;
+  int m_dest_index;
+  MNM_Graph_CSR *m_csr;
+  bool m_own_csr;
   TInt m_max_interval;
+  const float *m_cost;
+  std::vector<float> m_cost_buffer;
+  std::vector<float> m_relax;
+  std::vector<double> m_last_cost;
+  std::vector<double> m_last_dist;
+};
+
+#define MNM_TDSP_NO_PRED uint16_t(0xFFFF)
+
+// memory bounded TDSP tree: the distances only live in the rolling window of intervals the
+// backward recursion reads, except for the full rows of the tracked nodes (e.g. the origins),
+// and the predecessors are 16 bit offsets into the out links of each node kept in a memory
+// mapped file, so get_tdsp only pages in the intervals it walks through.
+// The file is a unique temporary file of pred_folder ($TMPDIR or /tmp if empty), unlinked as
+// soon as it is mapped
+class MNM_TDSP_Tree_Compact : public MNM_TDSP_Tree
+{
+public:
+  MNM_TDSP_Tree_Compact(TInt dest_node_ID, MNM_Graph_CSR *csr, TInt max_interval,
+                        const std::string &pred_folder, const std::vector<TInt> &track_node_ID);
+  virtual ~MNM_TDSP_Tree_Compact() override;
+
+  using MNM_TDSP_Tree::update_tree;
+  int virtual initialize() override;
+  int virtual update_tree(const float *cost) override;
+  // only the tracked nodes and the destination can be queried
+  TFlt virtual get_distance_to_destination(TInt node_ID, TFlt time_stamp) override;
+  int virtual get_next_link(int node_index, int interval) override;
+  std::string m_pred_folder;
+  uint16_t *m_pred;
+  size_t m_pred_size;
+  // m_window[(t % m_window_size) * num_node + i]
+  int m_window_size;
+  std::vector<float> m_window;
+  std::vector<int> m_last_pred;
+  // out position of every link within the out links of its tail
+  std::vector<uint16_t> m_out_pos;
+  std::unordered_map<TInt, int> m_track_index;
+  std::vector<int> m_track_node;
+  // m_track_dist[t * num_track + k]
+  std::vector<float> m_track_dist;
 };
 
 
@@ -112,7 +303,7 @@ struct LessThanByCost
 {
   bool operator()(const MNM_Cost* lhs, const  MNM_Cost* rhs) const
   {
-    return lhs -> m_cost >= rhs -> m_cost;
+    return lhs -> m_cost > rhs -> m_cost;
   }
 };
 
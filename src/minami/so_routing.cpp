@@ -8,7 +8,6 @@ MNM_Routing_Predetermined::MNM_Routing_Predetermined(PNEGraph &graph,
               MNM_OD_Factory *od_factory, MNM_Node_Factory *node_factory, MNM_Link_Factory *link_factory
               ,Path_Table *p_table, MNM_Pre_Routing *pre_routing, TInt max_int)
   : MNM_Routing::MNM_Routing(graph, od_factory, node_factory, link_factory){
-  	m_tracker = std::unordered_map<MNM_Veh*, std::deque<TInt>*>();
   	m_path_table = p_table;
   	m_pre_routing = pre_routing;
     m_total_assign_inter = max_int;
@@ -27,12 +26,6 @@ int MNM_Routing_Predetermined::init_routing(Path_Table *path_table)
 
 MNM_Routing_Predetermined::~MNM_Routing_Predetermined()
 {
-  for (auto _map_it : m_tracker){
-    _map_it.second -> clear();
-    delete _map_it.second;
-  }
-  m_tracker.clear();
-
   // add by Xidong, for clearing the memory of path table
   if (m_path_table != NULL){
     for (auto _it : *m_path_table){
@@ -47,6 +40,11 @@ MNM_Routing_Predetermined::~MNM_Routing_Predetermined()
   }
 }
 
+int MNM_Routing_Predetermined::reset()
+{
+  return 0;
+}
+
 int MNM_Routing_Predetermined::update_routing(TInt timestamp){
   // question: the releasing frequency of origin is not every assignment interval?
   TInt _release_freq = m_od_factory -> m_origin_map.begin() -> second -> m_frequency;
@@ -60,7 +58,7 @@ int MNM_Routing_Predetermined::update_routing(TInt timestamp){
   TInt _ass_int = timestamp/_release_freq;
   if (timestamp % _release_freq ==0  ){
     
-    // need to register vehicles to m_tracker
+    // need to register the paths of the vehicles
     for (auto _origin_it = m_od_factory->m_origin_map.begin(); _origin_it != m_od_factory->m_origin_map.end(); _origin_it++){
       
       _origin = _origin_it -> second;
@@ -100,23 +98,23 @@ int MNM_Routing_Predetermined::update_routing(TInt timestamp){
         _route_path = m_path_table -> find(_veh -> get_origin() -> m_origin_node  -> m_node_ID) -> second
                         -> find(_veh -> get_destination() -> m_dest_node  -> m_node_ID) -> second 
                         -> m_path_vec[_id_path];
-        std::deque<TInt> *_link_queue = new std::deque<TInt>();
-        std::copy(_route_path -> m_link_vec.begin(), _route_path -> m_link_vec.end(), std::back_inserter(*_link_queue));
-        m_tracker.insert(std::pair<MNM_Veh*, std::deque<TInt>*>(_veh, _link_queue));
+        // a vehicle still waiting from an earlier release keeps its path
+        if (_veh -> m_path == NULL){
+          _veh -> set_path(_route_path);
+        }
       }  
       for (auto _veh_it = _origin_node -> m_in_veh_queue.begin(); _veh_it!=_origin_node -> m_in_veh_queue.end(); _veh_it++){
         _veh = *_veh_it;
-        _next_link_ID = m_tracker.find(_veh) -> second -> front();
+        _next_link_ID = _veh -> pop_path_link();
         _next_link = m_link_factory -> get_link(_next_link_ID);
         _veh -> set_next_link(_next_link);
-        m_tracker.find(_veh) -> second -> pop_front();
         // std::cout << "vehicle " << _veh->m_veh_ID<<" next link: " << _next_link ->m_link_ID <<std::endl;
       }
     }
 
   }
 
-  // step 1: register vehilces in the Origin nodes to m_tracker, update their next link
+  // step 1: register vehilces in the Origin nodes, update their next link
 
 
 
@@ -134,21 +132,20 @@ int MNM_Routing_Predetermined::update_routing(TInt timestamp){
       _veh_dest = _veh -> get_destination();
       // printf("2.2\n");
       if (_veh_dest -> m_dest_node -> m_node_ID == _node_ID){
-        if (m_tracker.find(_veh) -> second -> size() != 0){
+        if (_veh -> has_path_link()){
           printf("Something wrong in fixed routing!\n");
           exit(-1);
         }
         _veh -> set_next_link(NULL);
-        // m_tracker.erase(m_tracker.find(_veh));
       }
       else{
         // printf("2.3\n");
-        if (m_tracker.find(_veh) == m_tracker.end()){
+        if (_veh -> m_path == NULL){
           printf("Vehicle not registered in link, impossible!\n");
           exit(-1);
         }
         if(_veh -> get_current_link() == _veh -> get_next_link()){
-          _next_link_ID = m_tracker.find(_veh) -> second -> front();
+          _next_link_ID = _veh -> pop_path_link();
           if (_next_link_ID == -1){
             printf("Something wrong in routing, wrong next link 2\n");
             printf("The node is %d, the vehicle should head to %d\n", (int)_node_ID, (int)_veh_dest -> m_dest_node -> m_node_ID);
@@ -156,7 +153,6 @@ int MNM_Routing_Predetermined::update_routing(TInt timestamp){
           }
           _next_link = m_link_factory -> get_link(_next_link_ID);
           _veh -> set_next_link(_next_link);
-          m_tracker.find(_veh) -> second -> pop_front();
         }
       }
     }
@@ -1,5 +1,7 @@
 #include "statistics.h"
 
+#include <algorithm>
+
 MNM_Statistics::MNM_Statistics(std::string file_folder, MNM_ConfReader *conf_reader, MNM_ConfReader *record_config, 
                     MNM_OD_Factory *od_factory, MNM_Node_Factory *node_factory, MNM_Link_Factory *link_factory)
 {
@@ -10,17 +12,18 @@ MNM_Statistics::MNM_Statistics(std::string file_folder, MNM_ConfReader *conf_rea
   m_node_factory = node_factory;
   m_link_factory = link_factory;
 
-  m_record_interval_volume = std::unordered_map<TInt, TFlt>();
-  m_load_interval_volume = std::unordered_map<TInt, TFlt>();
-  m_record_interval_tt = std::unordered_map<TInt, TFlt>();
-  m_load_interval_tt = std::unordered_map<TInt, TFlt>();
+  m_record_interval_volume = std::vector<double>();
+  m_load_interval_volume = std::vector<double>();
+  m_record_interval_tt = std::vector<double>();
+  m_load_interval_tt = std::vector<double>();
 
   m_link_order = std::vector<MNM_Dlink*>();
+  m_link_index = std::unordered_map<TInt, int>();
 
-  if (m_load_interval_volume_file.is_open()) m_load_interval_volume_file.close();
-  if (m_record_interval_volume_file.is_open()) m_record_interval_volume_file.close();
-  if (m_load_interval_tt_file.is_open()) m_load_interval_tt_file.close();
-  if (m_record_interval_tt_file.is_open()) m_record_interval_tt_file.close();
+  m_load_interval_volume_file = NULL;
+  m_record_interval_volume_file = NULL;
+  m_load_interval_tt_file = NULL;
+  m_record_interval_tt_file = NULL;
 
   init_record_value();
 }
@@ -28,6 +31,7 @@ MNM_Statistics::MNM_Statistics(std::string file_folder, MNM_ConfReader *conf_rea
 
 MNM_Statistics::~MNM_Statistics()
 {
+  post_record();
   delete m_self_config;
   m_record_interval_volume.clear();
   m_load_interval_volume.clear();
@@ -59,174 +63,107 @@ int MNM_Statistics::init_record_value()
       printf("MNM_Statistics::init_record_value_tt::Something wrong!\n");
       exit(-1);
   }
+  m_record_binary = int(m_self_config -> m_configFile -> Value("STAT", "rec_binary", 0.)) == 1;
   return 0;
 }
 
 int MNM_Statistics::init_record()
 {
-  TInt _link_ID;
-  std::string _file_name;
+  for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it++){
+    m_link_index.insert(std::pair<TInt, int>(_link_it -> first, int(m_link_order.size())));
+    m_link_order.push_back(_link_it -> second);
+  }
+
   if (m_record_volume){
-    for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it++){
-      _link_ID = _link_it -> first;
-      m_load_interval_volume.insert(std::pair<TInt, TFlt>(_link_ID, TFlt(0)));
-      m_record_interval_volume.insert(std::pair<TInt, TFlt>(_link_ID, TFlt(0)));
+    m_load_interval_volume = std::vector<double>(m_link_order.size(), 0.);
+    m_record_interval_volume = std::vector<double>(m_link_order.size(), 0.);
+    if (m_self_config -> get_int("volume_load_automatic_rec") == 1){
+      m_load_interval_volume_file = open_record_writer("load_interval_volume");
     }
-
-    
-    if (m_self_config -> get_int("volume_load_automatic_rec") == 1 || m_self_config -> get_int("volume_record_automatic_rec") == 1){
-      std::string _str;
-      for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it++){
-        _str += std::to_string(_link_it -> first) + " ";
-      }
-      _str.pop_back();
-      _str += "\n";
-
-      if (m_self_config -> get_int("volume_load_automatic_rec") == 1){
-        _file_name = m_file_folder + "/" + m_self_config -> get_string("rec_folder") + "/MNM_output_load_interval_volume";
-        m_load_interval_volume_file.open(_file_name, std::ofstream::out);   
-        if (!m_load_interval_volume_file.is_open()){
-          printf("Error happens when open m_load_interval_volume_file\n");
-          exit(-1);
-        }
-        m_load_interval_volume_file << _str;
-      }
-
-      if (m_self_config -> get_int("volume_record_automatic_rec") == 1){
-        _file_name = m_file_folder + "/" + m_self_config -> get_string("rec_folder") + "/MNM_output_record_interval_volume";
-        m_record_interval_volume_file.open(_file_name, std::ofstream::out);     
-        if (!m_record_interval_volume_file.is_open()){
-          printf("Error happens when open m_record_interval_volume_file\n");
-          exit(-1);
-        }
-        m_record_interval_volume_file << _str;
-      }
+    if (m_self_config -> get_int("volume_record_automatic_rec") == 1){
+      m_record_interval_volume_file = open_record_writer("record_interval_volume");
     }
   }
 
   if (m_record_tt){
-    for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it++){
-      _link_ID = _link_it -> first;
-      m_load_interval_tt.insert(std::pair<TInt, TFlt>(_link_ID, TFlt(0)));
-      m_record_interval_tt.insert(std::pair<TInt, TFlt>(_link_ID, TFlt(0)));
+    m_load_interval_tt = std::vector<double>(m_link_order.size(), 0.);
+    m_record_interval_tt = std::vector<double>(m_link_order.size(), 0.);
+    if (m_self_config -> get_int("tt_load_automatic_rec") == 1){
+      m_load_interval_tt_file = open_record_writer("load_interval_tt");
     }
-
-    
-    if (m_self_config -> get_int("tt_load_automatic_rec") == 1 || m_self_config -> get_int("tt_record_automatic_rec") == 1){
-      std::string _str;
-      for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it++){
-        _str += std::to_string(_link_it -> first) + " ";
-      }
-      _str.pop_back();
-      _str += "\n";
-
-      if (m_self_config -> get_int("tt_load_automatic_rec") == 1){
-        _file_name = m_file_folder + "/" + m_self_config -> get_string("rec_folder") + "/MNM_output_load_interval_tt";
-        m_load_interval_tt_file.open(_file_name, std::ofstream::out);   
-        if (!m_load_interval_tt_file.is_open()){
-          printf("Error happens when open m_load_interval_tt_file\n");
-          exit(-1);
-        }
-        m_load_interval_tt_file << _str;
-      }
-
-      if (m_self_config -> get_int("tt_record_automatic_rec") == 1){
-        _file_name = m_file_folder + "/" + m_self_config -> get_string("rec_folder") + "/MNM_output_record_interval_tt";
-        m_record_interval_tt_file.open(_file_name, std::ofstream::out);     
-        if (!m_record_interval_tt_file.is_open()){
-          printf("Error happens when open m_record_interval_tt_file\n");
-          exit(-1);
-        }
-        m_record_interval_tt_file << _str;
-      }
+    if (m_self_config -> get_int("tt_record_automatic_rec") == 1){
+      m_record_interval_tt_file = open_record_writer("record_interval_tt");
     }
   }
-
-  for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it++){
-    m_link_order.push_back(_link_it -> second);
-  }  
   return 0;
 }
 
+int MNM_Statistics::get_link_index(TInt link_ID)
+{
+  auto _it = m_link_index.find(link_ID);
+  return _it == m_link_index.end() ? -1 : _it -> second;
+}
+
+MNM_Record_Writer *MNM_Statistics::open_record_writer(std::string name)
+{
+  std::vector<TInt> _link_ID;
+  for (auto _link_it = m_link_order.begin(); _link_it != m_link_order.end(); _link_it++){
+    _link_ID.push_back((*_link_it) -> m_link_ID);
+  }
+  std::string _file_name = m_file_folder + "/" + m_self_config -> get_string("rec_folder") + "/MNM_output_" + name;
+  if (m_record_binary) _file_name += ".bin";
+  return new MNM_Record_Writer(_file_name, _link_ID, m_record_binary);
+}
+
 
 
 int MNM_Statistics::record_loading_interval_condition(TInt timestamp)
 {
-  std::string _str;
-  MNM_Dlink *_link;
-  TFlt _flow,  _tt;
-  if (m_record_volume && m_load_interval_volume_file.is_open()){
-    for (auto _link_it = m_link_order.begin(); _link_it != m_link_order.end(); _link_it++){
-      _link = *_link_it;
-      _flow = m_load_interval_volume.find(_link -> m_link_ID) -> second;
-      _str += std::to_string(_flow) + " ";
-    }
-    _str.pop_back();
-    _str += "\n"; 
-    m_load_interval_volume_file << _str;    
+  if (m_record_volume && m_load_interval_volume_file != NULL){
+    std::copy(m_load_interval_volume.begin(), m_load_interval_volume.end(), m_load_interval_volume_file -> new_row());
   }
-
-  _str.clear();
-  if (m_record_tt && m_load_interval_tt_file.is_open()){
-    for (auto _link_it = m_link_order.begin(); _link_it != m_link_order.end(); _link_it++){
-      _link = *_link_it;
-      _tt = m_load_interval_tt.find(_link -> m_link_ID) -> second;
-      _str += std::to_string(_tt) + " ";
-    }
-    _str.pop_back();
-    _str += "\n"; 
-    m_load_interval_tt_file << _str;    
+  if (m_record_tt && m_load_interval_tt_file != NULL){
+    std::copy(m_load_interval_tt.begin(), m_load_interval_tt.end(), m_load_interval_tt_file -> new_row());
   }
-
   return 0;
 }
 
 int MNM_Statistics::record_record_interval_condition(TInt timestamp)
 {
-  std::string _str;
-  MNM_Dlink *_link;
-  TFlt _flow, _tt;
-  if (m_record_volume && m_record_interval_volume_file.is_open()){
-    for (auto _link_it = m_link_order.begin(); _link_it != m_link_order.end(); _link_it++){
-      _link = *_link_it;
-      _flow = m_record_interval_volume.find(_link -> m_link_ID) -> second;
-      _str += std::to_string(_flow) + " ";
-    }
-    _str.pop_back();
-    _str += "\n"; 
-    m_record_interval_volume_file << _str;      
+  if (m_record_volume && m_record_interval_volume_file != NULL){
+    std::copy(m_record_interval_volume.begin(), m_record_interval_volume.end(), m_record_interval_volume_file -> new_row());
   }
-  _str.clear();
-
-  if (m_record_tt && m_record_interval_tt_file.is_open()){
-    for (auto _link_it = m_link_order.begin(); _link_it != m_link_order.end(); _link_it++){
-      _link = *_link_it;
-      _tt = m_record_interval_tt.find(_link -> m_link_ID) -> second;
-      _str += std::to_string(_tt) + " ";
-    }
-    _str.pop_back();
-    _str += "\n"; 
-    m_record_interval_tt_file << _str;      
+  if (m_record_tt && m_record_interval_tt_file != NULL){
+    std::copy(m_record_interval_tt.begin(), m_record_interval_tt.end(), m_record_interval_tt_file -> new_row());
   }
   return 0;
 }
 
 int MNM_Statistics::post_record()
 {
-  if (m_record_volume){
-    if (m_load_interval_volume_file.is_open()){
-      m_load_interval_volume_file.close();
-    }
-    if (m_record_interval_volume_file.is_open()) m_record_interval_volume_file.close();
-  }
-  if (m_record_tt){
-    if (m_load_interval_tt_file.is_open()){
-      m_load_interval_tt_file.close();
+  MNM_Record_Writer **_file[4] = {&m_load_interval_volume_file, &m_record_interval_volume_file, 
+                                  &m_load_interval_tt_file, &m_record_interval_tt_file};
+  for (int i = 0; i < 4; ++i){
+    if (*_file[i] != NULL){
+      delete *_file[i];
+      *_file[i] = NULL;
     }
-    if (m_record_interval_tt_file.is_open()) m_record_interval_tt_file.close();
   }
   return 0;
 }
+
+int MNM_Statistics::reset_record()
+{
+  post_record();
+  m_record_interval_volume.clear();
+  m_load_interval_volume.clear();
+  m_record_interval_tt.clear();
+  m_load_interval_tt.clear();
+  m_link_order.clear();
+  m_link_index.clear();
+  return 0;
+}
+
 /**************************************************************************
                               LRN
 **************************************************************************/
@@ -236,8 +173,8 @@ MNM_Statistics_Lrn::MNM_Statistics_Lrn(std::string file_folder, MNM_ConfReader *
   : MNM_Statistics::MNM_Statistics(file_folder,conf_reader, record_config, od_factory, node_factory, link_factory)
 {
   m_n = record_config -> get_int("rec_mode_para");
-  m_to_be_volume = std::unordered_map<TInt, TFlt>();
-  m_to_be_tt = std::unordered_map<TInt, TFlt>();
+  m_to_be_volume = std::vector<double>();
+  m_to_be_tt = std::vector<double>();
 }
 
 MNM_Statistics_Lrn::~MNM_Statistics_Lrn()
@@ -245,52 +182,45 @@ MNM_Statistics_Lrn::~MNM_Statistics_Lrn()
 
 }
 
+// the links are read once into the load interval arrays, the averages are then one pass over arrays
+static int update_lrn_record(const double *load, double *to_be, double *record, int num_link, double n, bool record_tick)
+{
+  if (record_tick){
+    for (int i = 0; i < num_link; ++i){
+      record[i] = to_be[i] + load[i] / n;
+      to_be[i] = 0.;
+    }
+  }
+  else{
+    for (int i = 0; i < num_link; ++i){
+      to_be[i] += load[i] / n;
+    }
+  }
+  return 0;
+}
+
 int MNM_Statistics_Lrn::update_record(TInt timestamp)
 {
-  MNM_Dlink *_link;
-  TFlt _flow;
+  const int _num_link = int(m_link_order.size());
+  const bool _record_tick = (timestamp) % m_n == 0 || timestamp == 0;
   if (m_record_volume){
-    if ((timestamp) % m_n == 0 || timestamp == 0){
-      for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it++){
-        _link = _link_it -> second;
-        _flow = _link -> get_link_flow();
-        m_load_interval_volume.find(_link -> m_link_ID) -> second = _flow;
-        m_record_interval_volume.find(_link -> m_link_ID) -> second = m_to_be_volume.find(_link -> m_link_ID) -> second + _flow/TFlt(m_n);
-        m_to_be_volume.find(_link -> m_link_ID) -> second = TFlt(0);
-      }
-    }
-    else{
-      for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it++){
-        _link = _link_it -> second;
-        _flow = _link -> get_link_flow();
-        m_load_interval_volume.find(_link -> m_link_ID) -> second = _flow;
-        m_to_be_volume.find(_link -> m_link_ID) -> second += _flow/TFlt(m_n);
-      }      
+    for (int i = 0; i < _num_link; ++i){
+      m_load_interval_volume[i] = m_link_order[i] -> get_link_flow();
     }
+    update_lrn_record(m_load_interval_volume.data(), m_to_be_volume.data(), m_record_interval_volume.data(), 
+                      _num_link, double(m_n), _record_tick);
   } 
   if (m_record_tt){
-    if ((timestamp) % m_n == 0 || timestamp == 0){
-      for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it++){
-        _link = _link_it -> second;
-        _flow = _link -> get_link_tt();
-        m_load_interval_tt.find(_link -> m_link_ID) -> second = _flow;
-        m_record_interval_tt.find(_link -> m_link_ID) -> second = m_to_be_tt.find(_link -> m_link_ID) -> second + _flow/TFlt(m_n);
-        m_to_be_tt.find(_link -> m_link_ID) -> second = TFlt(0);
-      }
-    }
-    else{
-      for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it++){
-        _link = _link_it -> second;
-        _flow = _link -> get_link_tt();
-        m_load_interval_tt.find(_link -> m_link_ID) -> second = _flow;
-        m_to_be_tt.find(_link -> m_link_ID) -> second += _flow/TFlt(m_n);
-      }      
+    for (int i = 0; i < _num_link; ++i){
+      m_load_interval_tt[i] = m_link_order[i] -> get_link_tt();
     }
+    update_lrn_record(m_load_interval_tt.data(), m_to_be_tt.data(), m_record_interval_tt.data(), 
+                      _num_link, double(m_n), _record_tick);
   } 
 
   record_loading_interval_condition(timestamp);
 
-  if ((timestamp ) % m_n == 0  || timestamp == 0){
+  if (_record_tick){
     record_record_interval_condition(timestamp);
   }
   return 0;
@@ -299,18 +229,11 @@ int MNM_Statistics_Lrn::update_record(TInt timestamp)
 int MNM_Statistics_Lrn::init_record()
 {
   MNM_Statistics::init_record();
-  TInt _link_ID;
   if (m_record_volume){
-    for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it++){
-      _link_ID = _link_it -> first;
-      m_to_be_volume.insert(std::pair<TInt, TFlt>(_link_ID, TFlt(0)));
-    }
+    m_to_be_volume = std::vector<double>(m_link_order.size(), 0.);
   }
   if (m_record_tt){
-    for (auto _link_it = m_link_factory -> m_link_map.begin(); _link_it != m_link_factory -> m_link_map.end(); _link_it++){
-      _link_ID = _link_it -> first;
-      m_to_be_tt.insert(std::pair<TInt, TFlt>(_link_ID, TFlt(0)));
-    }
+    m_to_be_tt = std::vector<double>(m_link_order.size(), 0.);
   }
   return 0;
 }
@@ -322,3 +245,10 @@ int MNM_Statistics_Lrn::post_record()
   return 0;
 }
 
+int MNM_Statistics_Lrn::reset_record()
+{
+  MNM_Statistics::reset_record();
+  m_to_be_volume.clear();
+  m_to_be_tt.clear();
+  return 0;
+}
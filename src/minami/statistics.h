@@ -6,6 +6,7 @@
 #include "dlink.h"
 #include "factory.h"
 #include "enum.h"
+#include "record_writer.h"
 
 #include <string>
 #include <iostream>
@@ -18,15 +19,17 @@ public:
                   MNM_OD_Factory *od_factory, MNM_Node_Factory *node_factory, MNM_Link_Factory *link_factory);
   virtual ~MNM_Statistics();
 
-  /* may or may not be initialized */
-  std::unordered_map<TInt, TFlt> m_load_interval_volume;
-  std::unordered_map<TInt, TFlt> m_record_interval_volume;
-  std::unordered_map<TInt, TFlt> m_record_interval_tt;
-  std::unordered_map<TInt, TFlt> m_load_interval_tt;
+  /* may or may not be initialized, dense over m_link_order */
+  std::vector<double> m_load_interval_volume;
+  std::vector<double> m_record_interval_volume;
+  std::vector<double> m_record_interval_tt;
+  std::vector<double> m_load_interval_tt;
 
   std::vector<MNM_Dlink*> m_link_order; 
   //since iteration of the unordered_map is not guaranteed the same order,
   //so we keep the order first
+  // position of a link in m_link_order, -1 if it is not recorded
+  int get_link_index(TInt link_ID);
 
 
   /* universal function */
@@ -35,10 +38,17 @@ public:
   int virtual update_record(TInt timestamp){return 0;};
   int virtual init_record();
   int virtual post_record();
+  // clear all records, init_record() has to be called again before loading
+  int virtual reset_record();
 protected:
   int init_record_value();
+  std::unordered_map<TInt, int> m_link_index;
+  // MNM_output_<name> in the record folder, one column per link in m_link_order
+  MNM_Record_Writer *open_record_writer(std::string name);
   bool m_record_volume;
   bool m_record_tt;
+  // the automatic records are written as columnar binary when STAT rec_binary = 1
+  bool m_record_binary;
   std::string m_file_folder;
   Record_type m_record_type;
   MNM_ConfReader *m_self_config;
@@ -47,10 +57,10 @@ protected:
   MNM_Node_Factory *m_node_factory;
   MNM_Link_Factory *m_link_factory;
 
-  std::ofstream m_load_interval_volume_file;
-  std::ofstream m_record_interval_volume_file;
-  std::ofstream m_load_interval_tt_file;
-  std::ofstream m_record_interval_tt_file;
+  MNM_Record_Writer *m_load_interval_volume_file;
+  MNM_Record_Writer *m_record_interval_volume_file;
+  MNM_Record_Writer *m_load_interval_tt_file;
+  MNM_Record_Writer *m_record_interval_tt_file;
 
 };
 
@@ -64,9 +74,11 @@ public:
   int virtual update_record(TInt timestamp);
   int virtual init_record();
   int virtual post_record();
+  int virtual reset_record();
 private:
   TInt m_n;
-  std::unordered_map<TInt, TFlt> m_to_be_volume;
-  std::unordered_map<TInt, TFlt> m_to_be_tt;
+  // the sums of value / m_n since the last record tick
+  std::vector<double> m_to_be_volume;
+  std::vector<double> m_to_be_tt;
 };
 #endif
\ No newline at end of file
@@ -48,6 +48,30 @@ TFlt MNM_Ults::rand_flt(){
   return TFlt((double) rand() / (RAND_MAX));
 }
 
+MNM_Rng::MNM_Rng(uint64_t seed)
+{
+  this -> seed(seed);
+}
+
+int MNM_Rng::seed(uint64_t seed)
+{
+  // splitmix64 so that close seeds give unrelated streams, the state must not be 0
+  uint64_t _z = seed + 0x9E3779B97F4A7C15ULL;
+  _z = (_z ^ (_z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  _z = (_z ^ (_z >> 27)) * 0x94D049BB133111EBULL;
+  m_state = _z ^ (_z >> 31);
+  if (m_state == 0) m_state = 0x9E3779B97F4A7C15ULL;
+  return 0;
+}
+
+double MNM_Rng::rand_flt()
+{
+  m_state ^= m_state >> 12;
+  m_state ^= m_state << 25;
+  m_state ^= m_state >> 27;
+  return double((m_state * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
 TFlt MNM_Ults::max_link_cost()
 {
   return TFlt(60 * 60);
@@ -142,7 +166,30 @@ std::string trim(std::string const& source, char const* delims = " \t\r\n") {
   return result;
 }
 
+std::map<std::string, std::map<std::string, std::string>> &ConfigFile::memory_file() {
+  static std::map<std::string, std::map<std::string, std::string>> _memory_file;
+  return _memory_file;
+}
+
+int ConfigFile::add_memory_file(std::string const& file_name, std::map<std::string, std::string> const& content) {
+  memory_file()[file_name] = content;
+  return 0;
+}
+
+int ConfigFile::remove_memory_file(std::string const& file_name) {
+  memory_file().erase(file_name);
+  return 0;
+}
+
 ConfigFile::ConfigFile(std::string const& configFile) {
+  auto _memory_it = memory_file().find(configFile);
+  if (_memory_it != memory_file().end()) {
+    for (auto _it : _memory_it -> second) {
+      content_[_it.first] = Chameleon(_it.second);
+    }
+    return;
+  }
+
   std::ifstream file(configFile.c_str());
 
   std::string line;
@@ -6,6 +6,7 @@
 #include <string>
 #include <string>
 #include <map>
+#include <cstdint>
 
 
 // struct TIntHash {
@@ -43,6 +44,18 @@ public:
   int static copy_file( std::string srce_file, std::string dest_file );
 };
 
+// xorshift64* generator, small enough to keep one per origin so the draws of an origin
+// do not depend on the other origins
+class MNM_Rng
+{
+public:
+  MNM_Rng(uint64_t seed = 0);
+  int seed(uint64_t seed);
+  // uniform in [0, 1)
+  double rand_flt();
+  uint64_t m_state;
+};
+
 
 
 
@@ -80,6 +93,13 @@ public:
 
   Chameleon const& Value(std::string const& section, std::string const& entry, double value);
   Chameleon const& Value(std::string const& section, std::string const& entry, std::string const& value);
+
+  // a config file kept in memory as "section/entry" -> value, the constructor reads it instead of the
+  // disk, so everything that opens file_name gets it. not thread safe
+  static int add_memory_file(std::string const& file_name, std::map<std::string, std::string> const& content);
+  static int remove_memory_file(std::string const& file_name);
+private:
+  static std::map<std::string, std::map<std::string, std::string>> &memory_file();
 };
 
 class MNM_ConfReader
@@ -1,4 +1,5 @@
 #include "vehicle.h"
+#include "path.h"
 
 MNM_Veh::MNM_Veh(TInt ID, TInt start_time) {
   m_veh_ID = ID;
@@ -8,6 +9,8 @@ MNM_Veh::MNM_Veh(TInt ID, TInt start_time) {
   m_finish_time = -1;
   m_assign_interval = -1;
   m_class = TInt(0);
+  m_path = NULL;
+  m_path_cursor = 0;
 }
 
 MNM_Veh::~MNM_Veh() {
@@ -71,3 +74,23 @@ int MNM_Veh::set_origin(MNM_Origin * origin)
   m_origin = origin;
   return 0;
 }
+
+int MNM_Veh::set_path(MNM_Path *path)
+{
+  m_path = path;
+  m_path_cursor = 0;
+  return 0;
+}
+
+TInt MNM_Veh::pop_path_link()
+{
+  if (!has_path_link()) return -1;
+  TInt _link_ID = m_path -> m_link_vec[m_path_cursor];
+  m_path_cursor += 1;
+  return _link_ID;
+}
+
+bool MNM_Veh::has_path_link()
+{
+  return (m_path != NULL) && (m_path_cursor < TInt(m_path -> m_link_vec.size()));
+}
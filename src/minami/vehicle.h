@@ -39,6 +39,12 @@ public:
   MNM_Origin *m_origin;
   // m_path will only be used in Fixed routing (didn't find a better way to encode)
   MNM_Path* m_path; 
+  // m_path -> m_link_vec[m_path_cursor] is the next link to take
+  TInt m_path_cursor;
+  int set_path(MNM_Path *path);
+  // the link ID under the cursor, the cursor moves on, -1 when the path is done
+  TInt pop_path_link();
+  bool has_path_link();
   TInt m_assign_interval;
   TInt m_class;
 };
@@ -6,7 +6,10 @@
 #include "multiclass.h"
 
 #include <unordered_map>
+#include <algorithm>
+#include <cstring>
 #include <vector>
+#include <memory>
 
 namespace py = pybind11;
 
@@ -93,6 +96,171 @@ int run_dta(std::string folder) {
 }
 
 
+// the three arrays share one capsule, so the matrix is freed when the last of them is released
+py::tuple triplets_to_csr(std::vector<Eigen::Triplet<double>> &record, int num_rows, int num_cols)
+{
+  SparseMatrixR *_mat = new SparseMatrixR(num_rows, num_cols);
+  _mat -> setFromTriplets(record.begin(), record.end());
+  _mat -> makeCompressed();
+  py::capsule _owner(_mat, [](void *mat) { delete reinterpret_cast<SparseMatrixR *>(mat); });
+  int _nnz = (int) _mat -> nonZeros();
+  auto data = py::array_t<double>(std::vector<ssize_t>{_nnz}, _mat -> valuePtr(), _owner);
+  auto indices = py::array_t<int>(std::vector<ssize_t>{_nnz}, _mat -> innerIndexPtr(), _owner);
+  auto indptr = py::array_t<int>(std::vector<ssize_t>{num_rows + 1}, _mat -> outerIndexPtr(), _owner);
+  return py::make_tuple(data, indices, indptr, py::make_tuple(num_rows, num_cols));
+}
+
+py::array_t<double> dar_records_to_array(std::vector<dar_record*> &record)
+{
+  // path_ID, assign_time, link_ID, start_int, flow
+  int new_shape [2] = { (int) record.size(), 5}; 
+  auto result = py::array_t<double>(new_shape);
+  auto result_buf = result.request();
+  double *result_prt = (double *) result_buf.ptr;
+  dar_record* tmp_record;
+  for (size_t i = 0; i < record.size(); ++i){
+    tmp_record = record[i];
+    result_prt[i * 5 + 0] = (double) tmp_record -> path_ID();
+    result_prt[i * 5 + 1] = (double) tmp_record -> assign_int();
+    result_prt[i * 5 + 2] = (double) tmp_record -> link_ID();
+    result_prt[i * 5 + 3] = (double) tmp_record -> link_start_int();
+    result_prt[i * 5 + 4] = tmp_record -> flow();
+  }
+  for (size_t i = 0; i < record.size(); ++i){
+    delete record[i];
+  }
+  record.clear();
+  return result;
+}
+
+std::string register_memory_config(py::dict config, const void *owner)
+{
+  char _name[64];
+  snprintf(_name, sizeof(_name), "<memory:%p>", owner);
+  std::string _folder(_name);
+  std::map<std::string, std::string> _content;
+  for (auto _section : config){
+    std::string _section_name = py::str(_section.first);
+    for (auto _entry : py::reinterpret_borrow<py::dict>(_section.second)){
+      std::string _key = py::str(_entry.first);
+      std::string _value = py::str(_entry.second);
+      // the record writer of an automatic_rec output exits when it cannot open its file
+      if (_section_name == "STAT" && _key.size() > 14 && _key.compare(_key.size() - 14, 14, "_automatic_rec") == 0 
+          && atoi(_value.c_str()) != 0){
+        throw std::runtime_error("Error, register_memory_config, STAT " + _key + " must be 0, there is no folder to write to");
+      }
+      _content[_section_name + "/" + _key] = _value;
+    }
+  }
+  ConfigFile::add_memory_file(_folder + "/config.conf", _content);
+  return _folder;
+}
+
+// a column of network as contiguous int32 kept alive by keep_alive, type names are turned into their codes
+static const int32_t *get_bundle_int_column(py::dict network, const char *key, int32_t &num, 
+                                            std::vector<py::object> &keep_alive, bool is_type = false)
+{
+  if (!network.contains(key)){
+    throw std::runtime_error(std::string("Error, network_to_bundle, missing ") + key);
+  }
+  py::array_t<int32_t, py::array::c_style | py::array::forcecast> _column;
+  if (is_type){
+    py::list _names = py::list(network[key]);
+    _column = py::array_t<int32_t, py::array::c_style | py::array::forcecast>(_names.size());
+    auto _column_buf = _column.mutable_unchecked<1>();
+    for (size_t i = 0; i < _names.size(); ++i){
+      _column_buf(i) = MNM_Network_Bundle::get_type_code(py::str(_names[i]));
+    }
+  }
+  else{
+    _column = py::array_t<int32_t, py::array::c_style | py::array::forcecast>::ensure(network[key]);
+    if (!_column || _column.ndim() != 1){
+      throw std::runtime_error(std::string("Error, network_to_bundle, ") + key + " must be one dimensional");
+    }
+  }
+  if (num >= 0 && num != _column.shape(0)){
+    throw std::runtime_error(std::string("Error, network_to_bundle, length mismatch of ") + key);
+  }
+  num = _column.shape(0);
+  keep_alive.push_back(_column);
+  return _column.data();
+}
+
+// num x width rows of network as contiguous float64, width 0 when the key is missing and optional
+static const double *get_bundle_value_column(py::dict network, const char *key, int32_t num, int32_t &width, 
+                                             std::vector<py::object> &keep_alive, bool optional = false)
+{
+  width = 0;
+  if (!network.contains(key)){
+    if (optional) return NULL;
+    throw std::runtime_error(std::string("Error, network_to_bundle, missing ") + key);
+  }
+  auto _column = py::array_t<double, py::array::c_style | py::array::forcecast>::ensure(network[key]);
+  if (!_column || _column.ndim() > 2 || (_column.ndim() == 0 && num > 0) || (num > 0 && _column.shape(0) != num)){
+    throw std::runtime_error(std::string("Error, network_to_bundle, ") + key + " must have one row per record");
+  }
+  width = _column.ndim() == 2 ? _column.shape(1) : (num > 0 ? 1 : 0);
+  keep_alive.push_back(_column);
+  return _column.data();
+}
+
+// the keys are the columns of the input files: node_ID, node_type, node_value (optional, num_node x width),
+// link_ID, link_type, link_value (num_link x width), origin_ID, origin_node_ID, dest_ID, dest_node_ID,
+// edge_link_ID, edge_from_ID, edge_to_ID, demand_O_ID, demand_D_ID, demand (num_OD x width), and
+// for the fixed route types path_node_offset (num_path + 1), path_node and path_buffer (optional, num_path x length),
+// and for the multiclass DTA emission_link_ID (optional, the links of MNM_input_emission_linkID)
+MNM_Network_Bundle *network_to_bundle(py::dict network, std::vector<py::object> &keep_alive)
+{
+  // the bundle is freed if a column is rejected
+  std::unique_ptr<MNM_Network_Bundle> _bundle(new MNM_Network_Bundle());
+  MNM_Network_Bundle_Header *_header = &(_bundle -> m_memory_header);
+  memcpy(_header -> m_magic, MNM_NETWORK_BUNDLE_MAGIC, 8);
+  _header -> m_num_node = -1;
+  _header -> m_num_link = -1;
+  _header -> m_num_origin = -1;
+  _header -> m_num_dest = -1;
+  _header -> m_num_edge = -1;
+  _header -> m_num_OD = -1;
+  _bundle -> m_node_ID = get_bundle_int_column(network, "node_ID", _header -> m_num_node, keep_alive);
+  _bundle -> m_node_type = get_bundle_int_column(network, "node_type", _header -> m_num_node, keep_alive, true);
+  _bundle -> m_node_value = get_bundle_value_column(network, "node_value", _header -> m_num_node, 
+                                                    _header -> m_node_width, keep_alive, true);
+  _bundle -> m_link_ID = get_bundle_int_column(network, "link_ID", _header -> m_num_link, keep_alive);
+  _bundle -> m_link_type = get_bundle_int_column(network, "link_type", _header -> m_num_link, keep_alive, true);
+  _bundle -> m_link_value = get_bundle_value_column(network, "link_value", _header -> m_num_link, 
+                                                    _header -> m_link_width, keep_alive);
+  _bundle -> m_origin_ID = get_bundle_int_column(network, "origin_ID", _header -> m_num_origin, keep_alive);
+  _bundle -> m_origin_node_ID = get_bundle_int_column(network, "origin_node_ID", _header -> m_num_origin, keep_alive);
+  _bundle -> m_dest_ID = get_bundle_int_column(network, "dest_ID", _header -> m_num_dest, keep_alive);
+  _bundle -> m_dest_node_ID = get_bundle_int_column(network, "dest_node_ID", _header -> m_num_dest, keep_alive);
+  _bundle -> m_edge_link_ID = get_bundle_int_column(network, "edge_link_ID", _header -> m_num_edge, keep_alive);
+  _bundle -> m_edge_from_ID = get_bundle_int_column(network, "edge_from_ID", _header -> m_num_edge, keep_alive);
+  _bundle -> m_edge_to_ID = get_bundle_int_column(network, "edge_to_ID", _header -> m_num_edge, keep_alive);
+  _bundle -> m_demand_O_ID = get_bundle_int_column(network, "demand_O_ID", _header -> m_num_OD, keep_alive);
+  _bundle -> m_demand_D_ID = get_bundle_int_column(network, "demand_D_ID", _header -> m_num_OD, keep_alive);
+  _bundle -> m_demand_value = get_bundle_value_column(network, "demand", _header -> m_num_OD, 
+                                                      _header -> m_demand_width, keep_alive);
+  _bundle -> m_header = _header;
+
+  if (network.contains("path_node_offset")){
+    int32_t _num_offset = -1;
+    _bundle -> m_num_path_node = -1;
+    _bundle -> m_path_node_offset = get_bundle_int_column(network, "path_node_offset", _num_offset, keep_alive);
+    _bundle -> m_path_node = get_bundle_int_column(network, "path_node", _bundle -> m_num_path_node, keep_alive);
+    _bundle -> m_num_path = std::max(_num_offset - 1, 0);
+    if (_bundle -> m_num_path > 0 && _bundle -> m_path_node_offset[_bundle -> m_num_path] != _bundle -> m_num_path_node){
+      throw std::runtime_error("Error, network_to_bundle, path_node_offset does not match path_node");
+    }
+    _bundle -> m_path_buffer = get_bundle_value_column(network, "path_buffer", _bundle -> m_num_path, 
+                                                       _bundle -> m_path_buffer_length, keep_alive, true);
+  }
+  if (network.contains("emission_link_ID")){
+    _bundle -> m_num_emission_link = -1;
+    _bundle -> m_emission_link_ID = get_bundle_int_column(network, "emission_link_ID", _bundle -> m_num_emission_link, keep_alive);
+  }
+  return _bundle.release();
+}
+
 
 /**********************************************************************************************************
 ***********************************************************************************************************
@@ -104,6 +272,8 @@ int run_dta(std::string folder) {
 Dta_Api::Dta_Api()
 {
   m_dta = NULL;
+  m_memory_folder = "";
+  m_dar_observation = NULL;
   m_link_vec = std::vector<MNM_Dlink*>();
   m_path_vec = std::vector<MNM_Path*>();
   m_path_map = std::unordered_map<MNM_Path*, int>(); 
@@ -116,6 +286,12 @@ Dta_Api::~Dta_Api()
   if (m_dta != NULL){
     delete m_dta;
   }
+  if (!m_memory_folder.empty()){
+    ConfigFile::remove_memory_file(m_memory_folder + "/config.conf");
+  }
+  if (m_dar_observation != NULL){
+    delete m_dar_observation;
+  }
   m_link_vec.clear();
   m_path_vec.clear();
   // m_link_map.clear();
@@ -129,6 +305,24 @@ int Dta_Api::initialize(std::string folder)
   m_dta -> build_from_files();
   m_dta -> hook_up_node_and_link();
   // m_dta -> is_ok();
+  return load_ID_path_mapping();
+}
+
+// the STAT *_automatic_rec outputs must be off, there is no folder to write them to
+int Dta_Api::initialize_from_arrays(py::dict config, py::dict network)
+{
+  m_memory_folder = register_memory_config(config, this);
+  std::vector<py::object> _keep_alive;
+  std::unique_ptr<MNM_Network_Bundle> _bundle(network_to_bundle(network, _keep_alive));
+  m_dta = new MNM_Dta(m_memory_folder);
+  m_dta -> build_from_memory(_bundle.get());
+  _bundle.reset();
+  m_dta -> hook_up_node_and_link();
+  return load_ID_path_mapping();
+}
+
+int Dta_Api::load_ID_path_mapping()
+{
   // printf("start load ID path mapping 0\n");
   if (MNM_Routing_Fixed *_routing = dynamic_cast<MNM_Routing_Fixed *>(m_dta -> m_routing)){
     MNM::get_ID_path_mapping(m_ID_path_mapping, _routing -> m_path_table);
@@ -172,6 +366,69 @@ int Dta_Api::run_whole()
   return 0;
 }
 
+// back to t=0 without rebuilding the network, call run_whole again to reload
+int Dta_Api::reset()
+{
+  m_dta -> reset();
+  return 0;
+}
+
+// buffer: num_path x buffer_length, rows follow the registered paths
+int Dta_Api::update_path_buffer(py::array_t<double> buffer)
+{
+  auto buffer_buf = buffer.request();
+  if (buffer_buf.ndim != 2){
+    throw std::runtime_error("Error, Dta_Api::update_path_buffer, input dismension mismatch");
+  }
+  if (buffer_buf.shape[0] != (int) m_path_vec.size()){
+    throw std::runtime_error("Error, Dta_Api::update_path_buffer, number of paths mismatch");
+  }
+  int l = buffer_buf.shape[1];
+  double *buffer_ptr = (double *) buffer_buf.ptr;
+  MNM_Path *_path;
+  for (size_t i = 0; i < m_path_vec.size(); ++i){
+    _path = m_path_vec[i];
+    if (_path -> m_buffer_length != l){
+      throw std::runtime_error("Error, Dta_Api::update_path_buffer, buffer length mismatch");
+    }
+    for (int j = 0; j < l; ++j){
+      _path -> m_buffer[j] = TFlt(buffer_ptr[i * l + j]);
+    }
+  }
+  return 0;
+}
+
+// demand: num_OD x max_interval, same as MNM_input_demand
+int Dta_Api::update_od_demand(py::array_t<int> O_IDs, py::array_t<int> D_IDs, py::array_t<double> demand)
+{
+  auto O_buf = O_IDs.request();
+  auto D_buf = D_IDs.request();
+  auto demand_buf = demand.request();
+  if (O_buf.ndim != 1 || D_buf.ndim != 1 || demand_buf.ndim != 2){
+    throw std::runtime_error("Error, Dta_Api::update_od_demand, input dismension mismatch");
+  }
+  if (O_buf.shape[0] != D_buf.shape[0] || O_buf.shape[0] != demand_buf.shape[0]){
+    throw std::runtime_error("Error, Dta_Api::update_od_demand, input length mismatch");
+  }
+  int *O_ptr = (int *) O_buf.ptr;
+  int *D_ptr = (int *) D_buf.ptr;
+  double *demand_ptr = (double *) demand_buf.ptr;
+  int l = demand_buf.shape[1];
+  MNM_Origin *_origin;
+  MNM_Destination *_dest;
+  std::vector<TFlt> _demand_vector;
+  for (int i = 0; i < O_buf.shape[0]; ++i){
+    _origin = m_dta -> m_od_factory -> get_origin(TInt(O_ptr[i]));
+    _dest = m_dta -> m_od_factory -> get_destination(TInt(D_ptr[i]));
+    if (l != _origin -> m_max_assign_interval){
+      throw std::runtime_error("Error, Dta_Api::update_od_demand, demand length mismatch");
+    }
+    _demand_vector = std::vector<TFlt>(demand_ptr + i * l, demand_ptr + (i + 1) * l);
+    _origin -> set_dest_demand(_dest, _demand_vector.data());
+  }
+  return 0;
+}
+
 int Dta_Api::get_cur_loading_interval()
 {
   return m_dta -> m_current_loading_interval();
@@ -314,6 +571,52 @@ py::array_t<double> Dta_Api::get_path_tt(py::array_t<int>start_intervals)
 
 
 
+// all registered paths at once, link tt is read once per (link, interval) and
+// shared path prefixes are evaluated once, travel time keeps running along the path
+py::array_t<double> Dta_Api::get_path_tt_batch(py::array_t<int>start_intervals)
+{
+  auto start_buf = start_intervals.request();
+  if (start_buf.ndim != 1){
+    throw std::runtime_error("Error, Dta_Api::get_path_tt_batch, input dismension mismatch");
+  }
+  int l = start_buf.shape[0];
+  int *start_prt = (int *) start_buf.ptr;
+  int _num_interval = get_cur_loading_interval();
+  if (_num_interval <= 0){
+    throw std::runtime_error("Error, Dta_Api::get_path_tt_batch, nothing loaded yet");
+  }
+  std::vector<double> _depart_time = std::vector<double>(l);
+  for (int t = 0; t < l; ++t){
+    if (start_prt[t] > _num_interval){
+      throw std::runtime_error("Error, Dta_Api::get_path_tt_batch, loaded data not enough");
+    }
+    _depart_time[t] = double(start_prt[t]);
+  }
+  std::unordered_map<TInt, TInt> _link_index = std::unordered_map<TInt, TInt>();
+  std::vector<MNM_Dlink*> _path_link_vec = std::vector<MNM_Dlink*>();
+  for (MNM_Path *_path : m_path_vec){
+    for (TInt _link_ID : _path -> m_link_vec){
+      if (_link_index.find(_link_ID) == _link_index.end()){
+        _link_index.insert(std::pair<TInt, TInt>(_link_ID, TInt(_path_link_vec.size())));
+        _path_link_vec.push_back(m_dta -> m_link_factory -> get_link(_link_ID));
+      }
+    }
+  }
+  std::vector<double> _tt = std::vector<double>(_path_link_vec.size() * _num_interval);
+  for (size_t i = 0; i < _path_link_vec.size(); ++i){
+    for (int t = 0; t < _num_interval; ++t){
+      _tt[i * _num_interval + t] = MNM_DTA_GRADIENT::get_travel_time(_path_link_vec[i], TFlt(t))();
+    }
+  }
+  int new_shape [2] = { (int) m_path_vec.size(), l}; 
+  auto result = py::array_t<double>(new_shape);
+  auto result_buf = result.request();
+  double *result_prt = (double *) result_buf.ptr;
+  MNM_Path_TT_Trie _trie(m_path_vec, _link_index);
+  _trie.get_path_tt(_tt.data(), _num_interval, _depart_time.data(), l, result_prt);
+  return result;
+}
+
 py::array_t<double> Dta_Api::get_link_in_cc(int link_ID)
 {
   if (m_dta -> m_link_factory -> get_link(TInt(link_ID)) -> m_N_in == NULL){
@@ -442,6 +745,192 @@ SparseMatrixR Dta_Api::get_complete_dar_matrix(py::array_t<int>start_intervals,
   return mat;
 }
 
+// register the observation windows before run_whole, DAR is then accumulated during loading
+// without the cc tree, links and paths must be registered first
+int Dta_Api::register_dar_windows(py::array_t<int>start_intervals, py::array_t<int>end_intervals)
+{
+  auto start_buf = start_intervals.request();
+  auto end_buf = end_intervals.request();
+  if (start_buf.ndim != 1 || end_buf.ndim != 1){
+    throw std::runtime_error("Error, Dta_Api::register_dar_windows, input dismension mismatch");
+  }
+  if (start_buf.shape[0] != end_buf.shape[0]){
+    throw std::runtime_error("Error, Dta_Api::register_dar_windows, input length mismatch");
+  }
+  if (m_link_vec.size() == 0 || m_path_vec.size() == 0){
+    throw std::runtime_error("Error, Dta_Api::register_dar_windows, links or paths not registered");
+  }
+  int l = start_buf.shape[0];
+  int *start_prt = (int *) start_buf.ptr;
+  int *end_prt = (int *) end_buf.ptr;
+  std::vector<std::pair<TInt, TInt>> _windows = std::vector<std::pair<TInt, TInt>>();
+  for (int t = 0; t < l; ++t){
+    _windows.push_back(std::pair<TInt, TInt>(TInt(start_prt[t]), TInt(end_prt[t])));
+  }
+  if (m_dar_observation != NULL){
+    delete m_dar_observation;
+  }
+  m_dar_observation = new MNM_Dar_Observation(_windows, m_path_vec);
+  for (size_t i = 0; i < m_link_vec.size(); ++i){
+    m_link_vec[i] -> install_dar_bins(m_dar_observation);
+  }
+  return 0;
+}
+
+py::array_t<double> Dta_Api::get_dar_matrix_online()
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Dta_Api::get_dar_matrix_online, dar windows not registered");
+  }
+  std::vector<dar_record*> _record = std::vector<dar_record*>();
+  for (size_t i = 0; i<m_link_vec.size(); ++i){
+    MNM_DTA_GRADIENT::add_dar_records_bins(_record, m_link_vec[i], m_link_vec[i] -> m_dar_bins);
+  }
+  return dar_records_to_array(_record);
+}
+
+SparseMatrixR Dta_Api::get_complete_dar_matrix_online(int num_intervals, py::array_t<double> f)
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Dta_Api::get_complete_dar_matrix_online, dar windows not registered");
+  }
+  int _num_e_path = m_path_vec.size();
+  int _num_e_link = m_link_vec.size();
+  auto f_buf = f.request();
+  if (f_buf.ndim != 1){
+    throw std::runtime_error("Error, Dta_Api::get_complete_dar_matrix_online, input path flow mismatch");
+  }
+  double *f_ptr = (double *) f_buf.ptr;
+
+  std::vector<Eigen::Triplet<double>> _record;
+  _record.reserve(100000);
+  for (size_t i = 0; i<m_link_vec.size(); ++i){
+    MNM_DTA_GRADIENT::add_dar_records_bins_eigen(_record, m_link_vec[i] -> m_dar_bins, i, _num_e_link, 1, f_ptr);
+  }
+  SparseMatrixR mat(num_intervals * _num_e_link, num_intervals * _num_e_path);
+  mat.setFromTriplets(_record.begin(), _record.end());
+  return mat;
+}
+
+py::tuple Dta_Api::get_complete_dar_matrix_csr(py::array_t<int>start_intervals, py::array_t<int>end_intervals,
+                                                int num_intervals, py::array_t<double> f)
+{
+  int _num_e_path = m_path_map.size();
+  int _num_e_link = m_link_vec.size();
+  auto start_buf = start_intervals.request();
+  auto end_buf = end_intervals.request();
+  auto f_buf = f.request();
+  if (start_buf.ndim != 1 || end_buf.ndim != 1){
+    throw std::runtime_error("Error, Dta_Api::get_complete_dar_matrix_csr, input dismension mismatch");
+  }
+  if (start_buf.shape[0] != end_buf.shape[0]){
+    throw std::runtime_error("Error, Dta_Api::get_complete_dar_matrix_csr, input length mismatch");
+  }
+  if (f_buf.ndim != 1){
+    throw std::runtime_error("Error, Dta_Api::get_complete_dar_matrix_csr, input path flow mismatch");
+  }
+  int l = start_buf.shape[0];
+  int *start_prt = (int *) start_buf.ptr;
+  int *end_prt = (int *) end_buf.ptr;
+  double *f_ptr = (double *) f_buf.ptr;
+
+  std::vector<Eigen::Triplet<double>> _record;
+  _record.reserve(100000);
+  for (int t = 0; t < l; ++t){
+    if (end_prt[t] < start_prt[t]){
+      throw std::runtime_error("Error, Dta_Api::get_complete_dar_matrix_csr, end time smaller than start time");
+    }
+    if (end_prt[t] > get_cur_loading_interval()){
+      throw std::runtime_error("Error, Dta_Api::get_complete_dar_matrix_csr, loaded data not enough");
+    }
+    for (size_t i = 0; i<m_link_vec.size(); ++i){
+      MNM_DTA_GRADIENT::add_dar_records_tree_eigen(
+                    _record, m_link_vec[i] -> m_N_in_tree, m_path_map, TFlt(start_prt[t]), TFlt(end_prt[t]),
+                    i, t, _num_e_link, _num_e_path, 1, f_ptr);
+    }
+  }
+  return triplets_to_csr(_record, num_intervals * _num_e_link, num_intervals * _num_e_path);
+}
+
+py::tuple Dta_Api::get_complete_dar_matrix_online_csr(int num_intervals, py::array_t<double> f)
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Dta_Api::get_complete_dar_matrix_online_csr, dar windows not registered");
+  }
+  int _num_e_path = m_path_vec.size();
+  int _num_e_link = m_link_vec.size();
+  auto f_buf = f.request();
+  if (f_buf.ndim != 1){
+    throw std::runtime_error("Error, Dta_Api::get_complete_dar_matrix_online_csr, input path flow mismatch");
+  }
+  double *f_ptr = (double *) f_buf.ptr;
+
+  std::vector<Eigen::Triplet<double>> _record;
+  _record.reserve(100000);
+  for (size_t i = 0; i<m_link_vec.size(); ++i){
+    MNM_DTA_GRADIENT::add_dar_records_bins_eigen(_record, m_link_vec[i] -> m_dar_bins, i, _num_e_link, 1, f_ptr);
+  }
+  return triplets_to_csr(_record, num_intervals * _num_e_link, num_intervals * _num_e_path);
+}
+
+py::array_t<double> Dta_Api::get_dar_transpose_product(py::array_t<double> v, int num_intervals, py::array_t<double> f)
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Dta_Api::get_dar_transpose_product, dar windows not registered");
+  }
+  auto v_buf = v.request();
+  auto f_buf = f.request();
+  if (v_buf.ndim != 1 || f_buf.ndim != 1){
+    throw std::runtime_error("Error, Dta_Api::get_dar_transpose_product, input dismension mismatch");
+  }
+  if ((size_t) v_buf.shape[0] != m_dar_observation -> m_windows.size() * m_link_vec.size()){
+    throw std::runtime_error("Error, Dta_Api::get_dar_transpose_product, input length mismatch");
+  }
+  if ((size_t) f_buf.shape[0] != num_intervals * m_path_vec.size()){
+    throw std::runtime_error("Error, Dta_Api::get_dar_transpose_product, input path flow mismatch");
+  }
+  std::vector<MNM_Dar_Bins*> _bins_vec = std::vector<MNM_Dar_Bins*>();
+  for (size_t i = 0; i < m_link_vec.size(); ++i){
+    _bins_vec.push_back(m_link_vec[i] -> m_dar_bins);
+  }
+  int new_shape [1] = { (int) (num_intervals * m_path_vec.size()) };
+  auto result = py::array_t<double>(new_shape);
+  auto result_buf = result.request();
+  double *result_prt = (double *) result_buf.ptr;
+  MNM_DTA_GRADIENT::dar_transpose_product(_bins_vec, (double *) v_buf.ptr, (double *) f_buf.ptr, result_prt, 
+                    num_intervals, 1);
+  return result;
+}
+
+py::array_t<double> Dta_Api::get_dar_product(py::array_t<double> u, int num_intervals, py::array_t<double> f)
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Dta_Api::get_dar_product, dar windows not registered");
+  }
+  auto u_buf = u.request();
+  auto f_buf = f.request();
+  if (u_buf.ndim != 1 || f_buf.ndim != 1){
+    throw std::runtime_error("Error, Dta_Api::get_dar_product, input dismension mismatch");
+  }
+  if ((size_t) u_buf.shape[0] != num_intervals * m_path_vec.size()){
+    throw std::runtime_error("Error, Dta_Api::get_dar_product, input length mismatch");
+  }
+  if ((size_t) f_buf.shape[0] != num_intervals * m_path_vec.size()){
+    throw std::runtime_error("Error, Dta_Api::get_dar_product, input path flow mismatch");
+  }
+  std::vector<MNM_Dar_Bins*> _bins_vec = std::vector<MNM_Dar_Bins*>();
+  for (size_t i = 0; i < m_link_vec.size(); ++i){
+    _bins_vec.push_back(m_link_vec[i] -> m_dar_bins);
+  }
+  int new_shape [1] = { (int) (m_dar_observation -> m_windows.size() * m_link_vec.size()) };
+  auto result = py::array_t<double>(new_shape);
+  auto result_buf = result.request();
+  double *result_prt = (double *) result_buf.ptr;
+  MNM_DTA_GRADIENT::dar_product(_bins_vec, (double *) u_buf.ptr, (double *) f_buf.ptr, result_prt, 
+                    num_intervals, 1);
+  return result;
+}
+
 /**********************************************************************************************************
 ***********************************************************************************************************
                         Multiclass
@@ -451,6 +940,8 @@ SparseMatrixR Dta_Api::get_complete_dar_matrix(py::array_t<int>start_intervals,
 Mcdta_Api::Mcdta_Api()
 {
   m_mcdta = NULL;
+  m_memory_folder = "";
+  m_dar_observation = NULL;
   m_link_vec = std::vector<MNM_Dlink_Multiclass*>();
   m_path_vec = std::vector<MNM_Path*>();
   m_path_set = std::set<MNM_Path*>(); 
@@ -462,6 +953,12 @@ Mcdta_Api::~Mcdta_Api()
   if (m_mcdta != NULL){
     delete m_mcdta;
   }
+  if (!m_memory_folder.empty()){
+    ConfigFile::remove_memory_file(m_memory_folder + "/config.conf");
+  }
+  if (m_dar_observation != NULL){
+    delete m_dar_observation;
+  }
   m_link_vec.clear();
   m_path_vec.clear();
   
@@ -473,6 +970,25 @@ int Mcdta_Api::initialize(std::string folder)
   m_mcdta -> build_from_files();
   m_mcdta -> hook_up_node_and_link();
   m_mcdta -> is_ok();
+  return load_ID_path_mapping();
+}
+
+// the demand has the car and then the truck values of every interval, as in MNM_input_demand
+int Mcdta_Api::initialize_from_arrays(py::dict config, py::dict network)
+{
+  m_memory_folder = register_memory_config(config, this);
+  std::vector<py::object> _keep_alive;
+  std::unique_ptr<MNM_Network_Bundle> _bundle(network_to_bundle(network, _keep_alive));
+  m_mcdta = new MNM_Dta_Multiclass(m_memory_folder);
+  m_mcdta -> build_from_memory(_bundle.get());
+  _bundle.reset();
+  m_mcdta -> hook_up_node_and_link();
+  m_mcdta -> is_ok();
+  return load_ID_path_mapping();
+}
+
+int Mcdta_Api::load_ID_path_mapping()
+{
   if (MNM_Routing_Fixed *_routing = dynamic_cast<MNM_Routing_Fixed *>(m_mcdta -> m_routing)){
     MNM::get_ID_path_mapping(m_ID_path_mapping, _routing -> m_path_table);
     return 0;
@@ -546,6 +1062,80 @@ int Mcdta_Api::register_links(py::array_t<int> links)
   return 0;
 }
 
+// back to t=0 without rebuilding the network, call run_whole again to reload
+int Mcdta_Api::reset()
+{
+  m_mcdta -> reset();
+  return 0;
+}
+
+// buffer: num_path x buffer_length, rows follow the registered paths
+int Mcdta_Api::update_path_buffer(py::array_t<double> buffer)
+{
+  auto buffer_buf = buffer.request();
+  if (buffer_buf.ndim != 2){
+    throw std::runtime_error("Error, Mcdta_Api::update_path_buffer, input dismension mismatch");
+  }
+  if (buffer_buf.shape[0] != (int) m_path_vec.size()){
+    throw std::runtime_error("Error, Mcdta_Api::update_path_buffer, number of paths mismatch");
+  }
+  int l = buffer_buf.shape[1];
+  double *buffer_ptr = (double *) buffer_buf.ptr;
+  MNM_Path *_path;
+  for (size_t i = 0; i < m_path_vec.size(); ++i){
+    _path = m_path_vec[i];
+    if (_path -> m_buffer_length != l){
+      throw std::runtime_error("Error, Mcdta_Api::update_path_buffer, buffer length mismatch");
+    }
+    for (int j = 0; j < l; ++j){
+      _path -> m_buffer[j] = TFlt(buffer_ptr[i * l + j]);
+    }
+  }
+  return 0;
+}
+
+// demand_car/demand_truck: num_OD x max_interval, same as MNM_input_demand
+int Mcdta_Api::update_od_demand(py::array_t<int> O_IDs, py::array_t<int> D_IDs, 
+                                py::array_t<double> demand_car, py::array_t<double> demand_truck)
+{
+  auto O_buf = O_IDs.request();
+  auto D_buf = D_IDs.request();
+  auto car_buf = demand_car.request();
+  auto truck_buf = demand_truck.request();
+  if (O_buf.ndim != 1 || D_buf.ndim != 1 || car_buf.ndim != 2 || truck_buf.ndim != 2){
+    throw std::runtime_error("Error, Mcdta_Api::update_od_demand, input dismension mismatch");
+  }
+  if (O_buf.shape[0] != D_buf.shape[0] || O_buf.shape[0] != car_buf.shape[0] || O_buf.shape[0] != truck_buf.shape[0]){
+    throw std::runtime_error("Error, Mcdta_Api::update_od_demand, input length mismatch");
+  }
+  int _max_interval = m_mcdta -> m_config -> get_int("max_interval");
+  if (car_buf.shape[1] != _max_interval || truck_buf.shape[1] != _max_interval){
+    throw std::runtime_error("Error, Mcdta_Api::update_od_demand, demand length mismatch");
+  }
+  int *O_ptr = (int *) O_buf.ptr;
+  int *D_ptr = (int *) D_buf.ptr;
+  double *car_ptr = (double *) car_buf.ptr;
+  double *truck_ptr = (double *) truck_buf.ptr;
+  // split into 1-minute demand as in MNM_IO_Multiclass::build_demand_multiclass
+  int _num_of_minute = int(m_mcdta -> m_config -> get_int("assign_frq")) / (60 / int(m_mcdta -> m_unit_time));
+  std::vector<TFlt> _demand_vector_car = std::vector<TFlt>(_max_interval * _num_of_minute);
+  std::vector<TFlt> _demand_vector_truck = std::vector<TFlt>(_max_interval * _num_of_minute);
+  MNM_Origin_Multiclass *_origin;
+  MNM_Destination_Multiclass *_dest;
+  for (int i = 0; i < O_buf.shape[0]; ++i){
+    for (int j = 0; j < _max_interval; ++j){
+      for (int k = 0; k < _num_of_minute; ++k){
+        _demand_vector_car[j * _num_of_minute + k] = TFlt(car_ptr[i * _max_interval + j] / _num_of_minute);
+        _demand_vector_truck[j * _num_of_minute + k] = TFlt(truck_ptr[i * _max_interval + j] / _num_of_minute);
+      }
+    }
+    _origin = dynamic_cast<MNM_Origin_Multiclass *>(m_mcdta -> m_od_factory -> get_origin(TInt(O_ptr[i])));
+    _dest = dynamic_cast<MNM_Destination_Multiclass *>(m_mcdta -> m_od_factory -> get_destination(TInt(D_ptr[i])));
+    _origin -> set_dest_demand_multiclass(_dest, _demand_vector_car.data(), _demand_vector_truck.data(), _num_of_minute);
+  }
+  return 0;
+}
+
 int Mcdta_Api::get_cur_loading_interval()
 {
   return m_mcdta -> m_current_loading_interval();
@@ -702,6 +1292,96 @@ py::array_t<double> Mcdta_Api::get_path_tt_truck(py::array_t<int>link_IDs, py::a
 }
 
 
+// unit: m_mcdta -> m_unit_time (eg: 5 seconds), same clock as Dta_Api::get_path_tt_batch
+py::array_t<double> Mcdta_Api::get_path_tt_car_batch(py::array_t<int>start_intervals)
+{
+  auto start_buf = start_intervals.request();
+  if (start_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::get_path_tt_car_batch, input dismension mismatch");
+  }
+  int l = start_buf.shape[0];
+  int *start_prt = (int *) start_buf.ptr;
+  int _num_interval = get_cur_loading_interval();
+  if (_num_interval <= 0){
+    throw std::runtime_error("Error, Mcdta_Api::get_path_tt_car_batch, nothing loaded yet");
+  }
+  std::vector<double> _depart_time = std::vector<double>(l);
+  for (int t = 0; t < l; ++t){
+    if (start_prt[t] > _num_interval){
+      throw std::runtime_error("Error, Mcdta_Api::get_path_tt_car_batch, loaded data not enough");
+    }
+    _depart_time[t] = double(start_prt[t]);
+  }
+  std::unordered_map<TInt, TInt> _link_index = std::unordered_map<TInt, TInt>();
+  std::vector<MNM_Dlink_Multiclass*> _path_link_vec = std::vector<MNM_Dlink_Multiclass*>();
+  for (MNM_Path *_path : m_path_vec){
+    for (TInt _link_ID : _path -> m_link_vec){
+      if (_link_index.find(_link_ID) == _link_index.end()){
+        _link_index.insert(std::pair<TInt, TInt>(_link_ID, TInt(_path_link_vec.size())));
+        _path_link_vec.push_back(dynamic_cast<MNM_Dlink_Multiclass *>(m_mcdta -> m_link_factory -> get_link(_link_ID)));
+      }
+    }
+  }
+  std::vector<double> _tt = std::vector<double>(_path_link_vec.size() * _num_interval);
+  for (size_t i = 0; i < _path_link_vec.size(); ++i){
+    for (int t = 0; t < _num_interval; ++t){
+      _tt[i * _num_interval + t] = MNM_DTA_GRADIENT::get_travel_time_car(_path_link_vec[i], TFlt(t))();
+    }
+  }
+  int new_shape [2] = { (int) m_path_vec.size(), l}; 
+  auto result = py::array_t<double>(new_shape);
+  auto result_buf = result.request();
+  double *result_prt = (double *) result_buf.ptr;
+  MNM_Path_TT_Trie _trie(m_path_vec, _link_index);
+  _trie.get_path_tt(_tt.data(), _num_interval, _depart_time.data(), l, result_prt);
+  return result;
+}
+
+// unit: m_mcdta -> m_unit_time (eg: 5 seconds), same clock as Dta_Api::get_path_tt_batch
+py::array_t<double> Mcdta_Api::get_path_tt_truck_batch(py::array_t<int>start_intervals)
+{
+  auto start_buf = start_intervals.request();
+  if (start_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::get_path_tt_truck_batch, input dismension mismatch");
+  }
+  int l = start_buf.shape[0];
+  int *start_prt = (int *) start_buf.ptr;
+  int _num_interval = get_cur_loading_interval();
+  if (_num_interval <= 0){
+    throw std::runtime_error("Error, Mcdta_Api::get_path_tt_truck_batch, nothing loaded yet");
+  }
+  std::vector<double> _depart_time = std::vector<double>(l);
+  for (int t = 0; t < l; ++t){
+    if (start_prt[t] > _num_interval){
+      throw std::runtime_error("Error, Mcdta_Api::get_path_tt_truck_batch, loaded data not enough");
+    }
+    _depart_time[t] = double(start_prt[t]);
+  }
+  std::unordered_map<TInt, TInt> _link_index = std::unordered_map<TInt, TInt>();
+  std::vector<MNM_Dlink_Multiclass*> _path_link_vec = std::vector<MNM_Dlink_Multiclass*>();
+  for (MNM_Path *_path : m_path_vec){
+    for (TInt _link_ID : _path -> m_link_vec){
+      if (_link_index.find(_link_ID) == _link_index.end()){
+        _link_index.insert(std::pair<TInt, TInt>(_link_ID, TInt(_path_link_vec.size())));
+        _path_link_vec.push_back(dynamic_cast<MNM_Dlink_Multiclass *>(m_mcdta -> m_link_factory -> get_link(_link_ID)));
+      }
+    }
+  }
+  std::vector<double> _tt = std::vector<double>(_path_link_vec.size() * _num_interval);
+  for (size_t i = 0; i < _path_link_vec.size(); ++i){
+    for (int t = 0; t < _num_interval; ++t){
+      _tt[i * _num_interval + t] = MNM_DTA_GRADIENT::get_travel_time_truck(_path_link_vec[i], TFlt(t))();
+    }
+  }
+  int new_shape [2] = { (int) m_path_vec.size(), l}; 
+  auto result = py::array_t<double>(new_shape);
+  auto result_buf = result.request();
+  double *result_prt = (double *) result_buf.ptr;
+  MNM_Path_TT_Trie _trie(m_path_vec, _link_index);
+  _trie.get_path_tt(_tt.data(), _num_interval, _depart_time.data(), l, result_prt);
+  return result;
+}
+
 // unit: m_mcdta -> m_unit_time (eg: 5 seconds)
 py::array_t<double> Mcdta_Api::get_car_link_tt(py::array_t<double>start_intervals)
 {
@@ -914,6 +1594,7 @@ int Mcdta_Api::register_paths(py::array_t<int> paths)
     printf("Warning, Mcdta_Api::register_paths, path exists\n");
     m_path_vec.clear();
     m_path_set.clear();
+    m_path_map.clear();
   }
   auto paths_buf = paths.request();
   if (paths_buf.ndim != 1){
@@ -929,6 +1610,7 @@ int Mcdta_Api::register_paths(py::array_t<int> paths)
     }
     else {
       m_path_vec.push_back(m_ID_path_mapping[_path_ID]);
+      m_path_map.insert(std::make_pair(m_ID_path_mapping[_path_ID], i));
     }
   }
   m_path_set = std::set<MNM_Path*> (m_path_vec.begin(), m_path_vec.end());
@@ -1141,6 +1823,302 @@ py::array_t<double> Mcdta_Api::get_truck_dar_matrix(py::array_t<int>start_interv
 }
 
 
+// register the observation windows before run_whole, DAR is then accumulated during loading
+// without the cc tree, links and paths must be registered first
+int Mcdta_Api::register_dar_windows(py::array_t<int>start_intervals, py::array_t<int>end_intervals)
+{
+  auto start_buf = start_intervals.request();
+  auto end_buf = end_intervals.request();
+  if (start_buf.ndim != 1 || end_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::register_dar_windows, input dismension mismatch");
+  }
+  if (start_buf.shape[0] != end_buf.shape[0]){
+    throw std::runtime_error("Error, Mcdta_Api::register_dar_windows, input length mismatch");
+  }
+  if (m_link_vec.size() == 0 || m_path_vec.size() == 0){
+    throw std::runtime_error("Error, Mcdta_Api::register_dar_windows, links or paths not registered");
+  }
+  int l = start_buf.shape[0];
+  int *start_prt = (int *) start_buf.ptr;
+  int *end_prt = (int *) end_buf.ptr;
+  std::vector<std::pair<TInt, TInt>> _windows = std::vector<std::pair<TInt, TInt>>();
+  for (int t = 0; t < l; ++t){
+    _windows.push_back(std::pair<TInt, TInt>(TInt(start_prt[t]), TInt(end_prt[t])));
+  }
+  if (m_dar_observation != NULL){
+    delete m_dar_observation;
+  }
+  m_dar_observation = new MNM_Dar_Observation(_windows, m_path_vec);
+  for (size_t i = 0; i < m_link_vec.size(); ++i){
+    m_link_vec[i] -> install_dar_bins_multiclass(m_dar_observation);
+  }
+  return 0;
+}
+
+py::array_t<double> Mcdta_Api::get_car_dar_matrix_online()
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Mcdta_Api::get_car_dar_matrix_online, dar windows not registered");
+  }
+  std::vector<dar_record*> _record = std::vector<dar_record*>();
+  for (size_t i = 0; i<m_link_vec.size(); ++i){
+    MNM_DTA_GRADIENT::add_dar_records_bins(_record, m_link_vec[i], m_link_vec[i] -> m_dar_bins_car);
+  }
+  return dar_records_to_array(_record);
+}
+
+py::array_t<double> Mcdta_Api::get_truck_dar_matrix_online()
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Mcdta_Api::get_truck_dar_matrix_online, dar windows not registered");
+  }
+  std::vector<dar_record*> _record = std::vector<dar_record*>();
+  for (size_t i = 0; i<m_link_vec.size(); ++i){
+    MNM_DTA_GRADIENT::add_dar_records_bins(_record, m_link_vec[i], m_link_vec[i] -> m_dar_bins_truck);
+  }
+  return dar_records_to_array(_record);
+}
+
+
+py::tuple Mcdta_Api::get_complete_car_dar_matrix_csr(py::array_t<int>start_intervals, py::array_t<int>end_intervals,
+                                                int num_intervals, int small_assign_freq, py::array_t<double> f)
+{
+  int _num_e_path = m_path_vec.size();
+  int _num_e_link = m_link_vec.size();
+  auto start_buf = start_intervals.request();
+  auto end_buf = end_intervals.request();
+  auto f_buf = f.request();
+  if (start_buf.ndim != 1 || end_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::get_complete_car_dar_matrix_csr, input dismension mismatch");
+  }
+  if (start_buf.shape[0] != end_buf.shape[0]){
+    throw std::runtime_error("Error, Mcdta_Api::get_complete_car_dar_matrix_csr, input length mismatch");
+  }
+  if (f_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::get_complete_car_dar_matrix_csr, input path flow mismatch");
+  }
+  int l = start_buf.shape[0];
+  int *start_prt = (int *) start_buf.ptr;
+  int *end_prt = (int *) end_buf.ptr;
+  double *f_ptr = (double *) f_buf.ptr;
+
+  std::vector<Eigen::Triplet<double>> _record;
+  _record.reserve(100000);
+  for (int t = 0; t < l; ++t){
+    if (end_prt[t] < start_prt[t]){
+      throw std::runtime_error("Error, Mcdta_Api::get_complete_car_dar_matrix_csr, end time smaller than start time");
+    }
+    if (end_prt[t] > get_cur_loading_interval()){
+      throw std::runtime_error("Error, Mcdta_Api::get_complete_car_dar_matrix_csr, loaded data not enough");
+    }
+    for (size_t i = 0; i<m_link_vec.size(); ++i){
+      MNM_DTA_GRADIENT::add_dar_records_tree_eigen(
+                    _record, m_link_vec[i] -> m_N_in_tree_car, m_path_map, TFlt(start_prt[t]), TFlt(end_prt[t]),
+                    i, t, _num_e_link, _num_e_path, small_assign_freq, f_ptr);
+    }
+  }
+  return triplets_to_csr(_record, num_intervals * _num_e_link, num_intervals * _num_e_path);
+}
+
+py::tuple Mcdta_Api::get_complete_truck_dar_matrix_csr(py::array_t<int>start_intervals, py::array_t<int>end_intervals,
+                                                int num_intervals, int small_assign_freq, py::array_t<double> f)
+{
+  int _num_e_path = m_path_vec.size();
+  int _num_e_link = m_link_vec.size();
+  auto start_buf = start_intervals.request();
+  auto end_buf = end_intervals.request();
+  auto f_buf = f.request();
+  if (start_buf.ndim != 1 || end_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::get_complete_truck_dar_matrix_csr, input dismension mismatch");
+  }
+  if (start_buf.shape[0] != end_buf.shape[0]){
+    throw std::runtime_error("Error, Mcdta_Api::get_complete_truck_dar_matrix_csr, input length mismatch");
+  }
+  if (f_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::get_complete_truck_dar_matrix_csr, input path flow mismatch");
+  }
+  int l = start_buf.shape[0];
+  int *start_prt = (int *) start_buf.ptr;
+  int *end_prt = (int *) end_buf.ptr;
+  double *f_ptr = (double *) f_buf.ptr;
+
+  std::vector<Eigen::Triplet<double>> _record;
+  _record.reserve(100000);
+  for (int t = 0; t < l; ++t){
+    if (end_prt[t] < start_prt[t]){
+      throw std::runtime_error("Error, Mcdta_Api::get_complete_truck_dar_matrix_csr, end time smaller than start time");
+    }
+    if (end_prt[t] > get_cur_loading_interval()){
+      throw std::runtime_error("Error, Mcdta_Api::get_complete_truck_dar_matrix_csr, loaded data not enough");
+    }
+    for (size_t i = 0; i<m_link_vec.size(); ++i){
+      MNM_DTA_GRADIENT::add_dar_records_tree_eigen(
+                    _record, m_link_vec[i] -> m_N_in_tree_truck, m_path_map, TFlt(start_prt[t]), TFlt(end_prt[t]),
+                    i, t, _num_e_link, _num_e_path, small_assign_freq, f_ptr);
+    }
+  }
+  return triplets_to_csr(_record, num_intervals * _num_e_link, num_intervals * _num_e_path);
+}
+
+py::tuple Mcdta_Api::get_complete_car_dar_matrix_online_csr(int num_intervals, int small_assign_freq, py::array_t<double> f)
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Mcdta_Api::get_complete_car_dar_matrix_online_csr, dar windows not registered");
+  }
+  int _num_e_path = m_path_vec.size();
+  int _num_e_link = m_link_vec.size();
+  auto f_buf = f.request();
+  if (f_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::get_complete_car_dar_matrix_online_csr, input path flow mismatch");
+  }
+  double *f_ptr = (double *) f_buf.ptr;
+
+  std::vector<Eigen::Triplet<double>> _record;
+  _record.reserve(100000);
+  for (size_t i = 0; i<m_link_vec.size(); ++i){
+    MNM_DTA_GRADIENT::add_dar_records_bins_eigen(_record, m_link_vec[i] -> m_dar_bins_car, i, _num_e_link, small_assign_freq, f_ptr);
+  }
+  return triplets_to_csr(_record, num_intervals * _num_e_link, num_intervals * _num_e_path);
+}
+
+py::tuple Mcdta_Api::get_complete_truck_dar_matrix_online_csr(int num_intervals, int small_assign_freq, py::array_t<double> f)
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Mcdta_Api::get_complete_truck_dar_matrix_online_csr, dar windows not registered");
+  }
+  int _num_e_path = m_path_vec.size();
+  int _num_e_link = m_link_vec.size();
+  auto f_buf = f.request();
+  if (f_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::get_complete_truck_dar_matrix_online_csr, input path flow mismatch");
+  }
+  double *f_ptr = (double *) f_buf.ptr;
+
+  std::vector<Eigen::Triplet<double>> _record;
+  _record.reserve(100000);
+  for (size_t i = 0; i<m_link_vec.size(); ++i){
+    MNM_DTA_GRADIENT::add_dar_records_bins_eigen(_record, m_link_vec[i] -> m_dar_bins_truck, i, _num_e_link, small_assign_freq, f_ptr);
+  }
+  return triplets_to_csr(_record, num_intervals * _num_e_link, num_intervals * _num_e_path);
+}
+
+py::array_t<double> Mcdta_Api::get_car_dar_transpose_product(py::array_t<double> v, int num_intervals, int small_assign_freq, py::array_t<double> f)
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Mcdta_Api::get_car_dar_transpose_product, dar windows not registered");
+  }
+  auto v_buf = v.request();
+  auto f_buf = f.request();
+  if (v_buf.ndim != 1 || f_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::get_car_dar_transpose_product, input dismension mismatch");
+  }
+  if ((size_t) v_buf.shape[0] != m_dar_observation -> m_windows.size() * m_link_vec.size()){
+    throw std::runtime_error("Error, Mcdta_Api::get_car_dar_transpose_product, input length mismatch");
+  }
+  if ((size_t) f_buf.shape[0] != num_intervals * m_path_vec.size()){
+    throw std::runtime_error("Error, Mcdta_Api::get_car_dar_transpose_product, input path flow mismatch");
+  }
+  std::vector<MNM_Dar_Bins*> _bins_vec = std::vector<MNM_Dar_Bins*>();
+  for (size_t i = 0; i < m_link_vec.size(); ++i){
+    _bins_vec.push_back(m_link_vec[i] -> m_dar_bins_car);
+  }
+  int new_shape [1] = { (int) (num_intervals * m_path_vec.size()) };
+  auto result = py::array_t<double>(new_shape);
+  auto result_buf = result.request();
+  double *result_prt = (double *) result_buf.ptr;
+  MNM_DTA_GRADIENT::dar_transpose_product(_bins_vec, (double *) v_buf.ptr, (double *) f_buf.ptr, result_prt, 
+                    num_intervals, small_assign_freq);
+  return result;
+}
+
+py::array_t<double> Mcdta_Api::get_truck_dar_transpose_product(py::array_t<double> v, int num_intervals, int small_assign_freq, py::array_t<double> f)
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Mcdta_Api::get_truck_dar_transpose_product, dar windows not registered");
+  }
+  auto v_buf = v.request();
+  auto f_buf = f.request();
+  if (v_buf.ndim != 1 || f_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::get_truck_dar_transpose_product, input dismension mismatch");
+  }
+  if ((size_t) v_buf.shape[0] != m_dar_observation -> m_windows.size() * m_link_vec.size()){
+    throw std::runtime_error("Error, Mcdta_Api::get_truck_dar_transpose_product, input length mismatch");
+  }
+  if ((size_t) f_buf.shape[0] != num_intervals * m_path_vec.size()){
+    throw std::runtime_error("Error, Mcdta_Api::get_truck_dar_transpose_product, input path flow mismatch");
+  }
+  std::vector<MNM_Dar_Bins*> _bins_vec = std::vector<MNM_Dar_Bins*>();
+  for (size_t i = 0; i < m_link_vec.size(); ++i){
+    _bins_vec.push_back(m_link_vec[i] -> m_dar_bins_truck);
+  }
+  int new_shape [1] = { (int) (num_intervals * m_path_vec.size()) };
+  auto result = py::array_t<double>(new_shape);
+  auto result_buf = result.request();
+  double *result_prt = (double *) result_buf.ptr;
+  MNM_DTA_GRADIENT::dar_transpose_product(_bins_vec, (double *) v_buf.ptr, (double *) f_buf.ptr, result_prt, 
+                    num_intervals, small_assign_freq);
+  return result;
+}
+
+py::array_t<double> Mcdta_Api::get_car_dar_product(py::array_t<double> u, int num_intervals, int small_assign_freq, py::array_t<double> f)
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Mcdta_Api::get_car_dar_product, dar windows not registered");
+  }
+  auto u_buf = u.request();
+  auto f_buf = f.request();
+  if (u_buf.ndim != 1 || f_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::get_car_dar_product, input dismension mismatch");
+  }
+  if ((size_t) u_buf.shape[0] != num_intervals * m_path_vec.size()){
+    throw std::runtime_error("Error, Mcdta_Api::get_car_dar_product, input length mismatch");
+  }
+  if ((size_t) f_buf.shape[0] != num_intervals * m_path_vec.size()){
+    throw std::runtime_error("Error, Mcdta_Api::get_car_dar_product, input path flow mismatch");
+  }
+  std::vector<MNM_Dar_Bins*> _bins_vec = std::vector<MNM_Dar_Bins*>();
+  for (size_t i = 0; i < m_link_vec.size(); ++i){
+    _bins_vec.push_back(m_link_vec[i] -> m_dar_bins_car);
+  }
+  int new_shape [1] = { (int) (m_dar_observation -> m_windows.size() * m_link_vec.size()) };
+  auto result = py::array_t<double>(new_shape);
+  auto result_buf = result.request();
+  double *result_prt = (double *) result_buf.ptr;
+  MNM_DTA_GRADIENT::dar_product(_bins_vec, (double *) u_buf.ptr, (double *) f_buf.ptr, result_prt, 
+                    num_intervals, small_assign_freq);
+  return result;
+}
+
+py::array_t<double> Mcdta_Api::get_truck_dar_product(py::array_t<double> u, int num_intervals, int small_assign_freq, py::array_t<double> f)
+{
+  if (m_dar_observation == NULL){
+    throw std::runtime_error("Error, Mcdta_Api::get_truck_dar_product, dar windows not registered");
+  }
+  auto u_buf = u.request();
+  auto f_buf = f.request();
+  if (u_buf.ndim != 1 || f_buf.ndim != 1){
+    throw std::runtime_error("Error, Mcdta_Api::get_truck_dar_product, input dismension mismatch");
+  }
+  if ((size_t) u_buf.shape[0] != num_intervals * m_path_vec.size()){
+    throw std::runtime_error("Error, Mcdta_Api::get_truck_dar_product, input length mismatch");
+  }
+  if ((size_t) f_buf.shape[0] != num_intervals * m_path_vec.size()){
+    throw std::runtime_error("Error, Mcdta_Api::get_truck_dar_product, input path flow mismatch");
+  }
+  std::vector<MNM_Dar_Bins*> _bins_vec = std::vector<MNM_Dar_Bins*>();
+  for (size_t i = 0; i < m_link_vec.size(); ++i){
+    _bins_vec.push_back(m_link_vec[i] -> m_dar_bins_truck);
+  }
+  int new_shape [1] = { (int) (m_dar_observation -> m_windows.size() * m_link_vec.size()) };
+  auto result = py::array_t<double>(new_shape);
+  auto result_buf = result.request();
+  double *result_prt = (double *) result_buf.ptr;
+  MNM_DTA_GRADIENT::dar_product(_bins_vec, (double *) u_buf.ptr, (double *) f_buf.ptr, result_prt, 
+                    num_intervals, small_assign_freq);
+  return result;
+}
+
+
 PYBIND11_MODULE(MNMAPI, m) {
     m.doc() = R"pbdoc(
         Pybind11 example plugin
@@ -1176,7 +2154,11 @@ PYBIND11_MODULE(MNMAPI, m) {
     py::class_<Dta_Api> (m, "dta_api")
             .def(py::init<>())
             .def("initialize", &Dta_Api::initialize)
+            .def("initialize_from_arrays", &Dta_Api::initialize_from_arrays)
             .def("run_whole", &Dta_Api::run_whole)
+            .def("reset", &Dta_Api::reset)
+            .def("update_path_buffer", &Dta_Api::update_path_buffer)
+            .def("update_od_demand", &Dta_Api::update_od_demand)
             .def("install_cc", &Dta_Api::install_cc)
             .def("install_cc_tree", &Dta_Api::install_cc_tree)
             .def("get_cur_loading_interval", &Dta_Api::get_cur_loading_interval)
@@ -1184,16 +2166,28 @@ PYBIND11_MODULE(MNMAPI, m) {
             .def("register_paths", &Dta_Api::register_paths)
             .def("get_link_tt", &Dta_Api::get_link_tt)
             .def("get_path_tt", &Dta_Api::get_path_tt)
+            .def("get_path_tt_batch", &Dta_Api::get_path_tt_batch)
             .def("get_link_inflow", &Dta_Api::get_link_inflow)
             .def("get_link_in_cc", &Dta_Api::get_link_in_cc)
             .def("get_link_out_cc", &Dta_Api::get_link_out_cc)
             .def("get_dar_matrix", &Dta_Api::get_dar_matrix)
-            .def("get_complete_dar_matrix", &Dta_Api::get_complete_dar_matrix);
+            .def("get_complete_dar_matrix", &Dta_Api::get_complete_dar_matrix)
+            .def("register_dar_windows", &Dta_Api::register_dar_windows)
+            .def("get_dar_matrix_online", &Dta_Api::get_dar_matrix_online)
+            .def("get_complete_dar_matrix_online", &Dta_Api::get_complete_dar_matrix_online)
+            .def("get_complete_dar_matrix_csr", &Dta_Api::get_complete_dar_matrix_csr)
+            .def("get_complete_dar_matrix_online_csr", &Dta_Api::get_complete_dar_matrix_online_csr)
+            .def("get_dar_transpose_product", &Dta_Api::get_dar_transpose_product)
+            .def("get_dar_product", &Dta_Api::get_dar_product);
 
     py::class_<Mcdta_Api> (m, "mcdta_api")
             .def(py::init<>())
             .def("initialize", &Mcdta_Api::initialize)
+            .def("initialize_from_arrays", &Mcdta_Api::initialize_from_arrays)
             .def("run_whole", &Mcdta_Api::run_whole)
+            .def("reset", &Mcdta_Api::reset)
+            .def("update_path_buffer", &Mcdta_Api::update_path_buffer)
+            .def("update_od_demand", &Mcdta_Api::update_od_demand)
             .def("install_cc", &Mcdta_Api::install_cc)
             .def("install_cc_tree", &Mcdta_Api::install_cc_tree)
             .def("get_emission_stats", &Mcdta_Api::get_emission_stats)
@@ -1217,12 +2211,25 @@ PYBIND11_MODULE(MNMAPI, m) {
             //.def("get_car_link_out_cc", &Mcdta_Api::get_car_link_out_cc)
             .def("get_car_dar_matrix", &Mcdta_Api::get_car_dar_matrix)
             .def("get_truck_dar_matrix", &Mcdta_Api::get_truck_dar_matrix)
+            .def("register_dar_windows", &Mcdta_Api::register_dar_windows)
+            .def("get_car_dar_matrix_online", &Mcdta_Api::get_car_dar_matrix_online)
+            .def("get_truck_dar_matrix_online", &Mcdta_Api::get_truck_dar_matrix_online)
+            .def("get_complete_car_dar_matrix_csr", &Mcdta_Api::get_complete_car_dar_matrix_csr)
+            .def("get_complete_truck_dar_matrix_csr", &Mcdta_Api::get_complete_truck_dar_matrix_csr)
+            .def("get_complete_car_dar_matrix_online_csr", &Mcdta_Api::get_complete_car_dar_matrix_online_csr)
+            .def("get_complete_truck_dar_matrix_online_csr", &Mcdta_Api::get_complete_truck_dar_matrix_online_csr)
+            .def("get_car_dar_transpose_product", &Mcdta_Api::get_car_dar_transpose_product)
+            .def("get_truck_dar_transpose_product", &Mcdta_Api::get_truck_dar_transpose_product)
+            .def("get_car_dar_product", &Mcdta_Api::get_car_dar_product)
+            .def("get_truck_dar_product", &Mcdta_Api::get_truck_dar_product)
             
             //For scenarios in McKees Rocks project:
             .def("get_waiting_time_at_intersections", &Mcdta_Api::get_waiting_time_at_intersections)
             .def("get_link_spillback", &Mcdta_Api::get_link_spillback)
             .def("get_path_tt_car", &Mcdta_Api::get_path_tt_car)
-            .def("get_path_tt_truck", &Mcdta_Api::get_path_tt_truck);
+            .def("get_path_tt_truck", &Mcdta_Api::get_path_tt_truck)
+            .def("get_path_tt_car_batch", &Mcdta_Api::get_path_tt_car_batch)
+            .def("get_path_tt_truck_batch", &Mcdta_Api::get_path_tt_truck_batch);
 #ifdef VERSION_INFO
     m.attr("__version__") = VERSION_INFO;
 #else
@@ -8,6 +8,7 @@
 #include "Snap.h"
 #include "dta.h"
 #include "multiclass.h"
+#include "dta_gradient_utls.h"
 
 #include <set>
 
@@ -17,6 +18,16 @@ using SparseMatrixR = Eigen::SparseMatrix<double, Eigen::RowMajor>;
 
 int run_dta(std::string folder);
 
+// (data, indices, indptr, shape) for scipy.sparse.csr_matrix, buffers are owned by C++
+py::tuple triplets_to_csr(std::vector<Eigen::Triplet<double>> &record, int num_rows, int num_cols);
+// one row (path_ID, assign_time, link_ID, start_int, flow) per record, the records are deleted
+py::array_t<double> dar_records_to_array(std::vector<dar_record*> &record);
+
+// config {section: {key: value}} as in config.conf, kept in memory as <folder>/config.conf of a folder named after owner
+std::string register_memory_config(py::dict config, const void *owner);
+// the network of initialize_from_arrays as a bundle in memory, keep_alive holds the arrays its columns point to
+MNM_Network_Bundle *network_to_bundle(py::dict network, std::vector<py::object> &keep_alive);
+
 
 class Dta_Api
 {
@@ -24,10 +35,15 @@ public:
   Dta_Api();
   ~Dta_Api();
   int initialize(std::string folder);
+  // no input files: config as {section: {key: value}} and the input files as arrays in network
+  int initialize_from_arrays(py::dict config, py::dict network);
   int install_cc();
   int install_cc_tree();
   int run_once();
   int run_whole();
+  int reset();
+  int update_path_buffer(py::array_t<double> buffer);
+  int update_od_demand(py::array_t<int> O_IDs, py::array_t<int> D_IDs, py::array_t<double> demand);
   int register_links(py::array_t<int> links);
   int register_paths(py::array_t<int> paths);
   int get_cur_loading_interval();
@@ -35,17 +51,30 @@ public:
                                         py::array_t<int>end_intervals);
   py::array_t<double> get_link_tt(py::array_t<int>start_intervals);
   py::array_t<double> get_path_tt(py::array_t<int>start_intervals);
+  py::array_t<double> get_path_tt_batch(py::array_t<int>start_intervals);
   py::array_t<double> get_link_in_cc(int link_ID);
   py::array_t<double> get_link_out_cc(int link_ID);
   py::array_t<double> get_dar_matrix(py::array_t<int>link_start_intervals, py::array_t<int>link_end_intervals);
   SparseMatrixR get_complete_dar_matrix(py::array_t<int>start_intervals, py::array_t<int>end_intervals,
                                                 int num_intervals, py::array_t<double> f);
+  int register_dar_windows(py::array_t<int>start_intervals, py::array_t<int>end_intervals);
+  py::array_t<double> get_dar_matrix_online();
+  SparseMatrixR get_complete_dar_matrix_online(int num_intervals, py::array_t<double> f);
+  py::tuple get_complete_dar_matrix_csr(py::array_t<int>start_intervals, py::array_t<int>end_intervals,
+                                                int num_intervals, py::array_t<double> f);
+  py::tuple get_complete_dar_matrix_online_csr(int num_intervals, py::array_t<double> f);
+  py::array_t<double> get_dar_transpose_product(py::array_t<double> v, int num_intervals, py::array_t<double> f);
+  py::array_t<double> get_dar_product(py::array_t<double> u, int num_intervals, py::array_t<double> f);
   MNM_Dta *m_dta;
+  MNM_Dar_Observation *m_dar_observation;
   std::vector<MNM_Dlink*> m_link_vec;
   std::vector<MNM_Path*> m_path_vec;
   std::unordered_map<MNM_Path*, int> m_path_map; 
   // std::unordered_map<MNM_Dlink*, int> m_link_map; 
   std::unordered_map<TInt, MNM_Path*> m_ID_path_mapping;
+  std::string m_memory_folder;
+private:
+  int load_ID_path_mapping();
 };
 
 
@@ -56,9 +85,15 @@ public:
   Mcdta_Api();
   ~Mcdta_Api();
   int initialize(std::string folder);
+  // no input files: config as {section: {key: value}} and the input files as arrays in network
+  int initialize_from_arrays(py::dict config, py::dict network);
   int install_cc();
   int install_cc_tree();
   int run_whole();
+  int reset();
+  int update_path_buffer(py::array_t<double> buffer);
+  int update_od_demand(py::array_t<int> O_IDs, py::array_t<int> D_IDs, 
+                        py::array_t<double> demand_car, py::array_t<double> demand_truck);
   int register_links(py::array_t<int> links);
   int get_cur_loading_interval();
   py::array_t<double> get_emission_stats();
@@ -84,17 +119,40 @@ public:
 
   py::array_t<double> get_car_dar_matrix(py::array_t<int>start_intervals, py::array_t<int>end_intervals);
   py::array_t<double> get_truck_dar_matrix(py::array_t<int>start_intervals, py::array_t<int>end_intervals);
+
+  int register_dar_windows(py::array_t<int>start_intervals, py::array_t<int>end_intervals);
+  py::array_t<double> get_car_dar_matrix_online();
+  py::array_t<double> get_truck_dar_matrix_online();
+
+  // small_assign_freq: number of departing intervals grouped into one assign interval
+  py::tuple get_complete_car_dar_matrix_csr(py::array_t<int>start_intervals, py::array_t<int>end_intervals,
+                                                int num_intervals, int small_assign_freq, py::array_t<double> f);
+  py::tuple get_complete_truck_dar_matrix_csr(py::array_t<int>start_intervals, py::array_t<int>end_intervals,
+                                                int num_intervals, int small_assign_freq, py::array_t<double> f);
+  py::tuple get_complete_car_dar_matrix_online_csr(int num_intervals, int small_assign_freq, py::array_t<double> f);
+  py::tuple get_complete_truck_dar_matrix_online_csr(int num_intervals, int small_assign_freq, py::array_t<double> f);
+  py::array_t<double> get_car_dar_transpose_product(py::array_t<double> v, int num_intervals, int small_assign_freq, py::array_t<double> f);
+  py::array_t<double> get_truck_dar_transpose_product(py::array_t<double> v, int num_intervals, int small_assign_freq, py::array_t<double> f);
+  py::array_t<double> get_car_dar_product(py::array_t<double> u, int num_intervals, int small_assign_freq, py::array_t<double> f);
+  py::array_t<double> get_truck_dar_product(py::array_t<double> u, int num_intervals, int small_assign_freq, py::array_t<double> f);
   
   py::array_t<double> get_waiting_time_at_intersections();
   py::array_t<int> get_link_spillback();
   py::array_t<double> get_path_tt_car(py::array_t<int>link_IDs, py::array_t<double>start_intervals);
   py::array_t<double> get_path_tt_truck(py::array_t<int>link_IDs, py::array_t<double>start_intervals);
+  py::array_t<double> get_path_tt_car_batch(py::array_t<int>start_intervals);
+  py::array_t<double> get_path_tt_truck_batch(py::array_t<int>start_intervals);
 
   MNM_Dta_Multiclass *m_mcdta;
+  MNM_Dar_Observation *m_dar_observation;
   std::vector<MNM_Dlink_Multiclass*> m_link_vec;
   std::vector<MNM_Path*> m_path_vec;
   std::set<MNM_Path*> m_path_set; 
+  std::unordered_map<MNM_Path*, int> m_path_map; 
   std::unordered_map<TInt, MNM_Path*> m_ID_path_mapping;
+  std::string m_memory_folder;
+private:
+  int load_ID_path_mapping();
 };
 
 #endif
\ No newline at end of file
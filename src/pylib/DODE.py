@@ -4,7 +4,7 @@ import pandas as pd
 import hashlib
 import time
 import shutil
-from scipy.sparse import coo_matrix
+from scipy.sparse import coo_matrix, csr_matrix
 import multiprocessing as mp
 
 import MNMAPI
@@ -75,9 +75,10 @@ class DODE(object):
     return dar
 
   def get_dar2(self, dta, f):
-    dar = dta.get_complete_dar_matrix(np.arange(0, self.num_loading_interval, self.ass_freq), 
+    (data, indices, indptr, shape) = dta.get_complete_dar_matrix_csr(np.arange(0, self.num_loading_interval, self.ass_freq), 
                 np.arange(0, self.num_loading_interval, self.ass_freq) + self.ass_freq, 
                 self.num_assign_interval, f)
+    dar = csr_matrix((data, indices, indptr), shape=shape)
     return dar
 
   def _massage_raw_dar(self, raw_dar, ass_freq, f, num_assign_interval):
@@ -80,25 +80,34 @@ class MCDODE():
     # print "Finish simulation", time.time()
     return a
 
+  def _get_small_assign_freq(self, ass_freq):
+    # the assignment interval in minutes, the dar departure times are binned by it
+    assign_second = ass_freq * self.nb.config.config_dict['DTA']['unit_time']
+    if assign_second < 60 or assign_second % 60 != 0:
+      raise ValueError("assign_frq * unit_time must be a positive number of whole minutes, got {} seconds".format(assign_second))
+    return int(assign_second // 60)
+
   def get_dar(self, dta, f_car, f_truck):
     car_dar = csr_matrix((self.num_assign_interval * len(self.observed_links), self.num_assign_interval * len(self.paths_list)))
     truck_dar = csr_matrix((self.num_assign_interval * len(self.observed_links), self.num_assign_interval * len(self.paths_list)))
+    small_assign_freq = self._get_small_assign_freq(self.ass_freq)
     if self.config['use_car_link_flow'] or self.config['use_car_link_tt']:
-      raw_car_dar = dta.get_car_dar_matrix(np.arange(0, self.num_loading_interval, self.ass_freq), 
-                  np.arange(0, self.num_loading_interval, self.ass_freq) + self.ass_freq)
-      # print "raw car dar", raw_car_dar
-      car_dar = self._massage_raw_dar(raw_car_dar, self.ass_freq, f_car, self.num_assign_interval)
+      (data, indices, indptr, shape) = dta.get_complete_car_dar_matrix_csr(np.arange(0, self.num_loading_interval, self.ass_freq), 
+                  np.arange(0, self.num_loading_interval, self.ass_freq) + self.ass_freq, 
+                  self.num_assign_interval, small_assign_freq, f_car)
+      car_dar = csr_matrix((data, indices, indptr), shape=shape)
     if self.config['use_truck_link_flow'] or self.config['use_truck_link_tt']:
-      raw_truck_dar = dta.get_truck_dar_matrix(np.arange(0, self.num_loading_interval, self.ass_freq), 
-                  np.arange(0, self.num_loading_interval, self.ass_freq) + self.ass_freq)
-      truck_dar = self._massage_raw_dar(raw_truck_dar, self.ass_freq, f_truck, self.num_assign_interval)
+      (data, indices, indptr, shape) = dta.get_complete_truck_dar_matrix_csr(np.arange(0, self.num_loading_interval, self.ass_freq), 
+                  np.arange(0, self.num_loading_interval, self.ass_freq) + self.ass_freq, 
+                  self.num_assign_interval, small_assign_freq, f_truck)
+      truck_dar = csr_matrix((data, indices, indptr), shape=shape)
     # print "dar", car_dar, truck_dar
     return (car_dar, truck_dar)
 
   def _massage_raw_dar(self, raw_dar, ass_freq, f, num_assign_interval):
     num_e_path = len(self.paths_list)
     num_e_link = len(self.observed_links)
-    small_assign_freq = ass_freq * self.nb.config.config_dict['DTA']['unit_time'] / 60
+    small_assign_freq = self._get_small_assign_freq(ass_freq)
     link_seq = (np.array(map(lambda x: self.observed_links.index(x), raw_dar[:, 2].astype(np.int)))
                 + raw_dar[:, 3] * num_e_link / ass_freq).astype((np.int))
     path_seq = (raw_dar[:, 0] + (raw_dar[:, 1] / small_assign_freq).astype(np.int) * num_e_path).astype(np.int)